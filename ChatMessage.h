@@ -7,6 +7,7 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "common/Utils.h"
 
@@ -14,9 +15,12 @@ namespace Chat {
 
 struct Message {
     Message(std::string user, std::string channel, std::string text,
-            std::string lang, long long timestamp, bool valid)
-        : uuid(Utils::UUIDv4::pair()), user(std::move(user)), channel(std::move(channel)), text(std::move(text)),
-          lang(std::move(lang)), timestamp(timestamp), valid(valid) {
+            std::string lang, long long timestamp, bool valid, long long readTime = 0,
+            std::vector<std::string> emotes = {}, uint128_t dupOf = {0, 0}, bool exactDuplicate = false,
+            std::pair<uint128_t, std::string> uuid = Utils::UUIDv4::pair(), uint64_t traceId = 0)
+        : uuid(std::move(uuid)), user(std::move(user)), channel(std::move(channel)), text(std::move(text)),
+          lang(std::move(lang)), emotes(std::move(emotes)), dupOf(dupOf), timestamp(timestamp), readTime(readTime),
+          traceId(traceId), valid(valid), duplicate(dupOf != uint128_t{0, 0}), exactDuplicate(exactDuplicate) {
     }
 
     const std::pair<uint128_t, std::string> uuid;
@@ -24,14 +28,22 @@ struct Message {
     const std::string channel;
     const std::string text;
     const std::string lang;
+    const std::vector<std::string> emotes; // twitch emote ids in order of appearance
+    const uint128_t dupOf; // id of original message for near duplicates, zero for originals
     const long long timestamp;
+    const long long readTime; // monotonic microseconds of socket read
+    const uint64_t traceId; // non zero for sampled messages, see TraceBuffer
     const bool valid;
+    const bool duplicate;
+    const bool exactDuplicate; // text is equal to original one
 };
 
 struct SendMessage {
     const std::string user;
     const std::string channel;
     const std::string text;
+    const long long readTime = 0; // readTime of message that triggered the answer
+    const uint64_t traceId = 0;   // traceId of message that triggered the answer
 };
 
 }
@@ -0,0 +1,66 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#include "ChatSketches.h"
+
+std::vector<SpaceSaving::Item> HeavyHitters::list(size_t n) const {
+    auto items = top.top(n);
+    for (auto &item: items) {
+        auto estimate = counts.estimate(sketchHash(item.key));
+        if (estimate < item.count) {
+            item.error -= std::min(item.error, item.count - estimate);
+            item.count = estimate;
+        }
+    }
+    std::stable_sort(items.begin(), items.end(), [] (const auto &lhs, const auto &rhs) {
+        return lhs.count > rhs.count;
+    });
+    return items;
+}
+
+void ChatSketches::Snapshot::merge(const Snapshot &rhs) {
+    channels.merge(rhs.channels);
+    chatters.merge(rhs.chatters);
+    users.merge(rhs.users);
+    for (auto &[channel, hll]: rhs.channelUsers)
+        channelUsers[channel].merge(hll);
+}
+
+void ChatSketches::record(std::string_view channel, std::string_view user) {
+    thread_local const size_t shardIndex = std::hash<std::thread::id>{}(std::this_thread::get_id()) % SHARDS;
+    auto userHash = sketchHash(user);
+
+    auto &shard = shards[shardIndex];
+    std::lock_guard lg(shard.mutex);
+    auto &data = shard.data;
+    data.channels.add(channel);
+    data.chatters.add(user);
+    data.users.add(userHash);
+    auto it = data.channelUsers.find(channel);
+    if (it == data.channelUsers.end())
+        it = data.channelUsers.emplace(std::string(channel), HyperLogLog{}).first;
+    it->second.add(userHash);
+}
+
+ChatSketches::Snapshot ChatSketches::collect() {
+    Snapshot res;
+    for (auto &shard: shards) {
+        Snapshot part;
+        {
+            std::lock_guard lg(shard.mutex);
+            std::swap(part, shard.data);
+        }
+        if (part.empty())
+            continue;
+        if (res.empty())
+            res = std::move(part);
+        else
+            res.merge(part);
+    }
+    return res;
+}
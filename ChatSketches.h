@@ -0,0 +1,78 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER__CHATSKETCHES_H_
+#define CHATCONTROLLER__CHATSKETCHES_H_
+
+#include <array>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CountMinSketch.h"
+#include "HyperLogLog.h"
+#include "SpaceSaving.h"
+
+// Count-Min gives point estimate of any key, Space-Saving keeps the list of the largest keys.
+// Listed counts are the smaller of both upper bounds.
+struct HeavyHitters {
+    static constexpr size_t CAPACITY = 256; // monitored keys, enough for top 100 with margin
+
+    CountMinSketch counts;
+    SpaceSaving top{CAPACITY};
+
+    void add(std::string_view key, uint64_t count = 1) {
+        counts.add(sketchHash(key), count);
+        top.add(key, count);
+    }
+
+    void merge(const HeavyHitters &rhs) {
+        counts.merge(rhs.counts);
+        top.merge(rhs.top);
+    }
+
+    /// Up to n largest keys sorted by count
+    [[nodiscard]] std::vector<SpaceSaving::Item> list(size_t n) const;
+};
+
+// Streaming sketches of inbound chat: busiest channels and chatters, unique chatters overall and per channel.
+// Filled by MessageProcessor threads, each thread hashes to its own mutex guarded shard,
+// so lock is uncontended unless there are more threads than shards.
+class ChatSketches
+{
+  public:
+    static constexpr size_t SHARDS = 16;
+
+    struct Snapshot {
+        HeavyHitters channels;  // messages per channel
+        HeavyHitters chatters;  // messages per user
+        HyperLogLog users;      // unique users of all channels
+        std::map<std::string, HyperLogLog, std::less<>> channelUsers; // unique users per channel
+
+        void merge(const Snapshot &rhs);
+        [[nodiscard]] bool empty() const { return channels.counts.empty(); }
+    };
+
+  public:
+    ChatSketches() = default;
+    ~ChatSketches() = default;
+
+    ChatSketches(const ChatSketches&) = delete;
+    ChatSketches& operator=(const ChatSketches&) = delete;
+
+    void record(std::string_view channel, std::string_view user);
+
+    /// Returns sketches filled since previous collect
+    Snapshot collect();
+  private:
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        Snapshot data;
+    };
+    std::array<Shard, SHARDS> shards;
+};
+
+#endif //CHATCONTROLLER__CHATSKETCHES_H_
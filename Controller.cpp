@@ -6,6 +6,8 @@
 #include <algorithm>
 #include <chrono>
 
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
 #include <so_5/send_functions.hpp>
 #include <so_5/disp/adv_thread_pool/pub.hpp>
 #include <so_5/disp/active_obj/pub.hpp>
@@ -20,18 +22,25 @@
 #include "LoggerFactory.h"
 
 #include "db/DBConnectionLock.h"
+#include "db/kv/KVStorage.h"
 #include "irc/IRCConnectionConfig.h"
 #include "Controller.h"
 
 using json = nlohmann::json;
 
 Controller::Controller(const context_t& ctx, so_5::mbox_t http, Config &config,
-                       std::shared_ptr<DBController> db, std::shared_ptr<Logger> logger)
+                       std::shared_ptr<DBController> db, std::shared_ptr<So5HandlerTracker> handlerTracker,
+                       std::shared_ptr<Logger> logger)
     : so_5::agent_t(ctx),
       config(config),
       logger(std::move(logger)),
       db(std::move(db)),
+      latency(std::make_shared<LatencyTracker>()),
+      channelMetrics(std::make_shared<MetricsRegistry>()),
+      sketches(std::make_shared<ChatSketches>()),
+      handlerTracker(std::move(handlerTracker)),
       http(std::move(http)) {
+    latency->trace().setSampleRate(config[MSG]["trace_sample_rate"].value_or(0));
 }
 
 Controller::~Controller() {
@@ -63,7 +72,7 @@ void Controller::so_evt_start() {
     so_5::introduce_child_coop(*this, [&] (so_5::coop_t &coop) {
         auto listener = so_environment().create_mbox();
 
-        statsCollector = makeStatsCollector(coop, listener);
+        statsCollector = makeStatsCollector(coop);
         storage = makeStorage(coop, listener, statsCollector->so_direct_mbox());
         botsEnvironment = makeBotsEnvironment(coop, listener, statsCollector->so_direct_mbox());
         msgProcessor = makeMessageProcessor(coop, listener /*as publisher*/, statsCollector->so_direct_mbox());
@@ -71,6 +80,7 @@ void Controller::so_evt_start() {
 
         botsEnvironment->setMessageSender(ircController->so_direct_mbox());
         botsEnvironment->setBotLogger(storage->so_direct_mbox());
+        statsCollector->setRollup(storage->so_direct_mbox(), config[CLICKHOUSE]["rollup_period"].value_or(0));
     });
 
     shutdownCheckTimer = so_5::send_periodic<Controller::ShutdownCheck>(so_direct_mbox(),
@@ -82,11 +92,12 @@ void Controller::so_evt_finish() {
     // TODO notify about it
 }
 
-StatsCollector *Controller::makeStatsCollector(so_5::coop_t &coop, const so_5::mbox_t &listener) {
+StatsCollector *Controller::makeStatsCollector(so_5::coop_t &coop) {
     //auto statsDisp = so_5::disp::prio_one_thread::strictly_ordered::make_dispatcher(so_environment());
     auto statsDisp = so_5::disp::active_obj::make_dispatcher(so_environment(), "stats_collector");
     return coop.make_agent_with_binder<StatsCollector>(statsDisp.binder(),
-                                                       listener, http, logger, db);
+                                                       http, logger, db, latency, channelMetrics, sketches,
+                                                       handlerTracker);
 }
 
 Storage * Controller::makeStorage(so_5::coop_t &coop, const so_5::mbox_t &listener, const so_5::mbox_t &stats) {
@@ -103,36 +114,60 @@ Storage * Controller::makeStorage(so_5::coop_t &coop, const so_5::mbox_t &listen
     unsigned int chConns = config[CLICKHOUSE]["connections"].value_or(1);
     unsigned int botLogFlushDelay = config[CLICKHOUSE]["bot_log_flush_delay"].value_or(1);
     unsigned int messagesFlushDelay = config[CLICKHOUSE]["messages_flush_delay"].value_or(1);
+    // emotes and dup_of columns exist only in schema of installations that enabled these features
+    bool storeEmotes = config[MSG]["emotes_detection"].value_or(false);
+    bool storeDuplicates = config[MSG]["duplicates_detection"].value_or(false);
     auto chLogger = LoggerFactory::create(LoggerFactory::config(config, CLICKHOUSE));
 
     auto chDisp = so_5::disp::active_obj::make_dispatcher(so_environment(), "storage");
     return coop.make_agent_with_binder<Storage>(chDisp.binder(),
                                                 listener, stats, std::move(chCfg), chConns,
-                                                batchSize, messagesFlushDelay, botLogFlushDelay,
-                                                chLogger);
+                                                batchSize, messagesFlushDelay, botLogFlushDelay, storeEmotes,
+                                                storeDuplicates, latency, chLogger);
 }
 
 BotsEnvironment *Controller::makeBotsEnvironment(so_5::coop_t &coop,
                                                  const so_5::mbox_t &listener,
-                                                 const so_5::mbox_t &/*stats*/) {
+                                                 const so_5::mbox_t &stats) {
     unsigned int botThreads = config[BOT]["threads"].value_or(1);
+    size_t luaMemoryLimit = config[BOT]["lua_memory_limit"].value_or(0);
+    unsigned int kvSnapshotPeriod = config[BOT]["kv_snapshot_period"].value_or(300);
     auto botsLogger = LoggerFactory::create(LoggerFactory::config(config, BOT));
+
+    KVStorageConfig kvCfg;
+    kvCfg.path = config[BOT]["kv_path"].value_or("data/kv");
+    kvCfg.shards = config[BOT]["kv_shards"].value_or(16);
+    auto kv = std::make_shared<KVStorage>(std::move(kvCfg), botsLogger);
+
     auto botsDisp = so_5::disp::active_obj::make_dispatcher(so_environment(), "bots_environment");
     return coop.make_agent_with_binder<BotsEnvironment>(botsDisp.binder(),
-                                                        listener, http, botThreads, db, botsLogger);
+                                                        listener, http, stats, botThreads, luaMemoryLimit,
+                                                        kvSnapshotPeriod, kv, db, latency, botsLogger);
 }
 
 MessageProcessor *Controller::makeMessageProcessor(so_5::coop_t &coop,
                                                    const so_5::mbox_t &publisher,
-                                                   const so_5::mbox_t &/*stats*/) {
+                                                   const so_5::mbox_t &stats) {
     MessageProcessorConfig procCfg;
     procCfg.languageRecognition = config[MSG]["language_recognition"].value_or(false);
+    procCfg.language.minTextLength = config[MSG]["language_min_length"].value_or(16);
+    procCfg.language.stableStreak = config[MSG]["language_stable_streak"].value_or(3);
+    procCfg.language.recheckEvery = config[MSG]["language_recheck_every"].value_or(10);
+    procCfg.language.maxUsers = config[MSG]["language_cache_users"].value_or(200000);
+    procCfg.emotesDetection = config[MSG]["emotes_detection"].value_or(false);
+    procCfg.emotesReloadPeriod = config[MSG]["emotes_reload_period"].value_or(600);
+    procCfg.duplicatesDetection = config[MSG]["duplicates_detection"].value_or(false);
+    procCfg.duplicates.minTextLength = config[MSG]["duplicates_min_length"].value_or(8);
+    procCfg.duplicates.windowSize = config[MSG]["duplicates_window_size"].value_or(64);
+    procCfg.duplicates.windowTime = config[MSG]["duplicates_window_time"].value_or(30000);
+    procCfg.duplicates.maxDistance = config[MSG]["duplicates_max_distance"].value_or(10);
     unsigned int procThreads = config[MSG]["threads"].value_or(2);
 
     auto procPool = so_5::disp::adv_thread_pool::make_dispatcher(so_environment(), "message_processor", procThreads);
     auto procPoolParams = so_5::disp::adv_thread_pool::bind_params_t{};
     return coop.make_agent_with_binder<MessageProcessor>(procPool.binder(procPoolParams),
-                                                         publisher, std::move(procCfg), this->logger);
+                                                         publisher, stats, std::move(procCfg), db, latency,
+                                                         channelMetrics, sketches, this->logger);
 }
 
 IRCController *Controller::makeIRCController(so_5::coop_t &coop, const so_5::mbox_t &stats) {
@@ -140,10 +175,40 @@ IRCController *Controller::makeIRCController(so_5::coop_t &coop, const so_5::mbo
     ircConfig.host = config[IRC]["host"].value_or("irc.chat.twitch.tv");
     ircConfig.port = config[IRC]["port"].value_or(6667);
     ircConfig.threads = config[IRC]["threads"].value_or(1);
+    for (auto cpu: absl::StrSplit(config[IRC]["selector_cpus"].value_or(""), ',', absl::SkipWhitespace())) {
+        if (int value; absl::SimpleAtoi(cpu, &value))
+            ircConfig.selector_cpus.push_back(value);
+    }
+    ircConfig.selector_rebalance_period = config[IRC]["selector_rebalance_period"].value_or(60);
+    ircConfig.selector_rebalance_band = config[IRC]["selector_rebalance_band"].value_or(0.25);
+    ircConfig.capture_path = config[IRC]["capture_path"].value_or("");
+    ircConfig.capture_segment_size = config[IRC]["capture_segment_size"].value_or(64);
+    ircConfig.capture_segments = config[IRC]["capture_segments"].value_or(16);
+    ircConfig.capture_queue = config[IRC]["capture_queue"].value_or(100000);
+    ircConfig.keepalive_idle = config[IRC]["keepalive_idle"].value_or(5000);
+    ircConfig.keepalive_timeout = config[IRC]["keepalive_timeout"].value_or(10000);
+    ircConfig.keepalive_probe = config[IRC]["keepalive_probe"].value_or(30000);
+    ircConfig.reconnect_rtt = config[IRC]["reconnect_rtt"].value_or(3000);
+    ircConfig.connect_concurrency = config[IRC]["connect_concurrency"].value_or(10);
+    ircConfig.connect_per_sec = config[IRC]["connect_per_sec"].value_or(5);
+    ircConfig.connect_backoff_base = config[IRC]["connect_backoff_base"].value_or(1000);
+    ircConfig.connect_backoff_cap = config[IRC]["connect_backoff_cap"].value_or(60000);
+    ircConfig.storm_threshold = config[IRC]["storm_threshold"].value_or(10);
+    ircConfig.storm_window = config[IRC]["storm_window"].value_or(10000);
+    ircConfig.join_limit = config[IRC]["join_limit"].value_or(20);
+    ircConfig.join_period = config[IRC]["join_period"].value_or(10000);
+    ircConfig.rebalance_period = config[IRC]["rebalance_period"].value_or(60);
+    ircConfig.rebalance_band = config[IRC]["rebalance_band"].value_or(0.25);
+    ircConfig.rebalance_moves = config[IRC]["rebalance_moves"].value_or(2);
+    ircConfig.scale_period = config[IRC]["scale_period"].value_or(30);
+    ircConfig.scale_max_sessions = config[IRC]["scale_max_sessions"].value_or(8);
+    ircConfig.scale_channels = config[IRC]["scale_channels"].value_or(100);
+    ircConfig.scale_bytes_rate = config[IRC]["scale_bytes_rate"].value_or(262144);
+    ircConfig.scale_rtt = config[IRC]["scale_rtt"].value_or(1000);
     auto ircLogger = LoggerFactory::create(LoggerFactory::config(config, IRC));
 
     auto ircDisp = so_5::disp::active_obj::make_dispatcher(so_environment(), "irc_controller");
     return coop.make_agent_with_binder<IRCController>(ircDisp.binder(),
                                                       msgProcessor->so_direct_mbox(), stats,
-                                                      http, ircConfig, db, ircLogger);
+                                                      http, ircConfig, db, latency, ircLogger);
 }
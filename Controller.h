@@ -22,9 +22,13 @@
 #include "MessageProcessor.h"
 #include "StatsCollector.h"
 #include "DBController.h"
+#include "LatencyTracker.h"
+#include "MetricsRegistry.h"
+#include "ChatSketches.h"
 #include "Storage.h"
 
 class Logger;
+class So5HandlerTracker;
 class Controller final : public so_5::agent_t
 {
     struct ShutdownCheck final : public so_5::signal_t {};
@@ -34,6 +38,7 @@ class Controller final : public so_5::agent_t
                         so_5::mbox_t http,
                         Config &config,
                         std::shared_ptr<DBController> db,
+                        std::shared_ptr<So5HandlerTracker> handlerTracker,
                         std::shared_ptr<Logger> logger);
     ~Controller() override;
 
@@ -41,7 +46,7 @@ class Controller final : public so_5::agent_t
     void so_evt_start() override;
     void so_evt_finish() override;
 
-    StatsCollector *makeStatsCollector(so_5::coop_t &coop, const so_5::mbox_t& listener);
+    StatsCollector *makeStatsCollector(so_5::coop_t &coop);
     Storage *makeStorage(so_5::coop_t &coop, const so_5::mbox_t &listener, const so_5::mbox_t &stats);
     BotsEnvironment *makeBotsEnvironment(so_5::coop_t &coop, const so_5::mbox_t &listener, const so_5::mbox_t &stats);
     MessageProcessor *makeMessageProcessor(so_5::coop_t &coop, const so_5::mbox_t &publisher, const so_5::mbox_t &stats);
@@ -52,6 +57,10 @@ class Controller final : public so_5::agent_t
 
     const std::shared_ptr<Logger> logger;
     const std::shared_ptr<DBController> db;
+    const std::shared_ptr<LatencyTracker> latency;
+    const std::shared_ptr<MetricsRegistry> channelMetrics; // inbound messages per channel
+    const std::shared_ptr<ChatSketches> sketches;          // busiest channels and unique chatters
+    const std::shared_ptr<So5HandlerTracker> handlerTracker; // null unless enabled
 
     StatsCollector *statsCollector = nullptr;
     Storage *storage = nullptr;
@@ -306,3 +306,23 @@ DBController::UpdatedChannels DBController::loadChannels(long long &timestamp) {
     DefaultLogger::logInfo("DBController {} watched channels loaded", channels.size());
     return channels;
 }
+
+DBController::Emotes DBController::loadEmotes() {
+    static const std::string request = "SELECT name, twitch_id FROM emote WHERE active = true;";
+
+    DBController::Emotes emotes;
+    {
+        DBConnectionLock dbl(pg);
+        if (!dbl->ping())
+            return emotes;
+
+        std::vector<std::vector<std::string>> res;
+        if (dbl->request(request, res)) {
+            for (auto &row: res)
+                emotes.emplace(std::move(row[0]), std::move(row[1]));
+        }
+    }
+
+    DefaultLogger::logInfo("DBController {} emotes loaded", emotes.size());
+    return emotes;
+}
@@ -25,6 +25,7 @@ class DBController
     using Account = IRCClientConfig;
     using Accounts = std::vector<Account>;
     using BotsConfigurations = std::map<int, BotConfiguration>;
+    using Emotes = std::map<std::string, std::string>;
   public:
     DBController(PGConnectionConfig config, unsigned int count, std::shared_ptr<Logger> logger);
     ~DBController();
@@ -42,6 +43,7 @@ class DBController
     UpdatedChannels loadChannels(long long &timestamp);
     BotsConfigurations loadBotConfigurations();
     BotConfiguration loadBotConfiguration(int id);
+    Emotes loadEmotes();
   private:
     const std::shared_ptr<Logger> logger;
     std::shared_ptr<PGConnectionPool> pg;
@@ -0,0 +1,127 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+#include <functional>
+
+#include "PerfectHash.h"
+#include "DuplicateDetector.h"
+
+DuplicateDetector::Stats &DuplicateDetector::Stats::operator+=(const Stats &rhs) {
+    checked += rhs.checked;
+    duplicates += rhs.duplicates;
+    exact += rhs.exact;
+    return *this;
+}
+
+DuplicateDetector::DuplicateDetector(DuplicateDetectorConfig config) : config(config) {
+}
+
+DuplicateDetector::Result DuplicateDetector::check(const std::string &channel, const uint128_t &id,
+                                                   std::string_view text, long long timestamp) {
+    Result res;
+    if (text.size() < config.minTextLength)
+        return res;
+
+    checked.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t print = fingerprint(text);
+
+    auto &shard = shards[std::hash<std::string>{}(channel) % SHARDS];
+    std::lock_guard lg(shard.mutex);
+    if (timestamp >= shard.nextSweep) {
+        sweep(shard, timestamp);
+        shard.nextSweep = timestamp + config.windowTime;
+    }
+
+    auto &window = shard.channels[channel];
+    while (!window.empty() && window.front().timestamp + config.windowTime < timestamp)
+        window.pop_front();
+
+    for (auto it = window.begin(); it != window.end(); ++it) {
+        if (distance(it->fingerprint, print) > config.maxDistance)
+            continue;
+
+        res.dupOf = it->id;
+        res.exact = it->text == text;
+        duplicates.fetch_add(1, std::memory_order_relaxed);
+        if (res.exact)
+            exact.fetch_add(1, std::memory_order_relaxed);
+
+        // original is kept in window while the wave goes on, window stays ordered by time
+        auto entry = std::move(*it);
+        window.erase(it);
+        entry.timestamp = std::max(entry.timestamp, timestamp);
+        window.push_back(std::move(entry));
+        return res;
+    }
+
+    if (!window.empty() && window.size() >= config.windowSize)
+        window.pop_front();
+    window.push_back(Entry{print, std::string(text), id, timestamp});
+    return res;
+}
+
+void DuplicateDetector::sweep(Shard &shard, long long timestamp) {
+    for (auto it = shard.channels.begin(); it != shard.channels.end();) {
+        auto &window = it->second;
+        if (window.empty() || window.back().timestamp + config.windowTime < timestamp)
+            it = shard.channels.erase(it);
+        else
+            ++it;
+    }
+}
+
+DuplicateDetector::Stats DuplicateDetector::collectStats() {
+    Stats stats;
+    stats.checked = checked.exchange(0, std::memory_order_relaxed);
+    stats.duplicates = duplicates.exchange(0, std::memory_order_relaxed);
+    stats.exact = exact.exchange(0, std::memory_order_relaxed);
+    return stats;
+}
+
+size_t DuplicateDetector::channelsCount() {
+    size_t count = 0;
+    for (auto &shard: shards) {
+        std::lock_guard lg(shard.mutex);
+        count += shard.channels.size();
+    }
+    return count;
+}
+
+uint64_t DuplicateDetector::fingerprint(std::string_view text) {
+    // normalize: lowercase ascii, collapse whitespaces
+    char normalized[512];
+    size_t size = 0;
+    bool space = true;
+    for (char c: text) {
+        if (size == sizeof(normalized))
+            break;
+        if (c == ' ' || c == '\t') {
+            if (!space)
+                normalized[size++] = ' ';
+            space = true;
+            continue;
+        }
+        normalized[size++] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        space = false;
+    }
+
+    if (size < 3)
+        return PerfectHash::hash({normalized, size}, 0);
+
+    int weights[64] = {};
+    for (size_t i = 0; i + 3 <= size; ++i) {
+        uint64_t hash = PerfectHash::hash({normalized + i, 3}, 0);
+        for (int bit = 0; bit < 64; ++bit)
+            weights[bit] += static_cast<int>((hash >> bit) & 1u) * 2 - 1;
+    }
+
+    uint64_t res = 0;
+    for (int bit = 0; bit < 64; ++bit) {
+        if (weights[bit] > 0)
+            res |= uint64_t{1} << bit;
+    }
+    return res;
+}
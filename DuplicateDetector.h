@@ -0,0 +1,84 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER__DUPLICATEDETECTOR_H_
+#define CHATCONTROLLER__DUPLICATEDETECTOR_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "common/Utils.h"
+
+struct DuplicateDetectorConfig {
+    size_t minTextLength = 8;  // shorter texts are not checked
+    size_t windowSize = 64;    // fingerprints kept per channel
+    long long windowTime = 30000; // milliseconds
+    int maxDistance = 10;      // hamming distance between near duplicates, catches most single character edits
+};
+
+// Near duplicate detection for copypasta and raid waves.
+// Every message gets 64-bit SimHash over character 3-grams of normalized text and is compared
+// with sliding window of recent originals of the same channel.
+// Window is ordered by last match time, matched original moves to its back and outlives the wave.
+class DuplicateDetector
+{
+  public:
+    static constexpr size_t SHARDS = 16;
+
+    struct Result {
+        uint128_t dupOf{0, 0}; // id of original message, zero for originals
+        bool exact = false;    // text is equal to original
+    };
+
+    struct Stats {
+        unsigned long long checked = 0;
+        unsigned long long duplicates = 0;
+        unsigned long long exact = 0;
+
+        Stats& operator+=(const Stats &rhs);
+    };
+
+  public:
+    explicit DuplicateDetector(DuplicateDetectorConfig config);
+    ~DuplicateDetector() = default;
+
+    Result check(const std::string &channel, const uint128_t &id, std::string_view text, long long timestamp);
+
+    /// Returns counters and resets them
+    Stats collectStats();
+    /// Channels with not expired window
+    [[nodiscard]] size_t channelsCount();
+
+    static uint64_t fingerprint(std::string_view text);
+    static int distance(uint64_t lhs, uint64_t rhs) { return __builtin_popcountll(lhs ^ rhs); }
+  private:
+    struct Entry {
+        uint64_t fingerprint = 0;
+        std::string text; // exact match is decided by text itself, window is small
+        uint128_t id{0, 0};
+        long long timestamp = 0;
+    };
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::deque<Entry>> channels;
+        long long nextSweep = 0; // windows of idle channels are dropped once per window time
+    };
+
+    void sweep(Shard &shard, long long timestamp);
+
+    const DuplicateDetectorConfig config;
+    std::array<Shard, SHARDS> shards;
+
+    std::atomic<unsigned long long> checked{0};
+    std::atomic<unsigned long long> duplicates{0};
+    std::atomic<unsigned long long> exact{0};
+};
+
+#endif //CHATCONTROLLER__DUPLICATEDETECTOR_H_
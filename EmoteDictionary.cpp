@@ -0,0 +1,84 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+#include <charconv>
+
+#include "TokenScanner.h"
+#include "EmoteDictionary.h"
+
+EmoteDictionary::EmoteDictionary(const Emotes &emotes) {
+    std::vector<std::string> keys;
+    keys.reserve(emotes.size());
+    ids.reserve(emotes.size());
+    for (auto &[name, id]: emotes) {
+        keys.push_back(name);
+        ids.push_back(id);
+    }
+    names = PerfectHash(std::move(keys));
+}
+
+const std::string *EmoteDictionary::find(std::string_view name) const {
+    auto index = names.find(name);
+    return index != PerfectHash::NOT_FOUND ? &ids[index] : nullptr;
+}
+
+std::vector<std::string> EmoteDictionary::extract(std::string_view text) const {
+    std::vector<std::string> res;
+    if (ids.empty())
+        return res;
+
+    TokenScanner::scan(text, [this, &res] (std::string_view token, bool ascii) {
+        // emote names are short ascii words
+        if (!ascii || token.size() > MAX_NAME_LENGTH)
+            return;
+        if (const auto *id = find(token))
+            res.push_back(*id);
+    });
+    return res;
+}
+
+// Splits value by delimiter, the last part is returned when delimiter is not found
+static std::string_view nextPart(std::string_view &value, char delimiter) {
+    auto pos = value.find(delimiter);
+    auto part = value.substr(0, pos);
+    value = pos == std::string_view::npos ? std::string_view{} : value.substr(pos + 1);
+    return part;
+}
+
+// "start-end" with end >= start, tag comes from network and is not trusted
+static bool parseRange(std::string_view range, unsigned int &start) {
+    const char *last = range.data() + range.size();
+    auto [dash, ec] = std::from_chars(range.data(), last, start);
+    if (ec != std::errc() || dash == last || *dash != '-')
+        return false;
+    unsigned int end = 0;
+    auto [ptr, endEc] = std::from_chars(dash + 1, last, end);
+    return endEc == std::errc() && ptr == last && end >= start;
+}
+
+std::vector<std::string> EmoteDictionary::fromTag(std::string_view tag) {
+    std::vector<std::pair<unsigned int, std::string_view>> positions;
+    while (!tag.empty()) {
+        auto emote = nextPart(tag, '/');
+        auto colon = emote.find(':');
+        if (colon == 0 || colon == std::string_view::npos)
+            continue;
+        auto id = emote.substr(0, colon);
+        auto ranges = emote.substr(colon + 1);
+        while (!ranges.empty()) {
+            unsigned int start = 0;
+            if (parseRange(nextPart(ranges, ','), start))
+                positions.emplace_back(start, id);
+        }
+    }
+
+    std::sort(positions.begin(), positions.end());
+
+    std::vector<std::string> res;
+    res.reserve(positions.size());
+    for (auto &[start, id]: positions)
+        res.emplace_back(id);
+    return res;
+}
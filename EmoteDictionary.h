@@ -0,0 +1,40 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER__EMOTEDICTIONARY_H_
+#define CHATCONTROLLER__EMOTEDICTIONARY_H_
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "PerfectHash.h"
+
+// Immutable emote name to emote id dictionary, rebuilt on reload and shared between processor threads
+class EmoteDictionary
+{
+  public:
+    using Emotes = std::map<std::string, std::string>; // name -> twitch emote id
+    static constexpr size_t MAX_NAME_LENGTH = 64;
+
+  public:
+    explicit EmoteDictionary(const Emotes &emotes);
+    ~EmoteDictionary() = default;
+
+    /// Returns emote id or nullptr
+    [[nodiscard]] const std::string *find(std::string_view name) const;
+    [[nodiscard]] size_t size() const { return ids.size(); }
+
+    /// Emote ids of text tokens in order of appearance
+    [[nodiscard]] std::vector<std::string> extract(std::string_view text) const;
+
+    /// Emote ids from IRCv3 tag "id:0-4,12-16/id2:6-10" in order of appearance, without dictionary lookup
+    static std::vector<std::string> fromTag(std::string_view tag);
+  private:
+    PerfectHash names;
+    std::vector<std::string> ids;
+};
+
+#endif //CHATCONTROLLER__EMOTEDICTIONARY_H_
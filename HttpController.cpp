@@ -34,7 +34,7 @@ void HttpController::so_define_agent() {
     });
     so_subscribe(listeners).event([](mhood_t<hreq::resp> resp) {
         resp->send(HTTPResponseFactory::CreateResponse(
-            resp->req, static_cast<http::status>(resp->status), std::move(resp->body)));
+            resp->req, static_cast<http::status>(resp->status), std::move(resp->body), resp->contentType));
     }, so_5::thread_safe);
 }
 
@@ -75,6 +75,9 @@ void HttpController::so_evt_finish() {
 
 void HttpController::handleRequest(http::request<http::string_body> &&req, HTTPServerSession::SendLambda &&send) {
     std::vector<std::string_view> path = absl::StrSplit(sv(req.target()), '/', absl::SkipWhitespace());
+    // conventional scrape path of prometheus
+    if (path.size() == 1 && match(0, metrics))
+        return so_5::send<hreq::stats::metrics>(listeners, std::move(req), std::move(send));
     if (path.size() < 2)
         return send(HTTPResponseFactory::BadRequest(req, "Invalid path"));
 
@@ -86,6 +89,13 @@ void HttpController::handleRequest(http::request<http::string_body> &&req, HTTPS
         match_handle2(stats, storage);
         match_handle2(stats, db);
         match_handle2(stats, so5disp);
+        match_handle2(stats, latency);
+        match_handle2(stats, processor);
+        match_handle2(stats, metrics);
+        match_handle2(stats, window);
+        match_handle2(stats, top);
+        match_handle2(stats, chatters);
+        match_handle2(stats, trace);
     }
     else
     if (match(0, irc)) {
@@ -31,6 +31,7 @@ struct base
 struct resp : public base {
     int status = 200;
     mutable std::string body;
+    std::string contentType = "application/json";
 };
 }
 
@@ -62,6 +63,13 @@ DEFINE_EVT(stats, irc)                // irc stats
 DEFINE_EVT(stats, account)            // account stats
 DEFINE_EVT(stats, channel)            // channels stats
 DEFINE_EVT(stats, so5disp)            // so5disp stats
+DEFINE_EVT(stats, latency)            // message pipeline stages latency
+DEFINE_EVT(stats, processor)          // message processor stages stats
+DEFINE_EVT(stats, metrics)            // prometheus exposition of all stats, served on /metrics
+DEFINE_EVT(stats, window)             // rates and percentiles over the last seconds or minutes
+DEFINE_EVT(stats, top)                // busiest channels or chatters from heavy hitter sketches
+DEFINE_EVT(stats, chatters)           // unique chatters per channel from HyperLogLog sketches
+DEFINE_EVT(stats, trace)              // spans of sampled messages as Chrome trace JSON or Perfetto protobuf
 
 // handled by IRCController
 DEFINE_EVT(irc, reload)               // reload all accounts
@@ -0,0 +1,134 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+#include <functional>
+
+#include <langdetectpp/langdetectpp.h>
+
+#include "Clock.h"
+#include "LanguageDetector.h"
+
+static const std::string UNKNOWN_LANG = "UNKNOWN";
+
+LanguageDetector::Stats &LanguageDetector::Stats::operator+=(const Stats &rhs) {
+    messages += rhs.messages;
+    detected += rhs.detected;
+    cached += rhs.cached;
+    shortText += rhs.shortText;
+    detectTime += rhs.detectTime;
+    detectTimeMax = std::max(detectTimeMax, rhs.detectTimeMax);
+    return *this;
+}
+
+LanguageDetector::LanguageDetector(LanguageDetectorConfig config) : config(config) {
+}
+
+std::string LanguageDetector::detect(const std::string &user, const std::string &text) {
+    messages.fetch_add(1, std::memory_order_relaxed);
+
+    bool isShort = countLetters(text) < config.minTextLength;
+    auto &shard = shardFor(user);
+    {
+        std::lock_guard lg(shard.mutex);
+        auto it = shard.users.find(user);
+        if (it != shard.users.end()) {
+            auto &entry = it->second;
+            if (isShort || (entry.streak >= config.stableStreak && ++entry.sinceCheck < config.recheckEvery)) {
+                cached.fetch_add(1, std::memory_order_relaxed);
+                return entry.lang;
+            }
+        } else if (isShort) {
+            shortText.fetch_add(1, std::memory_order_relaxed);
+            return UNKNOWN_LANG;
+        }
+    }
+
+    auto lang = detectText(text);
+
+    std::lock_guard lg(shard.mutex);
+    if (shard.users.size() >= config.maxUsers / SHARDS)
+        shard.users.clear(); // coarse eviction, cache is warmed up again by active chatters
+
+    auto &entry = shard.users[user];
+    if (entry.lang == lang) {
+        ++entry.streak;
+    } else {
+        entry.lang = lang;
+        entry.streak = 1;
+    }
+    entry.sinceCheck = 0;
+    return lang;
+}
+
+LanguageDetector::Stats LanguageDetector::collectStats() {
+    Stats stats;
+    stats.messages = messages.exchange(0, std::memory_order_relaxed);
+    stats.detected = detected.exchange(0, std::memory_order_relaxed);
+    stats.cached = cached.exchange(0, std::memory_order_relaxed);
+    stats.shortText = shortText.exchange(0, std::memory_order_relaxed);
+    stats.detectTime = detectTime.exchange(0, std::memory_order_relaxed);
+    stats.detectTimeMax = detectTimeMax.exchange(0, std::memory_order_relaxed);
+    return stats;
+}
+
+size_t LanguageDetector::countLetters(std::string_view text) {
+    size_t letters = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        while (pos < text.size() && text[pos] == ' ')
+            ++pos;
+        size_t end = text.find(' ', pos);
+        if (end == std::string_view::npos)
+            end = text.size();
+        auto word = text.substr(pos, end - pos);
+        pos = end;
+
+        if (word.empty() || word.front() == '@' || word.substr(0, 4) == "http")
+            continue;
+
+        size_t wordLetters = 0, upper = 0;
+        bool camel = false;
+        char prev = 0;
+        for (char c: word) {
+            auto byte = static_cast<unsigned char>(c);
+            if ((byte >= 'a' && byte <= 'z')) {
+                ++wordLetters;
+            } else if (byte >= 'A' && byte <= 'Z') {
+                ++wordLetters;
+                ++upper;
+                camel |= prev >= 'a' && prev <= 'z';
+            } else if (byte >= 0xC0 && byte < 0xF0) {
+                ++wordLetters; // leading byte of 2-3 bytes sequence, 4 bytes ones are mostly emoji
+            }
+            prev = c;
+        }
+
+        // twitch emotes look like "PogChamp", "monkaS" or "KEKW"
+        if (camel || (upper > 1 && upper == wordLetters))
+            continue;
+        letters += wordLetters;
+    }
+    return letters;
+}
+
+std::string LanguageDetector::detectText(const std::string &text) {
+    thread_local std::shared_ptr<langdetectpp::Detector> detector;
+    if (!detector)
+        detector = langdetectpp::Detector::create();
+
+    auto start = CurrentTime<std::chrono::steady_clock>::microseconds();
+    auto lang = langdetectpp::toShortName(detector->detect(text));
+    auto elapsed = static_cast<unsigned long long>(CurrentTime<std::chrono::steady_clock>::microseconds() - start);
+
+    detected.fetch_add(1, std::memory_order_relaxed);
+    detectTime.fetch_add(elapsed, std::memory_order_relaxed);
+    auto max = detectTimeMax.load(std::memory_order_relaxed);
+    while (elapsed > max && !detectTimeMax.compare_exchange_weak(max, elapsed, std::memory_order_relaxed));
+    return lang;
+}
+
+LanguageDetector::Shard &LanguageDetector::shardFor(const std::string &user) {
+    return shards[std::hash<std::string>{}(user) % SHARDS];
+}
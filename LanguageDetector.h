@@ -0,0 +1,78 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER__LANGUAGEDETECTOR_H_
+#define CHATCONTROLLER__LANGUAGEDETECTOR_H_
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+struct LanguageDetectorConfig {
+    size_t minTextLength = 16;      // letters, shorter texts take user language from cache
+    unsigned int stableStreak = 3;  // equal detections in a row to trust user language
+    unsigned int recheckEvery = 10; // long messages of stable user are detected each N-th time
+    size_t maxUsers = 200000;
+};
+
+// Language detection stage with per-user rolling cache.
+// Short and emote-only texts are not passed to detector, for stable users most of the texts are
+// answered from cache. Detectors are created per thread, so workers don't share detector state.
+class LanguageDetector
+{
+  public:
+    static constexpr size_t SHARDS = 16;
+
+    struct Stats {
+        unsigned long long messages = 0;
+        unsigned long long detected = 0;   // passed to detector
+        unsigned long long cached = 0;     // answered from user cache
+        unsigned long long shortText = 0;  // too short and no cached language
+        unsigned long long detectTime = 0; // microseconds spent in detector
+        unsigned long long detectTimeMax = 0;
+
+        Stats& operator+=(const Stats &rhs);
+    };
+
+  public:
+    explicit LanguageDetector(LanguageDetectorConfig config);
+    ~LanguageDetector() = default;
+
+    std::string detect(const std::string &user, const std::string &text);
+
+    /// Returns counters and resets them
+    Stats collectStats();
+
+    /// Counts letters, skipping mentions, links and emote-like(CamelCase, UPPERCASE) words
+    static size_t countLetters(std::string_view text);
+  private:
+    struct UserLanguage {
+        std::string lang;
+        unsigned int streak = 0;
+        unsigned int sinceCheck = 0;
+    };
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, UserLanguage> users;
+    };
+
+    std::string detectText(const std::string &text);
+
+    Shard &shardFor(const std::string &user);
+
+    const LanguageDetectorConfig config;
+    std::array<Shard, SHARDS> shards;
+
+    std::atomic<unsigned long long> messages{0};
+    std::atomic<unsigned long long> detected{0};
+    std::atomic<unsigned long long> cached{0};
+    std::atomic<unsigned long long> shortText{0};
+    std::atomic<unsigned long long> detectTime{0};
+    std::atomic<unsigned long long> detectTimeMax{0};
+};
+
+#endif //CHATCONTROLLER__LANGUAGEDETECTOR_H_
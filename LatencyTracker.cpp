@@ -0,0 +1,50 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include "Clock.h"
+#include "LatencyTracker.h"
+
+const char *LatencyTracker::toString(Stage stage) {
+    switch (stage) {
+        case Stage::Processed:
+            return "processed";
+        case Stage::Dispatched:
+            return "dispatched";
+        case Stage::Handled:
+            return "handled";
+        case Stage::Sent:
+            return "sent";
+        case Stage::Stored:
+            return "stored";
+        case Stage::Count:
+        default:
+            return "unknown";
+    }
+}
+
+long long LatencyTracker::now() {
+    return CurrentTime<std::chrono::steady_clock>::microseconds();
+}
+
+void LatencyTracker::record(Stage stage, long long readTime) {
+    record(stage, readTime, now());
+}
+
+void LatencyTracker::record(Stage stage, long long readTime, long long time) {
+    if (readTime <= 0 || time < readTime)
+        return;
+
+    auto &target = stages[static_cast<size_t>(stage)];
+    std::lock_guard lg(target.mutex);
+    target.hist.record(time - readTime);
+}
+
+LatencyTracker::Snapshot LatencyTracker::collect() {
+    Snapshot res;
+    for (size_t i = 0; i < STAGES; ++i) {
+        std::lock_guard lg(stages[i].mutex);
+        std::swap(res[i], stages[i].hist);
+    }
+    return res;
+}
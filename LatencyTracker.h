@@ -0,0 +1,58 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER__LATENCYTRACKER_H_
+#define CHATCONTROLLER__LATENCYTRACKER_H_
+
+#include <array>
+#include <mutex>
+#include <string>
+
+#include "Histogram.h"
+#include "TraceBuffer.h"
+
+// Collects latency of chat message pipeline stages relative to socket read time.
+// All timestamps are monotonic (steady_clock) microseconds.
+class LatencyTracker
+{
+  public:
+    enum class Stage {
+        Processed,  // MessageProcessor transform finished
+        Dispatched, // BotsEnvironment routed message to bots
+        Handled,    // BotEngine handlers finished
+        Sent,       // IRCClient sent bot reply
+        Stored,     // Storage inserted message to ClickHouse
+        Count
+    };
+    static constexpr size_t STAGES = static_cast<size_t>(Stage::Count);
+    using Snapshot = std::array<Histogram, STAGES>;
+
+    static const char *toString(Stage stage);
+    static long long now();
+
+  public:
+    LatencyTracker() = default;
+    ~LatencyTracker() = default;
+
+    LatencyTracker(const LatencyTracker&) = delete;
+    LatencyTracker& operator=(const LatencyTracker&) = delete;
+
+    void record(Stage stage, long long readTime);
+    void record(Stage stage, long long readTime, long long time);
+
+    /// Returns collected histograms and resets internal state
+    Snapshot collect();
+
+    /// Spans of sampled messages, shares clock with stage latencies
+    TraceBuffer &trace() { return traceBuffer; }
+  private:
+    struct StageHistogram {
+        std::mutex mutex;
+        Histogram hist;
+    };
+    std::array<StageHistogram, STAGES> stages;
+    TraceBuffer traceBuffer;
+};
+
+#endif //CHATCONTROLLER__LATENCYTRACKER_H_
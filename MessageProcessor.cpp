@@ -8,15 +8,30 @@
 #include "ThreadName.h"
 
 #include "ChatMessage.h"
+#include "ChatSketches.h"
+#include "DBController.h"
+#include "LatencyTracker.h"
+#include "MetricsRegistry.h"
 #include "MessageProcessor.h"
 
-MessageProcessor::MessageProcessor(const context_t &ctx, so_5::mbox_t listener,
-                                   MessageProcessorConfig config, std::shared_ptr<Logger> logger)
-  : so_5::agent_t(ctx), config(std::move(config)), logger(std::move(logger)), listener(std::move(listener)) {
+static constexpr int gatherStatsDelay = 5;
+
+MessageProcessor::MessageProcessor(const context_t &ctx, so_5::mbox_t listener, so_5::mbox_t statsCollector,
+                                   MessageProcessorConfig config,
+                                   std::shared_ptr<DBController> db,
+                                   std::shared_ptr<LatencyTracker> latency,
+                                   std::shared_ptr<MetricsRegistry> channelMetrics,
+                                   std::shared_ptr<ChatSketches> sketches,
+                                   std::shared_ptr<Logger> logger)
+  : so_5::agent_t(ctx), config(std::move(config)), db(std::move(db)), latency(std::move(latency)),
+    channelMetrics(std::move(channelMetrics)), sketches(std::move(sketches)),
+    logger(std::move(logger)), listener(std::move(listener)), statsCollector(std::move(statsCollector)) {
     this->logger->logInfo("MessageProcessor init");
 
     if (this->config.languageRecognition)
-        langDetector = langdetectpp::Detector::create();
+        langDetector = std::make_unique<LanguageDetector>(this->config.language);
+    if (this->config.duplicatesDetection)
+        dupDetector = std::make_unique<DuplicateDetector>(this->config.duplicates);
 }
 
 MessageProcessor::~MessageProcessor() {
@@ -25,10 +40,21 @@ MessageProcessor::~MessageProcessor() {
 
 void MessageProcessor::so_define_agent() {
     so_subscribe_self().event(&MessageProcessor::evtIrcMessage, so_5::thread_safe);
+    so_subscribe_self().event(&MessageProcessor::evtGatherStats, so_5::thread_safe);
+    so_subscribe_self().event(&MessageProcessor::evtReloadEmotes, so_5::thread_safe);
 }
 
 void MessageProcessor::so_evt_start() {
     set_thread_name("msg_processor");
+
+    gatherStatsTimer = so_5::send_periodic<GatherStats>(*this, std::chrono::seconds{gatherStatsDelay},
+                                                        std::chrono::seconds{gatherStatsDelay});
+
+    if (config.emotesDetection) {
+        loadEmotes();
+        reloadEmotesTimer = so_5::send_periodic<ReloadEmotes>(*this, std::chrono::seconds{config.emotesReloadPeriod},
+                                                              std::chrono::seconds{config.emotesReloadPeriod});
+    }
 }
 
 void MessageProcessor::so_evt_finish() {
@@ -36,21 +62,66 @@ void MessageProcessor::so_evt_finish() {
 }
 
 void MessageProcessor::evtIrcMessage(const IRCMessage &ircMessage) {
+    const long long begin = ircMessage.traceId ? LatencyTracker::now() : 0;
+    // counted inline on pool thread, StatsCollector merges counters periodically
+    channelMetrics->add(ircMessage.channel);
     auto message = transform(ircMessage);
+    sketches->record(message->channel, message->user);
 
     logger->logTrace(R"(MessageProcessor process: {{uuid: "{}", channel: "{}", from "{}", text: "{}", lang: "{}", valid: {} }})",
                      message->uuid.second, message->channel, message->user, message->text, message->lang ,message->valid);
 
+    latency->record(LatencyTracker::Stage::Processed, message->readTime);
     so_5::send(listener, message);
+    latency->trace().span(message->traceId, "processor", begin, LatencyTracker::now());
+}
+
+void MessageProcessor::evtGatherStats(mhood_t<GatherStats>) {
+    Metrics metrics;
+    if (langDetector)
+        metrics.lang = langDetector->collectStats();
+    if (dupDetector)
+        metrics.duplicates = dupDetector->collectStats();
+    so_5::send<Metrics>(statsCollector, metrics);
+}
+
+void MessageProcessor::evtReloadEmotes(mhood_t<ReloadEmotes>) {
+    loadEmotes();
+}
+
+void MessageProcessor::loadEmotes() {
+    auto dictionary = std::make_shared<const EmoteDictionary>(db->loadEmotes());
+    if (dictionary->size() == 0 && emotes) {
+        logger->logWarn("MessageProcessor Empty emotes list loaded, previous dictionary is kept");
+        return;
+    }
+    logger->logInfo("MessageProcessor Emote dictionary with {} emotes loaded", dictionary->size());
+    std::atomic_store(&emotes, std::move(dictionary));
 }
 
 MessageProcessor::MessageHolder MessageProcessor::transform(const IRCMessage &message) {
     std::string lang = "UNKNOWN";
     if (this->config.languageRecognition)
-        lang = langdetectpp::toShortName(langDetector->detect(message.text));
+        lang = langDetector->detect(message.nickname, message.text);
+
+    // positions from tags are exact, dictionary is used only when tags are not received
+    std::vector<std::string> emoteIds;
+    if (message.emotesTag) {
+        emoteIds = EmoteDictionary::fromTag(*message.emotesTag);
+    } else if (this->config.emotesDetection) {
+        if (auto dictionary = std::atomic_load(&emotes))
+            emoteIds = dictionary->extract(message.text);
+    }
+
+    // uuid is generated here to be kept in duplicates window as reference
+    auto uuid = Utils::UUIDv4::pair();
+    DuplicateDetector::Result duplicate;
+    if (this->config.duplicatesDetection)
+        duplicate = dupDetector->check(message.channel, uuid.first, message.text, message.timestamp);
 
     bool valid = !message.text.empty();
 
     return MessageHolder::make(message.nickname, message.channel, message.text,
-                               std::move(lang), message.timestamp, valid);
+                               std::move(lang), message.timestamp, valid, message.readTime, std::move(emoteIds),
+                               duplicate.dupOf, duplicate.exact, std::move(uuid), message.traceId);
 }
@@ -10,27 +10,52 @@
 #include <vector>
 #include <set>
 
-#include <langdetectpp/langdetectpp.h>
 #include <so_5/agent.hpp>
+#include <so_5/timers.hpp>
 
 #include "irc/IRCMessage.h"
 
+#include "LanguageDetector.h"
+#include "EmoteDictionary.h"
+#include "DuplicateDetector.h"
 #include "ChatMessage.h"
 
 class ThreadPool;
 class Logger;
+class DBController;
+class LatencyTracker;
+class MetricsRegistry;
+class ChatSketches;
 
 struct MessageProcessorConfig {
     bool languageRecognition = false;
+    LanguageDetectorConfig language;
+    bool emotesDetection = false;
+    unsigned int emotesReloadPeriod = 600; // seconds
+    bool duplicatesDetection = false;
+    DuplicateDetectorConfig duplicates;
 };
 
 class MessageProcessor final : public so_5::agent_t
 {
     using MessageHolder = so_5::message_holder_t<Chat::Message>;
+  public:
+    struct GatherStats final : public so_5::signal_t {};
+    struct ReloadEmotes final : public so_5::signal_t {};
+    struct Metrics {
+        LanguageDetector::Stats lang;
+        DuplicateDetector::Stats duplicates;
+    };
+
   public:
     explicit MessageProcessor(const context_t &ctx,
                               so_5::mbox_t listener,
+                              so_5::mbox_t statsCollector,
                               MessageProcessorConfig config,
+                              std::shared_ptr<DBController> db,
+                              std::shared_ptr<LatencyTracker> latency,
+                              std::shared_ptr<MetricsRegistry> channelMetrics,
+                              std::shared_ptr<ChatSketches> sketches,
                               std::shared_ptr<Logger> logger);
     ~MessageProcessor() override;
 
@@ -41,15 +66,27 @@ class MessageProcessor final : public so_5::agent_t
 
     // so_5 events
     void evtIrcMessage(const IRCMessage &ircMessage);
+    void evtGatherStats(mhood_t<GatherStats> evt);
+    void evtReloadEmotes(mhood_t<ReloadEmotes> evt);
   private:
     MessageHolder transform(const IRCMessage &message);
+    void loadEmotes();
 
     const MessageProcessorConfig config;
 
+    const std::shared_ptr<DBController> db;
+    const std::shared_ptr<LatencyTracker> latency;
+    const std::shared_ptr<MetricsRegistry> channelMetrics;
+    const std::shared_ptr<ChatSketches> sketches;
     const std::shared_ptr<Logger> logger;
-    std::shared_ptr<langdetectpp::Detector> langDetector;
+    std::unique_ptr<LanguageDetector> langDetector;
+    std::unique_ptr<DuplicateDetector> dupDetector;
+    std::shared_ptr<const EmoteDictionary> emotes; // swapped atomically on reload
 
+    so_5::timer_id_t reloadEmotesTimer;
     so_5::mbox_t listener;
+    so_5::mbox_t statsCollector;
+    so_5::timer_id_t gatherStatsTimer;
 };
 
 #endif //CHATSNIFFER__MESSAGEPROCESSOR_H_
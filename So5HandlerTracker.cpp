@@ -0,0 +1,156 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <cxxabi.h>
+
+#include <so_5/agent.hpp>
+#include <so_5/enveloped_msg.hpp>
+#include <so_5/version.hpp>
+
+#include "Clock.h"
+#include "So5HandlerTracker.h"
+
+static std::string demangle(const char *name) {
+    int status = 0;
+    std::unique_ptr<char, void (*)(void *)> res{abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free};
+    return status == 0 && res ? std::string(res.get()) : std::string(name);
+}
+
+static void updateMax(std::atomic<unsigned long long> &max, unsigned long long value) {
+    auto current = max.load(std::memory_order_relaxed);
+    while (current < value && !max.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+
+// holds original message, payload is given to handler by so_5 itself
+class So5HandlerTracker::Envelope final : public so_5::enveloped_msg::envelope_t
+{
+  public:
+    Envelope(so_5::message_ref_t message, Slot *slot)
+      : message(std::move(message)), slot(slot), pushed(CurrentTime<std::chrono::steady_clock>::microseconds()) {}
+
+    void access_hook(so_5::enveloped_msg::access_context_t context,
+                     so_5::enveloped_msg::handler_invoker_t &invoker) noexcept override {
+        if (context != so_5::enveloped_msg::access_context_t::handler_found) {
+            invoker.invoke(so_5::enveloped_msg::payload_info_t{message});
+            return;
+        }
+
+        auto start = CurrentTime<std::chrono::steady_clock>::microseconds();
+        slot->runningSince.store(start, std::memory_order_relaxed);
+
+        invoker.invoke(so_5::enveloped_msg::payload_info_t{message});
+
+        auto finish = CurrentTime<std::chrono::steady_clock>::microseconds();
+        auto exec = static_cast<unsigned long long>(finish - start);
+        auto wait = static_cast<unsigned long long>(std::max(start - pushed, 0LL));
+        slot->runningSince.store(0, std::memory_order_relaxed);
+        slot->thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        slot->count.fetch_add(1, std::memory_order_relaxed);
+        slot->execTotal.fetch_add(exec, std::memory_order_relaxed);
+        slot->waitTotal.fetch_add(wait, std::memory_order_relaxed);
+        updateMax(slot->execMax, exec);
+        updateMax(slot->waitMax, wait);
+    }
+
+  private:
+    so_5::message_ref_t message;
+    Slot *const slot;
+    const long long pushed;
+};
+
+// wraps queue of one agent, keeps slots of its message types
+class So5HandlerTracker::Queue final : public so_5::event_queue_t
+{
+  public:
+    Queue(So5HandlerTracker &tracker, so_5::event_queue_t *original, std::type_index agent)
+      : tracker(tracker), original(original), agent(agent) {}
+
+    void push(so_5::execution_demand_t demand) override {
+        original->push(wrap(std::move(demand)));
+    }
+
+#if SO_5_VERSION >= SO_5_VERSION_MAKE(5u, 8u, 0u)
+    void push_evt_start(so_5::execution_demand_t demand) override {
+        original->push_evt_start(std::move(demand));
+    }
+
+    void push_evt_finish(so_5::execution_demand_t demand) noexcept override {
+        original->push_evt_finish(std::move(demand));
+    }
+#endif
+
+  private:
+    so_5::execution_demand_t wrap(so_5::execution_demand_t demand) {
+        // start/finish and already enveloped messages go as is
+        if (demand.m_demand_handler != so_5::agent_t::get_demand_handler_on_message_ptr())
+            return demand;
+
+        auto *envelope = new Envelope(std::move(demand.m_message_ref), slot(demand.m_msg_type));
+        demand.m_message_ref = so_5::message_ref_t(envelope);
+        demand.m_demand_handler = so_5::agent_t::get_demand_handler_on_enveloped_msg_ptr();
+        return demand;
+    }
+
+    Slot *slot(std::type_index event) {
+        // agent has a few message types, linear search under queue lock is enough
+        std::lock_guard lg(mutex);
+        for (auto &[type, slot]: cache) {
+            if (type == event)
+                return slot;
+        }
+        return cache.emplace_back(event, tracker.slot(agent, event)).second;
+    }
+
+    So5HandlerTracker &tracker;
+    so_5::event_queue_t *const original;
+    const std::type_index agent;
+
+    std::mutex mutex;
+    std::vector<std::pair<std::type_index, Slot *>> cache;
+};
+
+So5HandlerTracker::~So5HandlerTracker() = default;
+
+so_5::event_queue_t *So5HandlerTracker::on_bind(so_5::agent_t *agent, so_5::event_queue_t *original) noexcept {
+    return new Queue(*this, original, std::type_index(typeid(*agent)));
+}
+
+void So5HandlerTracker::on_unbind(so_5::agent_t *, so_5::event_queue_t *queue) noexcept {
+    delete static_cast<Queue *>(queue);
+}
+
+So5HandlerTracker::Slot *So5HandlerTracker::slot(std::type_index agent, std::type_index event) {
+    std::lock_guard lg(mutex);
+    auto &slot = slots[{agent, event}];
+    if (!slot)
+        slot.reset(new Slot{agent, event});
+    return slot.get();
+}
+
+std::vector<So5HandlerTracker::Entry> So5HandlerTracker::collect(bool resetMax) {
+    auto now = CurrentTime<std::chrono::steady_clock>::microseconds();
+
+    std::vector<Entry> res;
+    std::lock_guard lg(mutex);
+    res.reserve(slots.size());
+    for (auto &[key, slot]: slots) {
+        Entry entry;
+        entry.agent = demangle(slot->agent.name());
+        entry.event = demangle(slot->event.name());
+        entry.thread = slot->thread.load(std::memory_order_relaxed);
+        entry.count = slot->count.load(std::memory_order_relaxed);
+        entry.execTotal = slot->execTotal.load(std::memory_order_relaxed);
+        entry.waitTotal = slot->waitTotal.load(std::memory_order_relaxed);
+        entry.execMax = resetMax ? slot->execMax.exchange(0, std::memory_order_relaxed)
+                                 : slot->execMax.load(std::memory_order_relaxed);
+        entry.waitMax = resetMax ? slot->waitMax.exchange(0, std::memory_order_relaxed)
+                                 : slot->waitMax.load(std::memory_order_relaxed);
+        auto since = slot->runningSince.load(std::memory_order_relaxed);
+        entry.running = since ? std::max(now - since, 0LL) : 0;
+        res.push_back(std::move(entry));
+    }
+    return res;
+}
@@ -0,0 +1,75 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER__SO5HANDLERTRACKER_H_
+#define CHATCONTROLLER__SO5HANDLERTRACKER_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+#include <so_5/event_queue_hook.hpp>
+#include <so_5/execution_demand.hpp>
+
+// Queue wait and execution time of so_5 event handlers by agent and message type.
+// Installed as environment event queue hook: every message pushed to agent queue is wrapped into envelope
+// with push time, envelope records timings around handler when so_5 hands payload to it.
+// Demand handler becomes so_5 own handler of enveloped messages, dispatchers keep thread safety of subscription for it.
+// Costs one allocation per demand, so it is enabled by config only.
+class So5HandlerTracker final : public so_5::event_queue_hook_t
+{
+  public:
+    struct Entry {
+        std::string agent;
+        std::string event;
+        std::thread::id thread;            // thread of the latest handled event, maps agent to dispatcher
+        unsigned long long count = 0;
+        unsigned long long execTotal = 0;  // microseconds
+        unsigned long long execMax = 0;
+        unsigned long long waitTotal = 0;  // microseconds between push to queue and handler start
+        unsigned long long waitMax = 0;
+        long long running = 0;             // microseconds of handler in progress, 0 if idle
+    };
+
+  public:
+    So5HandlerTracker() = default;
+    ~So5HandlerTracker() override;
+
+    So5HandlerTracker(const So5HandlerTracker&) = delete;
+    So5HandlerTracker& operator=(const So5HandlerTracker&) = delete;
+
+    // so_5::event_queue_hook_t implementation
+    so_5::event_queue_t *on_bind(so_5::agent_t *agent, so_5::event_queue_t *original) noexcept override;
+    void on_unbind(so_5::agent_t *agent, so_5::event_queue_t *queue) noexcept override;
+
+    /// Totals since start for every agent and event pair, maximums are reset when resetMax is set
+    std::vector<Entry> collect(bool resetMax);
+  private:
+    struct Slot {
+        std::type_index agent;
+        std::type_index event;
+        std::atomic<std::thread::id> thread{};
+        std::atomic<unsigned long long> count{0};
+        std::atomic<unsigned long long> execTotal{0};
+        std::atomic<unsigned long long> execMax{0};
+        std::atomic<unsigned long long> waitTotal{0};
+        std::atomic<unsigned long long> waitMax{0};
+        std::atomic<long long> runningSince{0}; // approximate for thread safe handlers running in parallel
+    };
+    class Queue;
+    class Envelope;
+
+    Slot *slot(std::type_index agent, std::type_index event);
+
+    std::mutex mutex;
+    std::map<std::pair<std::type_index, std::type_index>, std::unique_ptr<Slot>> slots;
+};
+
+#endif //CHATCONTROLLER__SO5HANDLERTRACKER_H_
@@ -2,6 +2,8 @@
 // Created by l2pic on 07.05.2021.
 //
 
+#include <algorithm>
+
 #include <nlohmann/json.hpp>
 #include <so_5/stats/std_names.hpp>
 
@@ -9,33 +11,53 @@
 #include "Logger.h"
 #include "ThreadName.h"
 #include "DBController.h"
+#include "MetricsRegistry.h"
+#include "MetricsWriter.h"
+#include "So5HandlerTracker.h"
 #include "StatsCollector.h"
 
 using json = nlohmann::json;
 
 StatsCollector::StatsCollector(const context_t &ctx,
-                             so_5::mbox_t publisher,
                              so_5::mbox_t http,
                              std::shared_ptr<Logger> logger,
-                             std::shared_ptr<DBController> db)
+                             std::shared_ptr<DBController> db,
+                             std::shared_ptr<LatencyTracker> latency,
+                             std::shared_ptr<MetricsRegistry> channelMetrics,
+                             std::shared_ptr<ChatSketches> sketches,
+                             std::shared_ptr<So5HandlerTracker> handlerTracker)
   : so_5::agent_t(ctx),
-    publisher(std::move(publisher)),
     http(std::move(http)),
     logger(std::move(logger)),
-    db(std::move(db)) {
+    db(std::move(db)),
+    latency(std::move(latency)),
+    channelMetrics(std::move(channelMetrics)),
+    sketches(std::move(sketches)),
+    handlerTracker(std::move(handlerTracker)) {
 }
 
 StatsCollector::~StatsCollector() = default;
 
+void StatsCollector::setRollup(so_5::mbox_t storage, unsigned int period) {
+    rollupStorage = std::move(storage);
+    rollupPeriod = period;
+}
+
 void StatsCollector::so_define_agent() {
     using namespace so_5::stats;
 
     so_subscribe(so_environment().stats_controller().mbox()).event(&StatsCollector::evtQuantity);
+    so_subscribe(so_environment().stats_controller().mbox()).event(&StatsCollector::evtWorkThreadActivity);
     so_subscribe_self().event(&StatsCollector::evtIRCMetrics);
     so_subscribe_self().event(&StatsCollector::evtIRCClientChannelsMetrics);
-    so_subscribe(publisher).event(&StatsCollector::evtRecvMessageMetric);
+    so_subscribe_self().event(&StatsCollector::evtIRCClientJoinMetrics);
+    so_subscribe_self().event(&StatsCollector::evtIRCSelectorsMetrics);
+    so_subscribe_self().event(&StatsCollector::evtIRCAdmissionMetrics);
+    so_subscribe_self().event(&StatsCollector::evtCollectMetrics);
     so_subscribe_self().event(&StatsCollector::evtSendMessageMetric);
     so_subscribe_self().event(&StatsCollector::evtCHPoolMetric);
+    so_subscribe_self().event(&StatsCollector::evtBotMetrics);
+    so_subscribe_self().event(&StatsCollector::evtProcessorMetrics);
 
     so_subscribe(http).event(&StatsCollector::evtHttpSo5Disp);
     so_subscribe(http).event(&StatsCollector::evtHttpIrcBots);
@@ -44,6 +66,13 @@ void StatsCollector::so_define_agent() {
     so_subscribe(http).event(&StatsCollector::evtHttpIrcStats);
     so_subscribe(http).event(&StatsCollector::evtHttpAccountsStats);
     so_subscribe(http).event(&StatsCollector::evtHttpChannelsStats);
+    so_subscribe(http).event(&StatsCollector::evtHttpLatencyStats);
+    so_subscribe(http).event(&StatsCollector::evtHttpProcessorStats);
+    so_subscribe(http).event(&StatsCollector::evtHttpMetrics);
+    so_subscribe(http).event(&StatsCollector::evtHttpWindowStats);
+    so_subscribe(http).event(&StatsCollector::evtHttpTopStats);
+    so_subscribe(http).event(&StatsCollector::evtHttpChattersStats);
+    so_subscribe(http).event(&StatsCollector::evtHttpTraceStats);
 
     so_set_delivery_filter(so_environment().stats_controller().mbox(),
                            []( const messages::quantity< std::size_t > & msg ) {
@@ -56,6 +85,9 @@ void StatsCollector::so_evt_start() {
 
     so_environment().stats_controller().set_distribution_period(std::chrono::seconds(1));
     so_environment().stats_controller().turn_on();
+
+    collectMetricsTimer = so_5::send_periodic<CollectMetrics>(*this, std::chrono::seconds(1), std::chrono::seconds(1));
+    lastRollup = CurrentTime<std::chrono::system_clock>::seconds();
 }
 
 void StatsCollector::so_evt_finish() {
@@ -66,8 +98,24 @@ void StatsCollector::evtQuantity(const so_5::stats::messages::quantity<std::size
     dispStats[evt.m_prefix].size = evt.m_value;
 }
 
+void StatsCollector::evtWorkThreadActivity(const so_5::stats::messages::work_thread_activity &evt) {
+    // distributed only when work thread activity tracking is turned on
+    auto &stats = threadStats[evt.m_thread_id];
+    stats.dispatcher = evt.m_prefix.c_str();
+    stats.activity = evt.m_stats;
+}
+
 void StatsCollector::evtIRCMetrics(mhood_t<Irc::SessionMetrics> evt) {
     allIrcStats += evt->stats;
+    totals.accounts[evt->nick] += evt->stats;
+
+    auto now = CurrentTime<std::chrono::system_clock>::seconds();
+    const auto &commands = evt->stats.commands;
+    accountWindows[evt->nick].add(now, AccountWindowStats{commands.in.bytes, commands.in.count,
+                                                          commands.out.bytes, commands.out.count});
+    if (commands.ping_pong.histogram.count())
+        rttWindows[evt->nick].add(now, commands.ping_pong.histogram);
+
     auto &sessionStats = ircStats[evt->nick];
     if (sessionStats.size() <= evt->id) {
         sessionStats.resize(evt->id + 1);
@@ -76,28 +124,210 @@ void StatsCollector::evtIRCMetrics(mhood_t<Irc::SessionMetrics> evt) {
 }
 
 void StatsCollector::evtIRCClientChannelsMetrics(so_5::mhood_t<Irc::ClientChannelsMetrics> evt) {
-    ircClientChannels[evt->nick] = std::move(evt->channelsToSession);
+    // clients send full list once after load, then only changed channels
+    auto &channels = ircClientChannels[evt->nick];
+    if (evt->delta.full)
+        channels.clear();
+    for (auto &[name, id]: evt->delta.channels) {
+        if (id == Irc::ChannelsDelta::REMOVED)
+            channels.erase(name);
+        else
+            channels[std::move(name)] = id;
+    }
 }
 
-void StatsCollector::evtRecvMessageMetric(so_5::mhood_t<Chat::Message> evt) {
-    auto &stats = channelsStats[evt->channel];
-    ++stats.in.count;
-    stats.updated = CurrentTime<std::chrono::system_clock>::milliseconds();
+void StatsCollector::evtIRCAdmissionMetrics(so_5::mhood_t<IRCConnectAdmission::Metrics> evt) {
+    admissionStats.storm = evt->storm;
+    admissionStats.queued = evt->queued;
+    admissionStats.inflight = evt->inflight;
+    admissionStats.granted += evt->granted;
+    admissionStats.disconnects += evt->disconnects;
+    admissionStats.storms += evt->storms;
+    totals.admission.granted += evt->granted;
+    totals.admission.disconnects += evt->disconnects;
+    totals.admission.storms += evt->storms;
+}
+
+void StatsCollector::evtIRCClientJoinMetrics(so_5::mhood_t<Irc::ClientJoinMetrics> evt) {
+    auto &stats = ircJoinStats[evt->nick];
+    stats.channels += evt->stats.channels;
+    stats.lines += evt->stats.lines;
+    stats.backlog = evt->stats.backlog;
+    stats.inflight = evt->stats.inflight;
+    stats.wait.merge(evt->stats.wait);
+    stats.latency.merge(evt->stats.latency);
+
+    auto &total = totals.joins[evt->nick];
+    total.channels += evt->stats.channels;
+    total.lines += evt->stats.lines;
+    total.backlog = evt->stats.backlog;
+    total.inflight = evt->stats.inflight;
+    total.wait.merge(evt->stats.wait);
+    total.latency.merge(evt->stats.latency);
+}
+
+void StatsCollector::evtIRCSelectorsMetrics(so_5::mhood_t<Irc::SelectorsMetrics> evt) {
+    auto merge = [] (std::vector<IRCSelectorStatistic> &all, const std::vector<IRCSelectorStatistic> &selectors) {
+        if (all.size() < selectors.size())
+            all.resize(selectors.size());
+        for (size_t i = 0; i < selectors.size(); ++i) {
+            const auto &src = selectors[i];
+            auto &stats = all[i];
+            stats.id = src.id;
+            stats.sessions = src.sessions;
+            stats.utilisation = src.utilisation;
+            stats.bytesRate = src.bytesRate;
+            stats.rounds += src.rounds;
+            stats.busy += src.busy;
+            stats.loop.merge(src.loop);
+            stats.lag.merge(src.lag);
+        }
+    };
+    merge(ircSelectorStats, evt->selectors);
+    merge(totals.selectors, evt->selectors);
+}
+
+void StatsCollector::evtCollectMetrics(so_5::mhood_t<CollectMetrics>) {
+    collectChannelMetrics();
+    collectLatency();
+    collectSketches();
+
+    auto now = CurrentTime<std::chrono::system_clock>::seconds();
+    if (now - lastEviction >= 60) {
+        evictIdleWindows();
+        lastEviction = now;
+    }
+    if (rollupPeriod && rollupStorage && now - lastRollup >= rollupPeriod)
+        flushRollup(now);
+}
+
+void StatsCollector::collectChannelMetrics() {
+    auto snapshot = channelMetrics->collect();
+    if (snapshot.counters.empty())
+        return;
+
+    auto now = CurrentTime<std::chrono::system_clock>::milliseconds();
+    for (auto &[id, count]: snapshot.counters) {
+        if (id >= channelNames.size())
+            channelNames.resize(id + 1);
+        if (channelNames[id].empty())
+            channelNames[id] = channelMetrics->counterName(id);
+
+        auto &stats = channelsStats[channelNames[id]];
+        stats.in.count += static_cast<int>(count);
+        stats.updated = now;
+        totals.messagesIn += count;
+        channelWindows[channelNames[id]].add(now / 1000, ChannelWindowStats{static_cast<unsigned int>(count), 0});
+        if (rollupPeriod)
+            rollup[channelNames[id]].messages += count;
+    }
+}
+
+void StatsCollector::collectLatency() {
+    auto now = CurrentTime<std::chrono::system_clock>::seconds();
+    auto snapshot = latency->collect();
+    for (size_t i = 0; i < LatencyTracker::STAGES; ++i) {
+        if (!snapshot[i].count())
+            continue;
+        latencyStats[i].merge(snapshot[i]);
+        totals.latency[i].merge(snapshot[i]);
+        latencyWindows[i].add(now, snapshot[i]);
+    }
+}
+
+void StatsCollector::collectSketches() {
+    auto snapshot = sketches->collect();
+    if (snapshot.empty())
+        return;
+
+    auto now = CurrentTime<std::chrono::system_clock>::seconds();
+    topChannelsWindow.add(now, snapshot.channels);
+    topChattersWindow.add(now, snapshot.chatters);
+    chattersWindow.add(now, snapshot.users);
+    for (auto &[channel, users]: snapshot.channelUsers) {
+        channelChatters[channel].add(now / CHATTERS_SLOT, users);
+        if (rollupPeriod)
+            rollup[channel].chatters.merge(users);
+    }
+}
+
+void StatsCollector::flushRollup(long long now) {
+    // messages counted by threads after the last collect fall to the next period
+    Storage::ChannelRollup msg;
+    msg.timestamp = lastRollup;
+    msg.period = static_cast<unsigned int>(now - lastRollup);
+    msg.rows.reserve(rollup.size());
+    for (auto &[channel, row]: rollup)
+        msg.rows.push_back({channel, row.messages, row.chatters.estimate()});
+    rollup.clear();
+    lastRollup = now;
+
+    if (!msg.rows.empty())
+        so_5::send<Storage::ChannelRollup>(rollupStorage, std::move(msg));
+}
+
+void StatsCollector::evictIdleWindows() {
+    auto now = CurrentTime<std::chrono::system_clock>::seconds();
+    for (auto it = channelWindows.begin(); it != channelWindows.end();) {
+        if (it->second.idle(now))
+            it = channelWindows.erase(it);
+        else
+            ++it;
+    }
+    for (auto it = accountWindows.begin(); it != accountWindows.end();) {
+        if (it->second.idle(now))
+            it = accountWindows.erase(it);
+        else
+            ++it;
+    }
+    for (auto it = rttWindows.begin(); it != rttWindows.end();) {
+        if (it->second.idle(now))
+            it = rttWindows.erase(it);
+        else
+            ++it;
+    }
+    for (auto it = channelChatters.begin(); it != channelChatters.end();) {
+        if (it->second.last() <= now / CHATTERS_SLOT - 7)
+            it = channelChatters.erase(it);
+        else
+            ++it;
+    }
 }
 
 void StatsCollector::evtSendMessageMetric(so_5::mhood_t<Chat::SendMessage> evt) {
     auto &stats = channelsStats[evt->channel];
     ++stats.out.count;
+    ++totals.messagesOut;
     stats.updated = CurrentTime<std::chrono::system_clock>::milliseconds();
+    channelWindows[evt->channel].add(stats.updated / 1000, ChannelWindowStats{0, 1});
 }
 
 void StatsCollector::evtCHPoolMetric(so_5::mhood_t<Storage::CHPoolMetrics> evt) {
     chPoolStats.resize(std::max(chPoolStats.size(), evt->stats.size()));
-    for (size_t i = 0; i < chPoolStats.size(); ++i) {
-        if (i >= evt->stats.size())
-            break;
+    totals.chPool.resize(std::max(totals.chPool.size(), evt->stats.size()));
+    StorageWindowStats window;
+    for (size_t i = 0; i < evt->stats.size(); ++i) {
         chPoolStats[i] += evt->stats[i];
+        totals.chPool[i] += evt->stats[i];
+        window.inserts += evt->stats[i].count;
+        window.rows += evt->stats[i].rows;
+        window.failed += evt->stats[i].failed;
     }
+    storageWindow.add(CurrentTime<std::chrono::system_clock>::seconds(), window);
+}
+
+void StatsCollector::evtBotMetrics(so_5::mhood_t<Bot::Metrics> evt) {
+    if (evt->removed)
+        botStats.erase(evt->stats.botId);
+    else
+        botStats[evt->stats.botId] = evt->stats;
+}
+
+void StatsCollector::evtProcessorMetrics(so_5::mhood_t<MessageProcessor::Metrics> evt) {
+    langStats += evt->lang;
+    dupStats += evt->duplicates;
+    totals.lang += evt->lang;
+    totals.dup += evt->duplicates;
 }
 
 void StatsCollector::evtHttpSo5Disp(so_5::mhood_t<hreq::stats::so5disp> evt) {
@@ -109,26 +339,76 @@ void StatsCollector::evtHttpSo5Disp(so_5::mhood_t<hreq::stats::so5disp> evt) {
                                {"size", stats.size}});
     }
 
+    auto activityToJson = [] (const so_5::stats::activity_stats_t &stats) {
+        using std::chrono::duration_cast;
+        return json{{"count", stats.m_count},
+                    {"total_us", duration_cast<std::chrono::microseconds>(stats.m_total_time).count()},
+                    {"avg_us", duration_cast<std::chrono::microseconds>(stats.m_avg_time).count()}};
+    };
+    auto &threads = res["threads"] = json::array();
+    for (auto &[id, stats]: threadStats) {
+        threads.push_back({{"dispatcher", stats.dispatcher},
+                           {"thread", std::hash<so_5::current_thread_id_t>{}(id)},
+                           {"working", activityToJson(stats.activity.m_working_stats)},
+                           {"waiting", activityToJson(stats.activity.m_waiting_stats)}});
+    }
+
+    res["tracking"] = handlerTracker != nullptr;
+    auto &handlers = res["handlers"] = json::array();
+    if (handlerTracker) {
+        // maximums are since previous request, the heaviest handlers go first
+        auto entries = handlerTracker->collect(true);
+        std::sort(entries.begin(), entries.end(), [] (const auto &lhs, const auto &rhs) {
+            return lhs.execTotal > rhs.execTotal;
+        });
+        auto avg = [] (unsigned long long total, unsigned long long count) {
+            return count ? total / count : 0;
+        };
+        for (auto &entry: entries) {
+            auto thread = threadStats.find(entry.thread);
+            handlers.push_back({{"agent", entry.agent},
+                                {"event", entry.event},
+                                {"dispatcher", thread != threadStats.end() ? thread->second.dispatcher : std::string()},
+                                {"count", entry.count},
+                                {"exec", {{"total_us", entry.execTotal},
+                                          {"avg_us", avg(entry.execTotal, entry.count)},
+                                          {"max_us", entry.execMax}}},
+                                {"wait", {{"total_us", entry.waitTotal},
+                                          {"avg_us", avg(entry.waitTotal, entry.count)},
+                                          {"max_us", entry.waitMax}}},
+                                {"running_us", entry.running}});
+        }
+    }
+
     send_http_resp(http, evt, 200, res.dump());
 }
 
 void StatsCollector::evtHttpIrcBots(so_5::mhood_t<hreq::stats::bot> evt) {
-    //json req = json::parse(evt->req.body(), nullptr, false, true);
-    //if (req.is_discarded())
-    //    return send_http_resp(http, evt, 400, resp("Failed to parse JSON"));
-
-    /*std::string channelName;
-    ChannelStatistic stats;
-    {
-        std::lock_guard lg(ircClientsMutex);
-        for(auto &[id, client] : ircClientsById) {
-            stats += client->getChannelStatic(channelName);
+    // bot stats are gauges, so they are kept between requests
+    json body = json::object();
+    auto &bots = body["bots"] = json::array();
+    if (evt->req.body().empty()) {
+        for (auto &[id, stats]: botStats)
+            bots.push_back(botStatisticToJson(stats));
+    } else {
+        json req = json::parse(evt->req.body(), nullptr, false, true);
+        if (req.is_discarded())
+            return send_http_resp(http, evt, 400, resp("Failed to parse JSON"));
+
+        const auto &list = req["bots"];
+        if (!list.is_array())
+            return send_http_resp(http, evt, 400, resp("Invalid bots type"));
+
+        for (const auto &bot: list) {
+            if (!bot.is_number())
+                continue;
+            auto it = botStats.find(bot.get<int>());
+            if (it != botStats.end())
+                bots.push_back(botStatisticToJson(it->second));
         }
-    }*/
-    //json body = json::object();
-    //body[channelName] = statsToJson(stats);
-    //send_http_resp(http, evt, 200, body.dump());
-    send_http_resp(http, evt, 200, resp(__PRETTY_FUNCTION__));
+    }
+
+    send_http_resp(http, evt, 200, body.dump());
 }
 
 void StatsCollector::evtHttpStorageStats(so_5::mhood_t<hreq::stats::storage> evt) {
@@ -154,6 +434,36 @@ void StatsCollector::evtHttpDbStats(so_5::mhood_t<hreq::stats::db> evt) {
 void StatsCollector::evtHttpIrcStats(so_5::mhood_t<hreq::stats::irc> evt) {
     json body = ircStatisticToJson(allIrcStats);
     allIrcStats.clear();
+
+    // storm, queued and inflight are gauges
+    body["admission"] = {
+        {"storm", admissionStats.storm},
+        {"queued", admissionStats.queued},
+        {"inflight", admissionStats.inflight},
+        {"granted", admissionStats.granted},
+        {"disconnects", admissionStats.disconnects},
+        {"storms", admissionStats.storms}
+    };
+    admissionStats.granted = 0;
+    admissionStats.disconnects = 0;
+    admissionStats.storms = 0;
+
+    // sessions, utilisation and bytes rate are gauges of the last period
+    auto &selectors = body["selectors"] = json::array();
+    for (auto &stats: ircSelectorStats) {
+        selectors.push_back({{"id", stats.id},
+                             {"sessions", stats.sessions},
+                             {"utilisation", stats.utilisation},
+                             {"bytes_rate", stats.bytesRate},
+                             {"rounds", stats.rounds},
+                             {"busy", stats.busy},
+                             {"loop", histogramToJson(stats.loop)},
+                             {"lag", histogramToJson(stats.lag)}});
+        stats.rounds = 0;
+        stats.busy = 0;
+        stats.loop.clear();
+        stats.lag.clear();
+    }
     send_http_resp(http, evt, 200, body.dump());
 }
 
@@ -164,7 +474,9 @@ void StatsCollector::evtHttpAccountsStats(so_5::mhood_t<hreq::stats::account> ev
         json res = json::object();
         auto &sessions = res["sessions"] = json::array();
         bool hasUnattached = false;
+        Histogram rtt;
         for (size_t i = 0; i < stats.size(); ++i) {
+            rtt.merge(stats[i].commands.ping_pong.histogram);
             auto session = ircStatisticToJson(stats[i]);
             auto &joinedTo = session["channels"] = json::array();
             for (auto &[name, id]: channels) {
@@ -186,6 +498,23 @@ void StatsCollector::evtHttpAccountsStats(so_5::mhood_t<hreq::stats::account> ev
             }
         }
 
+        res["rtt"] = histogramToJson(rtt);
+
+        // backlog and inflight are gauges, counters are reset on read
+        auto &joins = ircJoinStats[nick];
+        res["joins"] = {
+            {"channels", joins.channels},
+            {"lines", joins.lines},
+            {"backlog", joins.backlog},
+            {"inflight", joins.inflight},
+            {"wait", histogramToJson(joins.wait)},
+            {"latency", histogramToJson(joins.latency)}
+        };
+        joins.channels = 0;
+        joins.lines = 0;
+        joins.wait.clear();
+        joins.latency.clear();
+
         return res;
     };
 
@@ -225,6 +554,9 @@ void StatsCollector::evtHttpAccountsStats(so_5::mhood_t<hreq::stats::account> ev
 }
 
 void StatsCollector::evtHttpChannelsStats(so_5::mhood_t<hreq::stats::channel> evt) {
+    // counters bumped since last timer tick belong to this read
+    collectChannelMetrics();
+
     auto statsToJson = [] (const std::string& name, auto&& stats) {
         json channel = json::object();
         channel["name"] = name;
@@ -264,3 +596,461 @@ void StatsCollector::evtHttpChannelsStats(so_5::mhood_t<hreq::stats::channel> ev
 
     send_http_resp(http, evt, 200, body.dump());
 }
+
+void StatsCollector::evtHttpLatencyStats(so_5::mhood_t<hreq::stats::latency> evt) {
+    collectLatency();
+    LatencyTracker::Snapshot snapshot;
+    std::swap(snapshot, latencyStats);
+
+    json body = json::object();
+    body["unit"] = "us";
+    auto &stages = body["stages"] = json::object();
+    for (size_t i = 0; i < LatencyTracker::STAGES; ++i) {
+        auto stage = static_cast<LatencyTracker::Stage>(i);
+        stages[LatencyTracker::toString(stage)] = histogramToJson(snapshot[i]);
+    }
+
+    send_http_resp(http, evt, 200, body.dump());
+}
+
+void StatsCollector::evtHttpProcessorStats(so_5::mhood_t<hreq::stats::processor> evt) {
+    const auto &lang = langStats;
+    auto hitRate = lang.messages ? static_cast<double>(lang.cached) / static_cast<double>(lang.messages) : 0.0;
+    auto avgTime = lang.detected ? lang.detectTime / lang.detected : 0;
+
+    json body = json::object();
+    body["lang"] = {
+        {"messages", lang.messages},
+        {"detected", lang.detected},
+        {"cached", lang.cached},
+        {"short", lang.shortText},
+        {"hit_rate", hitRate},
+        {"detect_time", {{"total", lang.detectTime}, {"avg", avgTime}, {"max", lang.detectTimeMax}}}
+    };
+    langStats = {};
+
+    const auto &dup = dupStats;
+    auto dupRate = dup.checked ? static_cast<double>(dup.duplicates) / static_cast<double>(dup.checked) : 0.0;
+    body["duplicates"] = {
+        {"checked", dup.checked},
+        {"duplicates", dup.duplicates},
+        {"exact", dup.exact},
+        {"rate", dupRate}
+    };
+    dupStats = {};
+
+    send_http_resp(http, evt, 200, body.dump());
+}
+
+void StatsCollector::evtHttpWindowStats(so_5::mhood_t<hreq::stats::window> evt) {
+    // {"family": "channel|account|storage|latency", "window": seconds, "names": [channels or accounts]}
+    json req = evt->req.body().empty() ? json::object() : json::parse(evt->req.body(), nullptr, false, true);
+    if (req.is_discarded() || !req.is_object())
+        return send_http_resp(http, evt, 400, resp("Failed to parse JSON"));
+
+    auto family = req.value("family", std::string("channel"));
+    auto window = req.value("window", 60LL);
+    if (window <= 0)
+        return send_http_resp(http, evt, 400, resp("Invalid window"));
+
+    std::vector<std::string> names;
+    if (req.contains("names")) {
+        const auto &list = req["names"];
+        if (!list.is_array())
+            return send_http_resp(http, evt, 400, resp("Invalid names type"));
+        for (const auto &name: list) {
+            if (name.is_string())
+                names.push_back(name.get<std::string>());
+        }
+    }
+
+    collectChannelMetrics();
+    collectLatency();
+
+    auto now = CurrentTime<std::chrono::system_clock>::seconds();
+    long long covered = 0;
+    auto counter = [&covered] (unsigned long long count) {
+        return json{{"count", count},
+                    {"rate", covered > 0 ? static_cast<double>(count) / static_cast<double>(covered) : 0.0}};
+    };
+
+    // selected names missing in windows are reported as idle
+    auto forEach = [&names] (auto &windows, auto &&dump) {
+        if (names.empty()) {
+            for (auto &[name, series]: windows)
+                dump(name, &series);
+            return;
+        }
+        for (const auto &name: names) {
+            auto it = windows.find(name);
+            dump(name, it != windows.end() ? &it->second : nullptr);
+        }
+    };
+
+    json body = json::object();
+    body["family"] = family;
+    body["window"] = window;
+    if (family == "channel") {
+        auto &channels = body["channels"] = json::array();
+        forEach(channelWindows, [&] (const std::string &name, const auto *series) {
+            auto stats = series ? series->sum(now, window, &covered) : ChannelWindowStats{};
+            // idle channels are skipped in full dump, there may be thousands of them
+            if (names.empty() && stats.in == 0 && stats.out == 0)
+                return;
+            channels.push_back({{"name", name}, {"in", counter(stats.in)}, {"out", counter(stats.out)}});
+        });
+    } else if (family == "account") {
+        auto &accounts = body["accounts"] = json::array();
+        forEach(accountWindows, [&] (const std::string &name, const auto *series) {
+            auto stats = series ? series->sum(now, window, &covered) : AccountWindowStats{};
+            auto rtt = rttWindows.find(name);
+            accounts.push_back({{"name", name},
+                                {"in", {{"bytes", counter(stats.inBytes)}, {"lines", counter(stats.inLines)}}},
+                                {"out", {{"bytes", counter(stats.outBytes)}, {"lines", counter(stats.outLines)}}},
+                                {"rtt", histogramToJson(rtt != rttWindows.end() ? rtt->second.sum(now, window) : Histogram{})}});
+        });
+    } else if (family == "storage") {
+        auto stats = storageWindow.sum(now, window, &covered);
+        body["storage"] = {{"inserts", counter(stats.inserts)},
+                           {"rows", counter(stats.rows)},
+                           {"failed", counter(stats.failed)}};
+    } else if (family == "latency") {
+        body["unit"] = "us";
+        auto &stages = body["stages"] = json::object();
+        for (size_t i = 0; i < LatencyTracker::STAGES; ++i) {
+            auto stage = static_cast<LatencyTracker::Stage>(i);
+            stages[LatencyTracker::toString(stage)] = histogramToJson(latencyWindows[i].sum(now, window, &covered));
+        }
+    } else {
+        return send_http_resp(http, evt, 400, resp("Unknown family"));
+    }
+    // windows longer than a minute are rounded to minutes
+    body["covered"] = covered;
+
+    send_http_resp(http, evt, 200, body.dump());
+}
+
+void StatsCollector::evtHttpTopStats(so_5::mhood_t<hreq::stats::top> evt) {
+    // {"family": "channel|chatter", "window": seconds, "limit": count}
+    json req = evt->req.body().empty() ? json::object() : json::parse(evt->req.body(), nullptr, false, true);
+    if (req.is_discarded() || !req.is_object())
+        return send_http_resp(http, evt, 400, resp("Failed to parse JSON"));
+
+    auto family = req.value("family", std::string("channel"));
+    auto window = req.value("window", 60LL);
+    auto limit = req.value("limit", 50LL);
+    if (window <= 0)
+        return send_http_resp(http, evt, 400, resp("Invalid window"));
+    if (limit <= 0 || limit > static_cast<long long>(HeavyHitters::CAPACITY))
+        return send_http_resp(http, evt, 400, resp("Invalid limit"));
+
+    const TimeWindow<HeavyHitters, 0, 60> *series = nullptr;
+    if (family == "channel")
+        series = &topChannelsWindow;
+    else if (family == "chatter")
+        series = &topChattersWindow;
+    else
+        return send_http_resp(http, evt, 400, resp("Unknown family"));
+
+    collectSketches();
+
+    auto now = CurrentTime<std::chrono::system_clock>::seconds();
+    long long covered = 0;
+    auto hitters = series->sum(now, window, &covered);
+    auto rate = [covered] (unsigned long long count) {
+        return covered > 0 ? static_cast<double>(count) / static_cast<double>(covered) : 0.0;
+    };
+
+    json body = json::object();
+    body["family"] = family;
+    body["window"] = window;
+    body["covered"] = covered;
+    body["total"] = hitters.counts.total();
+    auto &top = body["top"] = json::array();
+    // count is an upper bound, count - error is a lower bound
+    for (auto &item: hitters.list(static_cast<size_t>(limit))) {
+        top.push_back({{"name", item.key},
+                       {"count", item.count},
+                       {"error", item.error},
+                       {"rate", rate(item.count)}});
+    }
+
+    send_http_resp(http, evt, 200, body.dump());
+}
+
+void StatsCollector::evtHttpChattersStats(so_5::mhood_t<hreq::stats::chatters> evt) {
+    // {"channels": [names], "window": seconds, "limit": count}, without channels the busiest ones are reported
+    json req = evt->req.body().empty() ? json::object() : json::parse(evt->req.body(), nullptr, false, true);
+    if (req.is_discarded() || !req.is_object())
+        return send_http_resp(http, evt, 400, resp("Failed to parse JSON"));
+
+    auto window = req.value("window", 3600LL);
+    auto limit = req.value("limit", 50LL);
+    if (window <= 0)
+        return send_http_resp(http, evt, 400, resp("Invalid window"));
+    if (limit <= 0 || limit > static_cast<long long>(HeavyHitters::CAPACITY))
+        return send_http_resp(http, evt, 400, resp("Invalid limit"));
+    window = std::min(window, 3600LL);
+
+    std::vector<std::string> names;
+    if (req.contains("channels")) {
+        const auto &list = req["channels"];
+        if (!list.is_array())
+            return send_http_resp(http, evt, 400, resp("Invalid channels type"));
+        for (const auto &name: list) {
+            if (name.is_string())
+                names.push_back(name.get<std::string>());
+        }
+    }
+
+    collectSketches();
+
+    auto now = CurrentTime<std::chrono::system_clock>::seconds();
+    if (names.empty()) {
+        for (auto &item: topChannelsWindow.sum(now, window).list(static_cast<size_t>(limit)))
+            names.push_back(std::move(item.key));
+    }
+
+    // per channel rings have 10 minute slots, window is rounded up to them
+    long long to = now / CHATTERS_SLOT;
+    long long from = to - (window - 1) / CHATTERS_SLOT;
+    json body = json::object();
+    body["window"] = window;
+    body["covered"] = (to - from) * CHATTERS_SLOT + now % CHATTERS_SLOT + 1;
+    body["unique"] = chattersWindow.sum(now, window).estimate();
+    auto &channels = body["channels"] = json::array();
+    for (const auto &name: names) {
+        auto it = channelChatters.find(name);
+        auto unique = it != channelChatters.end() ? it->second.sum(from, to).estimate() : 0;
+        channels.push_back({{"name", name}, {"unique", unique}});
+    }
+
+    send_http_resp(http, evt, 200, body.dump());
+}
+
+void StatsCollector::evtHttpTraceStats(so_5::mhood_t<hreq::stats::trace> evt) {
+    // {"format": "chrome" | "perfetto"}, spans are kept, repeated request returns them again with newer ones
+    json req = evt->req.body().empty() ? json::object() : json::parse(evt->req.body(), nullptr, false, true);
+    if (req.is_discarded() || !req.is_object())
+        return send_http_resp(http, evt, 400, resp("Failed to parse JSON"));
+
+    auto format = req.value("format", std::string{"chrome"});
+    if (format != "chrome" && format != "perfetto")
+        return send_http_resp(http, evt, 400, resp("Invalid format"));
+
+    auto dump = latency->trace().collect();
+    std::string body;
+    if (format == "perfetto") {
+        TraceBuffer::writePerfetto(dump, body);
+        return so_5::send<hreq::resp>(http, std::move(evt->req), std::move(evt->send), 200, std::move(body),
+                                      "application/x-protobuf");
+    }
+    TraceBuffer::writeChromeJson(dump, body);
+    so_5::send<hreq::resp>(http, std::move(evt->req), std::move(evt->send), 200, std::move(body),
+                           "application/json");
+}
+
+void StatsCollector::evtHttpMetrics(so_5::mhood_t<hreq::stats::metrics> evt) {
+    collectChannelMetrics();
+    collectLatency();
+    collectSketches();
+
+    metricsBuffer.clear();
+    renderMetrics();
+    so_5::send<hreq::resp>(http, std::move(evt->req), std::move(evt->send), 200, metricsBuffer,
+                           "text/plain; version=0.0.4; charset=utf-8");
+}
+
+void StatsCollector::renderMetrics() {
+    // histograms are recorded in ms or us, le bounds are powers of two of that unit
+    static constexpr double MS = 1e-3;
+    static constexpr double US = 1e-6;
+
+    MetricsWriter out(metricsBuffer);
+
+    // IRC accounts
+    out.family("chatcontroller_irc_connects_total", "counter", "IRC connection attempts by result");
+    for (auto &[nick, stats]: totals.accounts) {
+        out.sample("chatcontroller_irc_connects_total", {{"account", nick}, {"result", "success"}}, stats.connects.success);
+        out.sample("chatcontroller_irc_connects_total", {{"account", nick}, {"result", "failed"}}, stats.connects.failed);
+        out.sample("chatcontroller_irc_connects_total", {{"account", nick}, {"result", "loggedin"}}, stats.connects.loggedin);
+    }
+    out.family("chatcontroller_irc_received_bytes_total", "counter", "Inbound IRC bytes");
+    for (auto &[nick, stats]: totals.accounts)
+        out.sample("chatcontroller_irc_received_bytes_total", {{"account", nick}}, stats.commands.in.bytes);
+    out.family("chatcontroller_irc_received_lines_total", "counter", "Inbound IRC lines");
+    for (auto &[nick, stats]: totals.accounts)
+        out.sample("chatcontroller_irc_received_lines_total", {{"account", nick}}, stats.commands.in.count);
+    out.family("chatcontroller_irc_sent_bytes_total", "counter", "Outbound IRC bytes");
+    for (auto &[nick, stats]: totals.accounts)
+        out.sample("chatcontroller_irc_sent_bytes_total", {{"account", nick}}, stats.commands.out.bytes);
+    out.family("chatcontroller_irc_sent_lines_total", "counter", "Outbound IRC lines");
+    for (auto &[nick, stats]: totals.accounts)
+        out.sample("chatcontroller_irc_sent_lines_total", {{"account", nick}}, stats.commands.out.count);
+    out.family("chatcontroller_irc_sent_commands_total", "counter", "Outbound IRC commands, JOIN counts channels");
+    for (auto &[nick, stats]: totals.accounts) {
+        out.sample("chatcontroller_irc_sent_commands_total", {{"account", nick}, {"command", "JOIN"}}, stats.commands.out.join);
+        out.sample("chatcontroller_irc_sent_commands_total", {{"account", nick}, {"command", "PART"}}, stats.commands.out.part);
+        out.sample("chatcontroller_irc_sent_commands_total", {{"account", nick}, {"command", "PRIVMSG"}}, stats.commands.out.privmsg);
+    }
+    out.family("chatcontroller_irc_rtt_seconds", "histogram", "PING/PONG round trip");
+    for (auto &[nick, stats]: totals.accounts)
+        out.histogram("chatcontroller_irc_rtt_seconds", {{"account", nick}}, stats.commands.ping_pong.histogram, 16, MS);
+
+    // IRC joins
+    out.family("chatcontroller_irc_join_channels_total", "counter", "Channels sent in JOIN lines");
+    for (auto &[nick, stats]: totals.joins)
+        out.sample("chatcontroller_irc_join_channels_total", {{"account", nick}}, stats.channels);
+    out.family("chatcontroller_irc_join_lines_total", "counter", "JOIN lines sent");
+    for (auto &[nick, stats]: totals.joins)
+        out.sample("chatcontroller_irc_join_lines_total", {{"account", nick}}, stats.lines);
+    out.family("chatcontroller_irc_join_backlog", "gauge", "Channels waiting for JOIN rate limit");
+    for (auto &[nick, stats]: totals.joins)
+        out.sample("chatcontroller_irc_join_backlog", {{"account", nick}}, stats.backlog);
+    out.family("chatcontroller_irc_join_inflight", "gauge", "Channels joined without server confirmation");
+    for (auto &[nick, stats]: totals.joins)
+        out.sample("chatcontroller_irc_join_inflight", {{"account", nick}}, stats.inflight);
+    out.family("chatcontroller_irc_join_wait_seconds", "histogram", "Time channel waited for JOIN rate limit");
+    for (auto &[nick, stats]: totals.joins)
+        out.histogram("chatcontroller_irc_join_wait_seconds", {{"account", nick}}, stats.wait, 20, MS);
+    out.family("chatcontroller_irc_join_latency_seconds", "histogram", "Time from JOIN queue to server confirmation");
+    for (auto &[nick, stats]: totals.joins)
+        out.histogram("chatcontroller_irc_join_latency_seconds", {{"account", nick}}, stats.latency, 20, MS);
+
+    // IRC selectors
+    out.family("chatcontroller_irc_selector_sessions", "gauge", "Sessions served by selector thread");
+    for (auto &stats: totals.selectors)
+        out.sample("chatcontroller_irc_selector_sessions", {{"selector", stats.id}}, stats.sessions);
+    out.family("chatcontroller_irc_selector_utilisation", "gauge", "Busy share of selector thread wall time");
+    for (auto &stats: totals.selectors)
+        out.sample("chatcontroller_irc_selector_utilisation", {{"selector", stats.id}}, stats.utilisation);
+    out.family("chatcontroller_irc_selector_received_bytes_rate", "gauge", "Inbound bytes per second of selector sessions");
+    for (auto &stats: totals.selectors)
+        out.sample("chatcontroller_irc_selector_received_bytes_rate", {{"selector", stats.id}}, stats.bytesRate);
+    out.family("chatcontroller_irc_selector_rounds_total", "counter", "Select rounds");
+    for (auto &stats: totals.selectors)
+        out.sample("chatcontroller_irc_selector_rounds_total", {{"selector", stats.id}}, stats.rounds);
+    out.family("chatcontroller_irc_selector_busy_seconds_total", "counter", "Time spent outside select()");
+    for (auto &stats: totals.selectors)
+        out.sample("chatcontroller_irc_selector_busy_seconds_total", {{"selector", stats.id}}, static_cast<double>(stats.busy) * US);
+    out.family("chatcontroller_irc_selector_loop_seconds", "histogram", "Time of one select round outside select()");
+    for (auto &stats: totals.selectors)
+        out.histogram("chatcontroller_irc_selector_loop_seconds", {{"selector", stats.id}}, stats.loop, 24, US);
+    out.family("chatcontroller_irc_selector_lag_seconds", "histogram", "Delay of session ticks after their deadline");
+    for (auto &stats: totals.selectors)
+        out.histogram("chatcontroller_irc_selector_lag_seconds", {{"selector", stats.id}}, stats.lag, 16, MS);
+
+    // IRC connect admission
+    out.family("chatcontroller_irc_admission_storm", "gauge", "1 while reconnect storm is detected");
+    out.sample("chatcontroller_irc_admission_storm", {}, admissionStats.storm ? 1u : 0u);
+    out.family("chatcontroller_irc_admission_queued", "gauge", "Connects waiting for admission");
+    out.sample("chatcontroller_irc_admission_queued", {}, admissionStats.queued);
+    out.family("chatcontroller_irc_admission_inflight", "gauge", "Admitted connects not finished yet");
+    out.sample("chatcontroller_irc_admission_inflight", {}, admissionStats.inflight);
+    out.family("chatcontroller_irc_admission_granted_total", "counter", "Admitted connects");
+    out.sample("chatcontroller_irc_admission_granted_total", {}, totals.admission.granted);
+    out.family("chatcontroller_irc_admission_disconnects_total", "counter", "Disconnects reported to admission");
+    out.sample("chatcontroller_irc_admission_disconnects_total", {}, totals.admission.disconnects);
+    out.family("chatcontroller_irc_admission_storms_total", "counter", "Detected reconnect storms");
+    out.sample("chatcontroller_irc_admission_storms_total", {}, totals.admission.storms);
+
+    // message pipeline
+    out.family("chatcontroller_messages_received_total", "counter", "Chat messages processed");
+    out.sample("chatcontroller_messages_received_total", {}, totals.messagesIn);
+    out.family("chatcontroller_chatters_unique", "gauge", "Unique chatters of all channels during the last hour, estimate");
+    out.sample("chatcontroller_chatters_unique", {},
+               chattersWindow.sum(CurrentTime<std::chrono::system_clock>::seconds(), 3600).estimate());
+    out.family("chatcontroller_messages_sent_total", "counter", "Chat messages sent by bots");
+    out.sample("chatcontroller_messages_sent_total", {}, totals.messagesOut);
+    out.family("chatcontroller_pipeline_latency_seconds", "histogram", "Time from socket read to pipeline stage");
+    for (size_t i = 0; i < LatencyTracker::STAGES; ++i) {
+        auto stage = static_cast<LatencyTracker::Stage>(i);
+        out.histogram("chatcontroller_pipeline_latency_seconds", {{"stage", LatencyTracker::toString(stage)}},
+                      totals.latency[i], 26, US);
+    }
+    out.family("chatcontroller_so5_queue_size", "gauge", "Demands waiting in so_5 dispatcher queue");
+    for (auto &[prefix, stats]: dispStats)
+        out.sample("chatcontroller_so5_queue_size", {{"dispatcher", prefix.c_str()}}, stats.size);
+    out.family("chatcontroller_so5_thread_busy_seconds_total", "counter", "Time so_5 work threads spent in handlers");
+    for (auto &[id, stats]: threadStats) {
+        auto busy = std::chrono::duration<double>(stats.activity.m_working_stats.m_total_time).count();
+        out.sample("chatcontroller_so5_thread_busy_seconds_total",
+                   {{"dispatcher", stats.dispatcher}, {"thread", std::hash<so_5::current_thread_id_t>{}(id)}}, busy);
+    }
+    if (handlerTracker) {
+        auto entries = handlerTracker->collect(false);
+        out.family("chatcontroller_so5_handler_calls_total", "counter", "so_5 event handler calls");
+        for (auto &entry: entries)
+            out.sample("chatcontroller_so5_handler_calls_total", {{"agent", entry.agent}, {"event", entry.event}}, entry.count);
+        out.family("chatcontroller_so5_handler_exec_seconds_total", "counter", "so_5 event handler execution time");
+        for (auto &entry: entries)
+            out.sample("chatcontroller_so5_handler_exec_seconds_total", {{"agent", entry.agent}, {"event", entry.event}},
+                       static_cast<double>(entry.execTotal) * US);
+        out.family("chatcontroller_so5_handler_wait_seconds_total", "counter", "so_5 event queue wait before handler");
+        for (auto &entry: entries)
+            out.sample("chatcontroller_so5_handler_wait_seconds_total", {{"agent", entry.agent}, {"event", entry.event}},
+                       static_cast<double>(entry.waitTotal) * US);
+    }
+
+    // message processor
+    out.family("chatcontroller_lang_messages_total", "counter", "Messages passed to language detection by outcome");
+    out.sample("chatcontroller_lang_messages_total", {{"result", "detected"}}, totals.lang.detected);
+    out.sample("chatcontroller_lang_messages_total", {{"result", "cached"}}, totals.lang.cached);
+    out.sample("chatcontroller_lang_messages_total", {{"result", "short"}}, totals.lang.shortText);
+    out.family("chatcontroller_lang_detect_seconds_total", "counter", "Time spent in language detector");
+    out.sample("chatcontroller_lang_detect_seconds_total", {}, static_cast<double>(totals.lang.detectTime) * US);
+    out.family("chatcontroller_duplicates_checked_total", "counter", "Messages checked for duplicates");
+    out.sample("chatcontroller_duplicates_checked_total", {}, totals.dup.checked);
+    out.family("chatcontroller_duplicates_total", "counter", "Duplicated messages");
+    out.sample("chatcontroller_duplicates_total", {{"match", "exact"}}, totals.dup.exact);
+    out.sample("chatcontroller_duplicates_total", {{"match", "similar"}}, totals.dup.duplicates - totals.dup.exact);
+
+    // storage
+    out.family("chatcontroller_storage_inserts_total", "counter", "ClickHouse inserts");
+    for (size_t i = 0; i < totals.chPool.size(); ++i)
+        out.sample("chatcontroller_storage_inserts_total", {{"connection", i}}, totals.chPool[i].count);
+    out.family("chatcontroller_storage_rows_total", "counter", "ClickHouse inserted rows");
+    for (size_t i = 0; i < totals.chPool.size(); ++i)
+        out.sample("chatcontroller_storage_rows_total", {{"connection", i}}, totals.chPool[i].rows);
+    out.family("chatcontroller_storage_failed_total", "counter", "ClickHouse failed inserts");
+    for (size_t i = 0; i < totals.chPool.size(); ++i)
+        out.sample("chatcontroller_storage_failed_total", {{"connection", i}}, totals.chPool[i].failed);
+    out.family("chatcontroller_storage_rtt_seconds", "gauge", "Duration of the last ClickHouse insert");
+    for (size_t i = 0; i < totals.chPool.size(); ++i)
+        out.sample("chatcontroller_storage_rtt_seconds", {{"connection", i}}, static_cast<double>(totals.chPool[i].rtt) * MS);
+
+    // postgres pool, its counters are monotonic atomics
+    const auto &pgConnections = db->getPGPool()->connections();
+    out.family("chatcontroller_pg_connects_total", "counter", "PostgreSQL connect attempts");
+    for (size_t i = 0; i < pgConnections.size(); ++i)
+        out.sample("chatcontroller_pg_connects_total", {{"connection", i}},
+                   pgConnections[i]->getStats().connects.attempts.load(std::memory_order_relaxed));
+    out.family("chatcontroller_pg_requests_total", "counter", "PostgreSQL requests");
+    for (size_t i = 0; i < pgConnections.size(); ++i)
+        out.sample("chatcontroller_pg_requests_total", {{"connection", i}},
+                   pgConnections[i]->getStats().requests.count.load(std::memory_order_relaxed));
+    out.family("chatcontroller_pg_failed_total", "counter", "PostgreSQL failed requests");
+    for (size_t i = 0; i < pgConnections.size(); ++i)
+        out.sample("chatcontroller_pg_failed_total", {{"connection", i}},
+                   pgConnections[i]->getStats().requests.failed.load(std::memory_order_relaxed));
+    out.family("chatcontroller_pg_rtt_seconds", "gauge", "Duration of the last PostgreSQL request");
+    for (size_t i = 0; i < pgConnections.size(); ++i)
+        out.sample("chatcontroller_pg_rtt_seconds", {{"connection", i}},
+                   pgConnections[i]->getStats().requests.rtt.load(std::memory_order_relaxed) * MS);
+
+    // bots
+    out.family("chatcontroller_bots", "gauge", "Running bots");
+    out.sample("chatcontroller_bots", {}, botStats.size());
+    out.family("chatcontroller_bot_handlers", "gauge", "Message handlers of bot");
+    for (auto &[id, stats]: botStats)
+        out.sample("chatcontroller_bot_handlers", {{"bot", id}}, stats.handlers);
+    out.family("chatcontroller_bot_lua_used_bytes", "gauge", "Memory requested by bot lua state");
+    for (auto &[id, stats]: botStats)
+        out.sample("chatcontroller_bot_lua_used_bytes", {{"bot", id}}, stats.lua.used);
+    out.family("chatcontroller_bot_lua_reserved_bytes", "gauge", "Memory reserved for bot lua state");
+    for (auto &[id, stats]: botStats)
+        out.sample("chatcontroller_bot_lua_reserved_bytes", {{"bot", id}}, stats.lua.reserved);
+    out.family("chatcontroller_bot_lua_failed_total", "counter", "Lua allocations declined by memory limit");
+    for (auto &[id, stats]: botStats)
+        out.sample("chatcontroller_bot_lua_failed_total", {{"bot", id}}, stats.lua.failed);
+}
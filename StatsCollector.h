@@ -8,15 +8,23 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 #include <so_5/agent.hpp>
 #include <so_5/stats/messages.hpp>
 #include <so_5/stats/prefix.hpp>
+#include <so_5/timers.hpp>
 
 #include "HttpControllerEvents.h"
 #include "ChatMessage.h"
 #include "Storage.h"
+#include "MessageProcessor.h"
+#include "bot/BotEvents.h"
 #include "irc/IRCStatistic.h"
+#include "irc/IRCConnectAdmission.h"
+#include "LatencyTracker.h"
+#include "ChatSketches.h"
+#include "TimeWindow.h"
 
 
 struct ChannelStats {
@@ -29,22 +37,75 @@ struct ChannelStats {
     long long updated = 0;
 };
 
+// per-minute counters kept in time windows, merged with timeWindowMerge
+struct ChannelWindowStats {
+    unsigned int in = 0;
+    unsigned int out = 0;
+
+    void merge(const ChannelWindowStats &rhs) {
+        in += rhs.in;
+        out += rhs.out;
+    }
+};
+
+struct AccountWindowStats {
+    unsigned long long inBytes = 0;
+    unsigned long long inLines = 0;
+    unsigned long long outBytes = 0;
+    unsigned long long outLines = 0;
+
+    void merge(const AccountWindowStats &rhs) {
+        inBytes += rhs.inBytes;
+        inLines += rhs.inLines;
+        outBytes += rhs.outBytes;
+        outLines += rhs.outLines;
+    }
+};
+
+struct StorageWindowStats {
+    unsigned long long inserts = 0;
+    unsigned long long rows = 0;
+    unsigned long long failed = 0;
+
+    void merge(const StorageWindowStats &rhs) {
+        inserts += rhs.inserts;
+        rows += rhs.rows;
+        failed += rhs.failed;
+    }
+};
+
 struct So5DispatcherStats {
     size_t size = 0;
 };
 
+struct So5ThreadStats {
+    std::string dispatcher;
+    so_5::stats::work_thread_activity_stats_t activity;
+};
+
 class Logger;
 class DBController;
+class MetricsRegistry;
+class So5HandlerTracker;
 class StatsCollector final : public so_5::agent_t
 {
+  public:
+    struct CollectMetrics final : public so_5::signal_t {};
+
   public:
     StatsCollector(const context_t &ctx,
-                  so_5::mbox_t publisher,
                   so_5::mbox_t http,
                   std::shared_ptr<Logger> logger,
-                  std::shared_ptr<DBController> db);
+                  std::shared_ptr<DBController> db,
+                  std::shared_ptr<LatencyTracker> latency,
+                  std::shared_ptr<MetricsRegistry> channelMetrics,
+                  std::shared_ptr<ChatSketches> sketches,
+                  std::shared_ptr<So5HandlerTracker> handlerTracker);
     ~StatsCollector() override;
 
+    /// Enables rollup of per channel messages and unique chatters sent to storage every period seconds
+    void setRollup(so_5::mbox_t storage, unsigned int period);
+
     // so_5::agent_t implementation
     void so_define_agent() override;
     void so_evt_start() override;
@@ -52,11 +113,17 @@ class StatsCollector final : public so_5::agent_t
 
     // event handlers
     void evtQuantity(const so_5::stats::messages::quantity<std::size_t> &evt);
+    void evtWorkThreadActivity(const so_5::stats::messages::work_thread_activity &evt);
     void evtIRCMetrics(so_5::mhood_t<Irc::SessionMetrics> evt);
     void evtIRCClientChannelsMetrics(so_5::mhood_t<Irc::ClientChannelsMetrics> evt);
-    void evtRecvMessageMetric(so_5::mhood_t<Chat::Message> evt);
+    void evtIRCClientJoinMetrics(so_5::mhood_t<Irc::ClientJoinMetrics> evt);
+    void evtIRCSelectorsMetrics(so_5::mhood_t<Irc::SelectorsMetrics> evt);
+    void evtIRCAdmissionMetrics(so_5::mhood_t<IRCConnectAdmission::Metrics> evt);
+    void evtCollectMetrics(so_5::mhood_t<CollectMetrics> evt);
     void evtSendMessageMetric(so_5::mhood_t<Chat::SendMessage> evt);
     void evtCHPoolMetric(so_5::mhood_t<Storage::CHPoolMetrics> evt);
+    void evtBotMetrics(so_5::mhood_t<Bot::Metrics> evt);
+    void evtProcessorMetrics(so_5::mhood_t<MessageProcessor::Metrics> evt);
 
     // event http
     void evtHttpSo5Disp(so_5::mhood_t<hreq::stats::so5disp> evt);
@@ -66,19 +133,91 @@ class StatsCollector final : public so_5::agent_t
     void evtHttpIrcStats(so_5::mhood_t<hreq::stats::irc> evt);
     void evtHttpAccountsStats(so_5::mhood_t<hreq::stats::account> evt);
     void evtHttpChannelsStats(so_5::mhood_t<hreq::stats::channel> evt);
+    void evtHttpLatencyStats(so_5::mhood_t<hreq::stats::latency> evt);
+    void evtHttpProcessorStats(so_5::mhood_t<hreq::stats::processor> evt);
+    void evtHttpMetrics(so_5::mhood_t<hreq::stats::metrics> evt);
+    void evtHttpWindowStats(so_5::mhood_t<hreq::stats::window> evt);
+    void evtHttpTopStats(so_5::mhood_t<hreq::stats::top> evt);
+    void evtHttpChattersStats(so_5::mhood_t<hreq::stats::chatters> evt);
+    void evtHttpTraceStats(so_5::mhood_t<hreq::stats::trace> evt);
   private:
-    so_5::mbox_t publisher;
+    /// Merges inbound per channel counters bumped by MessageProcessor threads
+    void collectChannelMetrics();
+    /// Moves pipeline latency samples to window of /stats/latency and to totals
+    void collectLatency();
+    /// Merges chat sketches filled by MessageProcessor threads to windows and rollup
+    void collectSketches();
+    /// Sends accumulated rollup rows to storage
+    void flushRollup(long long now);
+    /// Renders totals and gauges in prometheus text format to metricsBuffer
+    void renderMetrics();
+    /// Drops windows of channels and accounts without updates during the whole horizon
+    void evictIdleWindows();
+
     so_5::mbox_t http;
 
     const std::shared_ptr<Logger> logger;
     const std::shared_ptr<DBController> db;
+    const std::shared_ptr<LatencyTracker> latency;
+    const std::shared_ptr<MetricsRegistry> channelMetrics;
+    const std::shared_ptr<ChatSketches> sketches;
+    const std::shared_ptr<So5HandlerTracker> handlerTracker; // null unless so5_handler_tracking is on
+    std::vector<std::string> channelNames; // channelMetrics counter id -> channel
+    so_5::timer_id_t collectMetricsTimer;
 
     IRCStatistic allIrcStats;
-    std::map<std::string, Irc::ChannelsToSessionId> ircClientChannels;
+    std::map<std::string, std::map<std::string, unsigned int>> ircClientChannels; // nick -> channel -> session id
+    std::map<std::string, IRCJoinStatistic> ircJoinStats;
+    std::vector<IRCSelectorStatistic> ircSelectorStats;
+    IRCConnectAdmission::Metrics admissionStats;
     std::map<std::string, std::vector<IRCStatistic>> ircStats;
     std::map<std::string, ChannelStats> channelsStats;
     std::vector<CHConnection::CHStatistics> chPoolStats;
+    std::map<int, BotStatistic> botStats;
+    LanguageDetector::Stats langStats;
+    DuplicateDetector::Stats dupStats;
     std::map<so_5::stats::prefix_t, So5DispatcherStats> dispStats;
+    std::map<so_5::current_thread_id_t, So5ThreadStats> threadStats; // work thread activity, totals since start
+    LatencyTracker::Snapshot latencyStats;
+
+    // monotonic totals for /metrics, JSON endpoints reset their own copies on read
+    struct {
+        std::map<std::string, IRCStatistic> accounts;
+        std::map<std::string, IRCJoinStatistic> joins;
+        std::vector<IRCSelectorStatistic> selectors;
+        IRCConnectAdmission::Metrics admission;
+        std::vector<CHConnection::CHStatistics> chPool;
+        LatencyTracker::Snapshot latency;
+        LanguageDetector::Stats lang;
+        DuplicateDetector::Stats dup;
+        unsigned long long messagesIn = 0;
+        unsigned long long messagesOut = 0;
+    } totals;
+    std::string metricsBuffer; // kept between scrapes to reuse capacity
+
+    // time windows for /stats/window, never reset by reads. Channels keep minutes only, ~0.5KB per channel
+    std::unordered_map<std::string, TimeWindow<ChannelWindowStats, 0, 60>> channelWindows;
+    std::map<std::string, TimeWindow<AccountWindowStats, 60, 60>> accountWindows;
+    std::map<std::string, TimeWindow<Histogram, 0, 60>> rttWindows; // per account, milliseconds
+    TimeWindow<StorageWindowStats, 60, 60> storageWindow;
+    std::array<TimeWindow<Histogram, 0, 60>, LatencyTracker::STAGES> latencyWindows; // microseconds
+    long long lastEviction = 0;
+
+    // sketches for /stats/top and /stats/chatters, memory doesn't depend on number of users
+    static constexpr long long CHATTERS_SLOT = 600; // seconds
+    TimeWindow<HeavyHitters, 0, 60> topChannelsWindow;
+    TimeWindow<HeavyHitters, 0, 60> topChattersWindow;
+    TimeWindow<HyperLogLog, 0, 60> chattersWindow; // unique users of all channels
+    std::unordered_map<std::string, TimeRing<HyperLogLog, 7>> channelChatters; // last hour by 10 minutes
+
+    struct RollupRow {
+        unsigned long long messages = 0;
+        HyperLogLog chatters;
+    };
+    so_5::mbox_t rollupStorage;
+    unsigned int rollupPeriod = 0; // seconds, 0 is disabled
+    long long lastRollup = 0;
+    std::unordered_map<std::string, RollupRow> rollup;
 };
 
 #endif //CHATCONTROLLER__STATSCOLLECTOR_H_
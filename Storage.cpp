@@ -12,6 +12,7 @@
 
 #include "db/DBConnectionLock.h"
 #include "db/ch/CHConnectionPool.h"
+#include "LatencyTracker.h"
 #include "Storage.h"
 
 #define FLUSH_TIMER(time) std::chrono::seconds{time}, std::chrono::seconds{time}
@@ -26,14 +27,20 @@ Storage::Storage(const context_t &ctx,
                  int batchSize,
                  unsigned int messagesFlushDelay,
                  unsigned int botLogFlushDelay,
+                 bool storeEmotes,
+                 bool storeDuplicates,
+                 std::shared_ptr<LatencyTracker> latency,
                  std::shared_ptr<Logger> logger)
   : so_5::agent_t(ctx),
     publisher(std::move(publisher)),
     statsCollector(std::move(statsCollector)),
+    latency(std::move(latency)),
     logger(std::move(logger)),
     batchSize(batchSize),
     messagesFlushDelay(messagesFlushDelay),
-    botLogFlushDelay(botLogFlushDelay) {
+    botLogFlushDelay(botLogFlushDelay),
+    storeEmotes(storeEmotes),
+    storeDuplicates(storeDuplicates) {
     msgBatch.reserve(batchSize);
     logBatch.reserve(batchSize);
 
@@ -53,6 +60,7 @@ void Storage::so_define_agent() {
     so_subscribe_self().event(&Storage::evtFlushChatMessages, so_5::thread_safe);
     so_subscribe_self().event(&Storage::evtFlushAll, so_5::thread_safe);
     so_subscribe_self().event(&Storage::evtGatherStats, so_5::thread_safe);
+    so_subscribe_self().event(&Storage::evtChannelRollup, so_5::thread_safe);
 }
 
 void Storage::so_evt_start() {
@@ -130,6 +138,7 @@ void Storage::process(const MessageBatch& messages) {
     if (messages.empty())
         return;
 
+    const long long begin = LatencyTracker::now();
     using namespace clickhouse;
     auto ids = std::make_shared<ColumnUUID>();
     auto channels = std::make_shared<ColumnFixedString>(256);
@@ -138,13 +147,25 @@ void Storage::process(const MessageBatch& messages) {
     //auto tags = std::make_shared<ColumnString>();
     auto timestamps = std::make_shared<ColumnDateTime64>(3);
     auto languages = std::make_shared<ColumnFixedString>(16);
+    auto emotes = std::make_shared<ColumnArray>(std::make_shared<ColumnString>());
+    auto duplicates = std::make_shared<ColumnUUID>();
     for (const auto & message : messages) {
         ids->Append(message->uuid.first);
         channels->Append(message->channel);
         users->Append(message->user);
+        // text is kept for duplicates too, original row can be lost with failed batch
         texts->Append(message->text);
         timestamps->Append(message->timestamp);
         languages->Append(message->lang);
+        if (storeDuplicates)
+            duplicates->Append(message->dupOf);
+
+        if (storeEmotes) {
+            auto emoteIds = std::make_shared<ColumnString>();
+            for (const auto &id: message->emotes)
+                emoteIds->Append(id);
+            emotes->AppendAsColumn(emoteIds);
+        }
     }
 
     Block block;
@@ -154,9 +175,21 @@ void Storage::process(const MessageBatch& messages) {
     block.AppendColumn("text", texts);
     block.AppendColumn("timestamp", timestamps);
     block.AppendColumn("language", languages);
+    if (storeEmotes)
+        block.AppendColumn("emotes", emotes);
+    if (storeDuplicates)
+        block.AppendColumn("dup_of", duplicates);
     try {
         DBConnectionLock chl(ch);
-        chl->insert("twitch_chat.messages", block);
+        if (chl->insert("twitch_chat.messages", block)) {
+            auto now = LatencyTracker::now();
+            for (const auto & message : messages) {
+                latency->record(LatencyTracker::Stage::Stored, message->readTime, now);
+                // block is shared, every traced message gets the whole insert with batch size as arg
+                latency->trace().span(message->traceId, "storage.insert", begin, now,
+                                      static_cast<long long>(messages.size()));
+            }
+        }
         ch->getLogger()->logInfo("Clickhouse insert {} messages", messages.size());
     } catch (const clickhouse::ServerException& err) {
         ch->getLogger()->logError("Clickhouse {}", err.what());
@@ -199,6 +232,39 @@ void Storage::process(const Storage::BotLogBatch &batch) {
     }
 }
 
+void Storage::evtChannelRollup(so_5::mhood_t<ChannelRollup> evt) {
+    if (evt->rows.empty())
+        return;
+
+    using namespace clickhouse;
+    auto timestamps = std::make_shared<ColumnDateTime>();
+    auto periods = std::make_shared<ColumnUInt32>();
+    auto channels = std::make_shared<ColumnFixedString>(256);
+    auto messages = std::make_shared<ColumnUInt64>();
+    auto chatters = std::make_shared<ColumnUInt64>();
+    for (const auto &row: evt->rows) {
+        timestamps->Append(static_cast<std::time_t>(evt->timestamp));
+        periods->Append(evt->period);
+        channels->Append(row.channel);
+        messages->Append(row.messages);
+        chatters->Append(row.chatters);
+    }
+
+    Block block;
+    block.AppendColumn("timestamp", timestamps);
+    block.AppendColumn("period", periods);
+    block.AppendColumn("channel", channels);
+    block.AppendColumn("messages", messages);
+    block.AppendColumn("chatters", chatters);
+    try {
+        DBConnectionLock chl(ch);
+        chl->insert("twitch_chat.channel_rollup", block);
+        ch->getLogger()->logInfo("Clickhouse insert {} channel rollup rows", evt->rows.size());
+    } catch (const clickhouse::ServerException& err) {
+        ch->getLogger()->logError("Clickhouse {}", err.what());
+    }
+}
+
 void Storage::store(ChatMessageHolder &&msg) {
     std::unique_lock ul(msgBatchMutex);
     if (msgBatch.size() < batchSize) {
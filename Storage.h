@@ -18,6 +18,7 @@
 #include "ChatMessage.h"
 
 class CHConnectionPool;
+class LatencyTracker;
 class Storage final : public so_5::agent_t
 {
   public:
@@ -31,6 +32,16 @@ class Storage final : public so_5::agent_t
     struct FlushBotLogMessages final : public so_5::signal_t {};
     struct GatherStats final : public so_5::signal_t {};
     struct CHPoolMetrics { std::vector<CHConnection::CHStatistics> stats; };
+    struct ChannelRollup {
+        struct Row {
+            std::string channel;
+            unsigned long long messages = 0;
+            unsigned long long chatters = 0; // HyperLogLog estimate
+        };
+        long long timestamp = 0; // period start, seconds
+        unsigned int period = 0; // seconds
+        std::vector<Row> rows;
+    };
   public:
     explicit Storage(const context_t &ctx,
                      so_5::mbox_t publisher,
@@ -40,6 +51,9 @@ class Storage final : public so_5::agent_t
                      int batchSize,
                      unsigned int messagesFlushDelay,
                      unsigned int botLogFlushDelay,
+                     bool storeEmotes,
+                     bool storeDuplicates,
+                     std::shared_ptr<LatencyTracker> latency,
                      std::shared_ptr<Logger> logger);
     ~Storage() override;
 
@@ -55,6 +69,7 @@ class Storage final : public so_5::agent_t
     void evtFlushChatMessages(so_5::mhood_t<FlushChatMessages> flush);
     void evtFlushAll(so_5::mhood_t<Flush> flush);
     void evtGatherStats(so_5::mhood_t<GatherStats> evt);
+    void evtChannelRollup(so_5::mhood_t<ChannelRollup> evt);
   private:
     void store(BotLogHolder &&msg);
     void store(ChatMessageHolder &&msg);
@@ -66,6 +81,7 @@ class Storage final : public so_5::agent_t
     so_5::mbox_t publisher;
     so_5::mbox_t statsCollector;
 
+    const std::shared_ptr<LatencyTracker> latency;
     const std::shared_ptr<Logger> logger;
     std::shared_ptr<CHConnectionPool> ch;
 
@@ -82,6 +98,10 @@ class Storage final : public so_5::agent_t
     unsigned int batchSize = 1000;
     unsigned int messagesFlushDelay = 10;
     unsigned int botLogFlushDelay = 10;
+    // optional columns of twitch_chat.messages, written only when feature is enabled,
+    // so schema without them keeps working
+    bool storeEmotes = false;
+    bool storeDuplicates = false;
 };
 
 #endif //CHATSNIFFER__STORAGE_H_
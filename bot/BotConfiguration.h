@@ -5,17 +5,26 @@
 #ifndef CHATSNIFFER_BOT_BOTCONFIGURATION_H_
 #define CHATSNIFFER_BOT_BOTCONFIGURATION_H_
 
+#include <algorithm>
 #include <cassert>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "../ChatMessage.h"
 
+inline void hashCombine(size_t &seed, size_t value) {
+    seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
 class EventHandlerConfiguration {
   public:
     EventHandlerConfiguration(int id, int typeId, std::string &&text, std::string &&additional)
       : id(id), typeId(typeId), text(std::move(text)), additional(std::move(additional)) {
-
+        hashCombine(hash, std::hash<int>{}(this->typeId));
+        hashCombine(hash, std::hash<std::string_view>{}(this->text));
+        hashCombine(hash, std::hash<std::string_view>{}(this->additional));
     }
     ~EventHandlerConfiguration() = default;
 
@@ -23,12 +32,20 @@ class EventHandlerConfiguration {
     [[nodiscard]] int getTypeId() const { return typeId; }
     [[nodiscard]] const std::string& getText() const { return text; }
     [[nodiscard]] const std::string& getAdditional() const { return additional; }
+    /// Hash of handler content(type, text and additional), id is not included
+    [[nodiscard]] size_t getHash() const { return hash; }
+
+    /// Same content, hash is compared first to skip string comparison of different handlers
+    [[nodiscard]] bool sameContent(const EventHandlerConfiguration &other) const {
+        return hash == other.hash && typeId == other.typeId && text == other.text && additional == other.additional;
+    }
 
   protected:
     int id = 0;
     int typeId = 0;
     std::string text;
     std::string additional;
+    size_t hash = 0;
 };
 
 struct BotConfiguration {
@@ -38,6 +55,16 @@ struct BotConfiguration {
     std::string channel;
 
     std::vector<EventHandlerConfiguration> handlers;
+
+    bool operator==(const BotConfiguration &other) const {
+        if (botId != other.botId || userId != other.userId || account != other.account || channel != other.channel)
+            return false;
+        return std::equal(handlers.begin(), handlers.end(), other.handlers.begin(), other.handlers.end(),
+                          [] (const EventHandlerConfiguration &lhs, const EventHandlerConfiguration &rhs) {
+            return lhs.getId() == rhs.getId() && lhs.sameContent(rhs);
+        });
+    }
+    bool operator!=(const BotConfiguration &other) const { return !(*this == other); }
 };
 
 #endif //CHATSNIFFER_BOT_BOTCONFIGURATION_H_
@@ -3,11 +3,14 @@
 //
 
 #include <so_5/send_functions.hpp>
+#include <sol/sol.hpp>
 
+#include "Clock.h"
 #include "Logger.h"
 #include "ThreadName.h"
 
 #include "../irc/IRCController.h"
+#include "../LatencyTracker.h"
 
 #include "events/BotMessageEvent.h"
 #include "handlers/BotEventHandler.h"
@@ -16,10 +19,15 @@
 
 #include "BotEngine.h"
 
+static constexpr int gatherStatsDelay = 5;
+
 BotEngine::BotEngine(const context_t &ctx, so_5::mbox_t self, so_5::mbox_t msgSender, so_5::mbox_t botLogger,
-                     BotConfiguration config, std::shared_ptr<Logger> logger)
+                     so_5::mbox_t statsCollector, BotConfiguration config, size_t luaMemoryLimit,
+                     std::shared_ptr<KVStorage> kv, std::shared_ptr<LatencyTracker> latency,
+                     std::shared_ptr<Logger> logger)
   : so_5::agent_t(ctx), self(std::move(self)), msgSender(std::move(msgSender)), botLogger(std::move(botLogger)),
-    logger(std::move(logger)), config(std::move(config)) {
+    statsCollector(std::move(statsCollector)), kv(std::move(kv)), latency(std::move(latency)), logger(std::move(logger)),
+    config(std::move(config)), luaAllocator(luaMemoryLimit) {
 
     loadHandlers();
 
@@ -32,40 +40,94 @@ BotEngine::~BotEngine() {
 };
 
 void BotEngine::loadHandlers() {
-    auto emplaceHandler = [this](const EventHandlerConfiguration &cfg) {
+    auto makeHandler = [this](const EventHandlerConfiguration &cfg) -> BotMessageEventHandler * {
         auto type = static_cast<BotEventHandler::HandlerType>(cfg.getTypeId());
         switch (type) {
             case BotEventHandler::HandlerType::Lua:
-                massageHandlers.emplace_back(new BotMessageEventHandlerLua(this, cfg.getId(), cfg.getText(), cfg.getAdditional()));
-                break;
+                return new BotMessageEventHandlerLua(this, cfg.getId(), cfg.getText(), cfg.getAdditional());
             case BotEventHandler::HandlerType::Command:
-                massageHandlers.emplace_back(new BotMessageEventHandlerCommand(this, cfg.getId(), cfg.getText(), cfg.getAdditional()));
-                break;
+                return new BotMessageEventHandlerCommand(this, cfg.getId(), cfg.getText(), cfg.getAdditional());
             case BotEventHandler::HandlerType::Unknown:
             default:
-                break;
+                return nullptr;
         }
     };
 
-    massageHandlers.clear();
-    for(const auto & handlerConfig : this->config.handlers) {
-        emplaceHandler(handlerConfig);
+    // unchanged handlers are moved as is, so lua environment and compiled routes are kept
+    std::unordered_map<int, std::unique_ptr<BotMessageEventHandler>> previous;
+    for (auto &handler: massageHandlers)
+        previous.emplace(handler->getId(), std::move(handler));
+
+    std::vector<std::unique_ptr<BotMessageEventHandler>> handlers;
+    std::unordered_map<int, EventHandlerConfiguration> configs;
+    handlers.reserve(config.handlers.size());
+    size_t kept = 0, built = 0;
+    for (const auto &cfg: config.handlers) {
+        auto it = previous.find(cfg.getId());
+        auto cfgIt = handlerConfigs.find(cfg.getId());
+        if (it != previous.end() && cfgIt != handlerConfigs.end() && cfgIt->second.sameContent(cfg)) {
+            handlers.push_back(std::move(it->second));
+            previous.erase(it);
+            ++kept;
+        } else if (auto *handler = makeHandler(cfg)) {
+            handlers.emplace_back(handler);
+            ++built;
+        } else {
+            continue;
+        }
+        configs.insert_or_assign(cfg.getId(), cfg);
     }
+
+    massageHandlers = std::move(handlers);
+    handlerConfigs = std::move(configs);
+
+    size_t dropped = previous.size();
+    previous.clear();
+    if (lua && dropped > 0)
+        lua->collect_garbage();
+
+    logger->logTrace("BotEngine bot(id={}) handlers loaded: {} kept, {} built, {} dropped",
+                     config.botId, kept, built, dropped);
+}
+
+sol::state &BotEngine::getLuaState() {
+    if (lua)
+        return *lua;
+
+    lua = std::make_unique<sol::state>(sol::default_at_panic, &LuaAllocator::alloc, &luaAllocator);
+    lua->open_libraries(sol::lib::base, sol::lib::string, sol::lib::utf8, sol::lib::math);
+
+    auto message_type = lua->new_usertype<Chat::Message>("message");
+    message_type.set("user", sol::readonly(&Chat::Message::user));
+    message_type.set("channel", sol::readonly(&Chat::Message::channel));
+    message_type.set("text", sol::readonly(&Chat::Message::text));
+    message_type.set("lang", sol::readonly(&Chat::Message::lang));
+    message_type.set("timestamp", sol::readonly(&Chat::Message::timestamp));
+    message_type.set("valid", sol::readonly(&Chat::Message::valid));
+    message_type.set("duplicate", sol::readonly(&Chat::Message::duplicate));
+    return *lua;
 }
 
 void BotEngine::so_define_agent() {
     so_subscribe(self).event(&BotEngine::evtBotMessage);
     so_subscribe_self().event(&BotEngine::evtShutdown);
     so_subscribe_self().event(&BotEngine::evtReload);
+    so_subscribe_self().event(&BotEngine::evtGatherStats);
 }
 
 void BotEngine::so_evt_start() {
     set_thread_name("bot_engine");
 
+    gatherStatsTimer = so_5::send_periodic<Bot::GatherStats>(*this, std::chrono::seconds{gatherStatsDelay},
+                                                             std::chrono::seconds{gatherStatsDelay});
+
     this->logger->logInfo("BotEngine bot(id={}) started", this->config.botId);
 }
 
 void BotEngine::so_evt_finish() {
+    gatherStatsTimer.release();
+    so_5::send<Bot::Metrics>(statsCollector, collectStats(), true);
+
     this->logger->logInfo("BotEngine bot(id={}) stoped", this->config.botId);
 }
 
@@ -74,12 +136,30 @@ void BotEngine::evtShutdown(so_5::mhood_t<Bot::Shutdown>) {
 }
 
 void BotEngine::evtReload(so_5::mhood_t<Bot::Reload> message) {
+    if (message->config == this->config)
+        return;
+
     this->logger->logInfo("BotEngine bot(id={}) config update", this->config.botId);
     this->config = std::move(message->config);
 
     loadHandlers();
 }
 
+void BotEngine::evtGatherStats(mhood_t<Bot::GatherStats>) {
+    so_5::send<Bot::Metrics>(statsCollector, collectStats(), false);
+}
+
+BotStatistic BotEngine::collectStats() const {
+    BotStatistic stats;
+    stats.botId = config.botId;
+    stats.userId = config.userId;
+    stats.channel = config.channel;
+    stats.handlers = massageHandlers.size();
+    stats.lua = luaAllocator.getStats();
+    stats.updated = CurrentTime<std::chrono::system_clock>::milliseconds();
+    return stats;
+}
+
 const BotConfiguration &BotEngine::getConfig() const {
     return config;
 }
@@ -96,12 +176,24 @@ const so_5::mbox_t &BotEngine::getBotLogger() const {
     return botLogger;
 }
 
+const std::shared_ptr<KVStorage> &BotEngine::getKVStorage() const {
+    return kv;
+}
+
 void BotEngine::evtBotMessage(so_5::mhood_t<BotMessageEvent> evt) {
     // ignore self messages to avoid looping
     if (evt->getMessage()->user == config.account)
         return;
 
+    bool duplicate = evt->getMessage()->duplicate;
+    const uint64_t traceId = evt->getMessage()->traceId;
     for (auto& handler: massageHandlers) {
+        if (duplicate && handler->isSkipDuplicates())
+            continue;
+        const long long begin = traceId ? LatencyTracker::now() : 0;
         handler->handleBotMessage(*evt);
+        latency->trace().span(traceId, "bot.handler", begin, LatencyTracker::now(), config.botId);
     }
+
+    latency->record(LatencyTracker::Stage::Handled, evt->getMessage()->readTime);
 }
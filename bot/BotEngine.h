@@ -6,15 +6,22 @@
 #define CHATSNIFFER_BOT_BOTENGINE_H_
 
 #include <atomic>
+#include <unordered_map>
 #include <vector>
 
 #include <so_5/agent.hpp>
+#include <so_5/timers.hpp>
 
+#include "lua/LuaAllocator.h"
 #include "BotConfiguration.h"
 #include "BotEvents.h"
 
+namespace sol { class state; }
+
 class Logger;
 class IRCController;
+class LatencyTracker;
+class KVStorage;
 
 class BotMessageEvent;
 class BotMessageEventHandler;
@@ -26,7 +33,11 @@ class BotEngine final : public so_5::agent_t
               so_5::mbox_t self,
               so_5::mbox_t msgSender,
               so_5::mbox_t botLogger,
+              so_5::mbox_t statsCollector,
               BotConfiguration config,
+              size_t luaMemoryLimit,
+              std::shared_ptr<KVStorage> kv,
+              std::shared_ptr<LatencyTracker> latency,
               std::shared_ptr<Logger> logger);
     ~BotEngine() override;
 
@@ -38,25 +49,39 @@ class BotEngine final : public so_5::agent_t
     const std::shared_ptr<Logger>& getLogger() const;
     const so_5::mbox_t& getMsgSender() const;
     const so_5::mbox_t& getBotLogger() const;
+    const std::shared_ptr<KVStorage>& getKVStorage() const;
+
+    /// Lua state shared by all lua handlers of bot, created on first use
+    sol::state& getLuaState();
 
     // control event handlers
     void evtShutdown(mhood_t<Bot::Shutdown> message);
     void evtReload(mhood_t<Bot::Reload> message);
+    void evtGatherStats(mhood_t<Bot::GatherStats> evt);
 
     // bot event handlers
     void evtBotMessage(so_5::mhood_t<BotMessageEvent> evt);
   private:
     void loadHandlers();
+    [[nodiscard]] BotStatistic collectStats() const;
 
     so_5::mbox_t self;
     so_5::mbox_t msgSender;
     so_5::mbox_t botLogger;
+    so_5::mbox_t statsCollector;
+    so_5::timer_id_t gatherStatsTimer;
 
+    const std::shared_ptr<KVStorage> kv;
+    const std::shared_ptr<LatencyTracker> latency;
     const std::shared_ptr<Logger> logger;
 
     BotConfiguration config;
 
+    // declaration order matters: handlers release lua references before state, state is freed before allocator
+    LuaAllocator luaAllocator;
+    std::unique_ptr<sol::state> lua;
     std::vector<std::unique_ptr<BotMessageEventHandler>> massageHandlers;
+    std::unordered_map<int, EventHandlerConfiguration> handlerConfigs; // handler id to config it was built from
 };
 
 #endif //CHATSNIFFER_BOT_BOTENGINE_H_
@@ -7,6 +7,7 @@
 
 #include <string>
 #include "BotConfiguration.h"
+#include "BotStatistic.h"
 #include "../common/Utils.h"
 
 namespace Bot {
@@ -17,6 +18,13 @@ struct Reload {
     mutable BotConfiguration config;
 };
 
+struct GatherStats final : public so_5::signal_t {};
+
+struct Metrics {
+    BotStatistic stats;
+    bool removed = false; // bot is stopped, drop its stats
+};
+
 struct LogMessage {
     int userId = 0;
     int botId = 0;
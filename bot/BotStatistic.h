@@ -0,0 +1,43 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_BOT_BOTSTATISTIC_H_
+#define CHATCONTROLLER_BOT_BOTSTATISTIC_H_
+
+#include <string>
+
+#include "nlohmann/json.hpp"
+
+#include "lua/LuaAllocator.h"
+
+using json = nlohmann::json;
+
+struct BotStatistic
+{
+    int botId = 0;
+    int userId = 0;
+    std::string channel;
+    size_t handlers = 0;
+    LuaAllocator::Stats lua;
+    long long updated = 0;
+};
+
+inline json botStatisticToJson(const BotStatistic& stats) {
+    json res = json::object();
+    res["id"] = stats.botId;
+    res["user"] = stats.userId;
+    res["channel"] = stats.channel;
+    res["handlers"] = stats.handlers;
+    res["lua"] = {
+        {"used", stats.lua.used},
+        {"peak", stats.lua.peak},
+        {"reserved", stats.lua.reserved},
+        {"limit", stats.lua.limit},
+        {"failed", stats.lua.failed}
+    };
+    res["updated"] = stats.updated;
+    return res;
+}
+
+#endif //CHATCONTROLLER_BOT_BOTSTATISTIC_H_
@@ -14,6 +14,8 @@
 #include "ThreadName.h"
 
 #include "../DBController.h"
+#include "../db/kv/KVStorage.h"
+#include "../LatencyTracker.h"
 #include "events/BotMessageEvent.h"
 #include "BotsEnvironment.h"
 #include "BotEngine.h"
@@ -26,11 +28,17 @@ using json = nlohmann::json;
 BotsEnvironment::BotsEnvironment(const context_t &ctx,
                                  so_5::mbox_t publisher,
                                  so_5::mbox_t http,
+                                 so_5::mbox_t statsCollector,
                                  unsigned int threads,
+                                 size_t luaMemoryLimit,
+                                 unsigned int kvSnapshotPeriod,
+                                 std::shared_ptr<KVStorage> kv,
                                  std::shared_ptr<DBController> db,
+                                 std::shared_ptr<LatencyTracker> latency,
                                  std::shared_ptr<Logger> logger)
     : so_5::agent_t(ctx), publisher(std::move(publisher)), http(std::move(http)),
-      db(std::move(db)), logger(std::move(logger)), threads(threads) {
+      statsCollector(std::move(statsCollector)), kv(std::move(kv)), db(std::move(db)), latency(std::move(latency)),
+      logger(std::move(logger)), threads(threads), luaMemoryLimit(luaMemoryLimit), kvSnapshotPeriod(kvSnapshotPeriod) {
     ignoreUsers = this->db->loadServiceAccountsNicknames();
 }
 
@@ -48,6 +56,8 @@ void BotsEnvironment::setBotLogger(so_5::mbox_t blogger) {
 
 void BotsEnvironment::so_define_agent() {
     so_subscribe(publisher).event(&BotsEnvironment::evtChatMessage, so_5::thread_safe);
+    so_subscribe_self().event(&BotsEnvironment::evtKVFlush);
+    so_subscribe_self().event(&BotsEnvironment::evtKVSnapshot);
     so_subscribe(http).event(&BotsEnvironment::evtHttpAdd);
     so_subscribe(http).event(&BotsEnvironment::evtHttpReload);
     so_subscribe(http).event(&BotsEnvironment::evtHttpRemove);
@@ -60,6 +70,12 @@ void BotsEnvironment::so_evt_start() {
     botEnginePool = so_5::disp::adv_thread_pool::make_dispatcher(so_environment(), "bot_engine", threads);
     botEnginePoolParams = {};
 
+    if (!kv->open())
+        this->logger->logError("BotsEnvironment Failed to restore key value storage, state won't be persisted");
+    kvFlushTimer = so_5::send_periodic<KVFlush>(*this, std::chrono::seconds(1), std::chrono::seconds(1));
+    kvSnapshotTimer = so_5::send_periodic<KVSnapshot>(*this, std::chrono::seconds(kvSnapshotPeriod),
+                                                      std::chrono::seconds(kvSnapshotPeriod));
+
     auto configs = db->loadBotConfigurations();
     for (auto &[id, config]: configs)
         addBot(config);
@@ -67,7 +83,9 @@ void BotsEnvironment::so_evt_start() {
 }
 
 void BotsEnvironment::so_evt_finish() {
-
+    kvFlushTimer.release();
+    kvSnapshotTimer.release();
+    kv->snapshot();
 }
 
 void BotsEnvironment::addBot(const BotConfiguration &config) {
@@ -78,9 +96,11 @@ void BotsEnvironment::addBot(const BotConfiguration &config) {
 
     auto *bot = so_5::introduce_child_coop(*this, [&box = it->second, &config, this] (so_5::coop_t &coop) {
         return coop.make_agent_with_binder<BotEngine>(botEnginePool.binder(botEnginePoolParams),
-                                                      box, msgSender, botLogger, config, logger);
+                                                      box, msgSender, botLogger, statsCollector,
+                                                      config, luaMemoryLimit, kv, latency, logger);
     });
     botsById.emplace(config.botId, bot);
+    botConfigs.insert_or_assign(config.botId, config);
 }
 
 void BotsEnvironment::evtChatMessage(mhood_t<Chat::Message> msg) {
@@ -93,10 +113,21 @@ void BotsEnvironment::evtChatMessage(mhood_t<Chat::Message> msg) {
 
     auto it = botBoxes.find(msg->channel);
     if (it != botBoxes.end()) {
+        const long long begin = msg->traceId ? LatencyTracker::now() : 0;
         so_5::send<BotMessageEvent>(it->second, msg.make_holder());
+        latency->record(LatencyTracker::Stage::Dispatched, msg->readTime);
+        latency->trace().span(msg->traceId, "bots.dispatch", begin, LatencyTracker::now());
     }
 }
 
+void BotsEnvironment::evtKVFlush(mhood_t<KVFlush>) {
+    kv->flush();
+}
+
+void BotsEnvironment::evtKVSnapshot(mhood_t<KVSnapshot>) {
+    kv->snapshot();
+}
+
 void BotsEnvironment::evtHttpAdd(mhood_t<hreq::bot::add> evt) {
     logger->logTrace("BotsEnvironment Add new bot");
 
@@ -140,6 +171,7 @@ void BotsEnvironment::evtHttpRemove(mhood_t<hreq::bot::remove> evt) {
     // TODO add remove mbox
     so_5::send<Bot::Shutdown>(it->second->so_direct_mbox());
     botsById.erase(it);
+    botConfigs.erase(id);
     logger->logTrace("BotsEnvironment Remove bot(id={})", id);
 
     json body = {{"botId", id}, {"result", "Bot removed"}};
@@ -164,6 +196,7 @@ void BotsEnvironment::evtHttpReload(mhood_t<hreq::bot::reload> evt) {
     if (config.botId == 0)
         return send_http_resp(http, evt, 404, resp("Bot not found in DB"));
 
+    botConfigs.insert_or_assign(id, config);
     so_5::send<Bot::Reload>(it->second->so_direct_mbox(), std::move(config));
     logger->logTrace("BotsEnvironment Reload bot(id={})", id);
 
@@ -174,17 +207,26 @@ void BotsEnvironment::evtHttpReload(mhood_t<hreq::bot::reload> evt) {
 void BotsEnvironment::evtHttpReloadAll(mhood_t<hreq::bot::reloadall> evt) {
     // TODO handle unregistered bots
     auto configs = db->loadBotConfigurations();
+    size_t added = 0, reloaded = 0;
     for (auto &[id, config]: configs) {
         auto it = botsById.find(id);
         if (it == botsById.end()) {
             addBot(config);
+            ++added;
+            continue;
         }
-        else {
-            so_5::send<Bot::Reload>(it->second->so_direct_mbox(), std::move(config));
-        }
+
+        // bot diffs handlers itself, here only untouched bots are skipped
+        auto &sent = botConfigs[id];
+        if (sent == config)
+            continue;
+        sent = config;
+        so_5::send<Bot::Reload>(it->second->so_direct_mbox(), std::move(config));
+        ++reloaded;
     }
-    this->logger->logInfo("BotsEnvironment Configuration reloaded for {} bots", configs.size());
+    this->logger->logInfo("BotsEnvironment Configuration reloaded for {} bots: {} added, {} reloaded",
+                          configs.size(), added, reloaded);
 
-    json body = {{"result", "Reloaded"}};
+    json body = {{"result", "Reloaded"}, {"added", added}, {"reloaded", reloaded}};
     send_http_resp(http, evt, 200, body.dump());
 }
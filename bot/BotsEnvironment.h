@@ -11,6 +11,7 @@
 #include <unordered_set>
 
 #include <so_5/agent.hpp>
+#include <so_5/timers.hpp>
 #include <so_5/coop_handle.hpp>
 #include <so_5/disp/adv_thread_pool/pub.hpp>
 
@@ -20,15 +21,25 @@
 
 class Logger;
 class DBController;
+class LatencyTracker;
+class KVStorage;
 class BotEngine;
 class BotsEnvironment final : public so_5::agent_t
 {
+    struct KVFlush final : public so_5::signal_t {};
+    struct KVSnapshot final : public so_5::signal_t {};
+
   public:
     BotsEnvironment(const context_t &ctx,
                     so_5::mbox_t publisher,
                     so_5::mbox_t http,
+                    so_5::mbox_t statsCollector,
                     unsigned int threads,
+                    size_t luaMemoryLimit,
+                    unsigned int kvSnapshotPeriod,
+                    std::shared_ptr<KVStorage> kv,
                     std::shared_ptr<DBController> db,
+                    std::shared_ptr<LatencyTracker> latency,
                     std::shared_ptr<Logger> logger);
     ~BotsEnvironment() override;
 
@@ -42,6 +53,8 @@ class BotsEnvironment final : public so_5::agent_t
 
     // bot events
     void evtChatMessage(mhood_t<Chat::Message> msg);
+    void evtKVFlush(mhood_t<KVFlush> evt);
+    void evtKVSnapshot(mhood_t<KVSnapshot> evt);
     //void evtHttpRequest(mhood_t<hreq::api> evt);
     //void evtCustomGlobal(mhood_t<Bot::Event> evt);
 
@@ -57,17 +70,26 @@ class BotsEnvironment final : public so_5::agent_t
     so_5::mbox_t msgSender;
     so_5::mbox_t botLogger;
     so_5::mbox_t http;
+    so_5::mbox_t statsCollector;
 
     so_5::disp::adv_thread_pool::dispatcher_handle_t botEnginePool;
     so_5::disp::adv_thread_pool::bind_params_t botEnginePoolParams;
 
+    const std::shared_ptr<KVStorage> kv;
     const std::shared_ptr<DBController> db;
+    const std::shared_ptr<LatencyTracker> latency;
     const std::shared_ptr<Logger> logger;
 
     unsigned int threads;
+    size_t luaMemoryLimit;
+    unsigned int kvSnapshotPeriod;
+
+    so_5::timer_id_t kvFlushTimer;
+    so_5::timer_id_t kvSnapshotTimer;
 
     // BotEngine's owned by so_5::agent
     std::map<int, BotEngine *> botsById;
+    std::map<int, BotConfiguration> botConfigs; // last config sent to bot
     std::map<std::string, so_5::mbox_t> botBoxes;
     std::unordered_set<std::string> ignoreUsers;
 };
@@ -0,0 +1,92 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+#include "RegexMatcher.h"
+
+namespace {
+
+struct MatchData {
+    MatchData() : data(pcre2_match_data_create(1, nullptr)) {}
+    ~MatchData() { pcre2_match_data_free(data); }
+
+    pcre2_match_data *data;
+};
+
+}
+
+RegexMatcher::Ptr RegexMatcher::get(const std::string &pattern, uint32_t flags) {
+    static constexpr size_t MIN_SWEEP_SIZE = 64;
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::weak_ptr<const RegexMatcher>> cache;
+    static size_t sweepSize = MIN_SWEEP_SIZE;
+
+    std::string key;
+    key.reserve(sizeof(flags) + pattern.size());
+    key.append(reinterpret_cast<const char *>(&flags), sizeof(flags));
+    key.append(pattern);
+
+    {
+        std::lock_guard lg(mutex);
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            if (auto matcher = it->second.lock())
+                return matcher;
+        }
+    }
+
+    // compilation and JIT are slow, bots loaded by other threads must not wait for them
+    auto matcher = std::make_shared<const RegexMatcher>(pattern, flags);
+
+    std::lock_guard lg(mutex);
+    auto &cached = cache[key];
+    if (auto other = cached.lock())
+        return other; // compiled concurrently by another thread
+    cached = matcher;
+
+    // drop patterns unused by any handler once cache doubles, so sweeps are amortized
+    if (cache.size() >= sweepSize) {
+        for (auto it = cache.begin(); it != cache.end();) {
+            if (it->second.expired())
+                it = cache.erase(it);
+            else
+                ++it;
+        }
+        sweepSize = std::max(MIN_SWEEP_SIZE, cache.size() * 2);
+    }
+    return matcher;
+}
+
+RegexMatcher::RegexMatcher(const std::string &pattern, uint32_t flags) {
+    int errorCode = 0;
+    PCRE2_SIZE errorOffset = 0;
+    code = pcre2_compile(reinterpret_cast<PCRE2_SPTR>(pattern.data()), pattern.size(), flags,
+                         &errorCode, &errorOffset, nullptr);
+    if (!code) {
+        PCRE2_UCHAR buffer[256];
+        pcre2_get_error_message(errorCode, buffer, sizeof(buffer));
+        error = std::string(reinterpret_cast<const char *>(buffer)) + " at offset " + std::to_string(errorOffset);
+        return;
+    }
+
+    // interpreter is used if JIT is not supported on platform
+    pcre2_jit_compile(code, PCRE2_JIT_COMPLETE);
+}
+
+RegexMatcher::~RegexMatcher() {
+    pcre2_code_free(code);
+}
+
+bool RegexMatcher::match(std::string_view subject) const {
+    // one match data per thread, only the first pair of ovector is needed
+    thread_local MatchData matchData;
+
+    // pcre2_match uses JIT code when it is available
+    int rc = pcre2_match(code, reinterpret_cast<PCRE2_SPTR>(subject.data()), subject.size(), 0, 0,
+                         matchData.data, nullptr);
+    return rc >= 0;
+}
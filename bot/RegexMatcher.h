@@ -0,0 +1,43 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_BOT_REGEXMATCHER_H_
+#define CHATCONTROLLER_BOT_REGEXMATCHER_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+
+// PCRE2 JIT compiled pattern. Matchers are shared through process-wide cache
+// keyed by pattern and flags, so bots with identical routes use one compiled program.
+class RegexMatcher
+{
+  public:
+    using Ptr = std::shared_ptr<const RegexMatcher>;
+
+    /// Returns cached matcher, compiles pattern on first request
+    static Ptr get(const std::string &pattern, uint32_t flags = PCRE2_UTF);
+
+  public:
+    RegexMatcher(const std::string &pattern, uint32_t flags);
+    ~RegexMatcher();
+
+    RegexMatcher(const RegexMatcher&) = delete;
+    RegexMatcher& operator=(const RegexMatcher&) = delete;
+
+    /// Unanchored search, same as pcrecpp::RE::PartialMatch without captures
+    [[nodiscard]] bool match(std::string_view subject) const;
+
+    [[nodiscard]] bool valid() const { return code != nullptr; }
+    [[nodiscard]] const std::string &getError() const { return error; }
+
+  private:
+    pcre2_code *code = nullptr;
+    std::string error;
+};
+
+#endif //CHATCONTROLLER_BOT_REGEXMATCHER_H_
@@ -24,10 +24,13 @@ class BotEventHandler
     virtual ~BotEventHandler() = default;
 
     [[nodiscard]] int getId() const { return id; };
+    /// Near duplicate messages(copypasta, raid waves) are not passed to handler
+    [[nodiscard]] bool isSkipDuplicates() const { return skipDuplicates; }
 
   protected:
     int id = 0; // id from database
     bool valid = true;
+    bool skipDuplicates = false;
     BotEngine *bot = nullptr;
     HandlerType type = HandlerType::Unknown;
 };
@@ -33,6 +33,9 @@ BotMessageEventHandlerCommand::BotMessageEventHandlerCommand(BotEngine * bot, in
             auto &m = params["mention"];
             if (m.is_boolean())
                 mention = m.get<bool>();
+            auto &d = params["skip_duplicates"];
+            if (d.is_boolean())
+                skipDuplicates = d.get<bool>();
         }
 
         valid = !command.empty();
@@ -61,7 +64,9 @@ void BotMessageEventHandlerCommand::handleBotMessage(const BotMessageEvent &evt)
     so_5::send<Chat::SendMessage>(this->bot->getMsgSender(),
                                   this->bot->getConfig().account,
                                   this->bot->getConfig().channel,
-                                  sendText);
+                                  sendText,
+                                  message->readTime,
+                                  message->traceId);
 
     so_5::send<Bot::LogMessage>(this->bot->getBotLogger(),
                                 this->bot->getConfig().userId,
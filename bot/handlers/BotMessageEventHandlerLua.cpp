@@ -6,13 +6,26 @@
 #include <nlohmann/json.hpp>
 
 #include "Clock.h"
+#include "Logger.h"
 
 #include "BotMessageEventHandlerLua.h"
+#include "../../db/kv/KVStorage.h"
 #include "../BotEvents.h"
 #include "../BotEngine.h"
 
 using json = nlohmann::json;
 
+// converts any lua value to string same way as lua tostring()
+static std::string toString(const sol::object &value) {
+    lua_State *L = value.lua_state();
+    value.push();
+    size_t len = 0;
+    const char *str = luaL_tolstring(L, -1, &len);
+    std::string res(str, len);
+    lua_pop(L, 2);
+    return res;
+}
+
 int my_exception_handler(lua_State* L,
                          sol::optional<const std::exception&> maybe_exception,
                          sol::string_view description) {
@@ -44,41 +57,102 @@ int my_exception_handler(lua_State* L,
 }
 
 BotMessageEventHandlerLua::BotMessageEventHandlerLua(BotEngine *bot, int id, const string &script, const string &additional)
-  : BotMessageEventHandler(bot, id, HandlerType::Lua), script(script), text(""), user("") {
+  : BotMessageEventHandler(bot, id, HandlerType::Lua), script(script) {
     json add = json::parse(additional, nullptr, false, true);
     valid = !add.is_discarded();
 
+    auto makeMatcher = [this] (const json &pattern) -> RegexMatcher::Ptr {
+        if (!pattern.is_string() || pattern.get_ref<const std::string &>().empty())
+            return nullptr;
+
+        auto matcher = RegexMatcher::get(pattern.get<std::string>());
+        if (!matcher->valid()) {
+            valid = false;
+            this->bot->getLogger()->logError("BotMessageEventHandlerLua bot(id={}) handler(id={}) bad route \"{}\": {}",
+                                             this->bot->getConfig().botId, getId(),
+                                             pattern.get<std::string>(), matcher->getError());
+        }
+        return matcher;
+    };
+
     if (valid) {
-        pcrecpp::RE_Options options;
-        options.set_utf8(true);
         auto &route = add["route"];
         if (!route.is_null()) {
-            auto &t = route["text"];
-            if (t.is_string())
-                text = pcrecpp::RE(t.get<std::string>(), options);
-            auto &u = route["user"];
-            if (u.is_string())
-                user = pcrecpp::RE(u.get<std::string>(), options);
+            text = makeMatcher(route["text"]);
+            user = makeMatcher(route["user"]);
+        }
+        auto &params = add["params"];
+        if (!params.is_null()) {
+            auto &d = params["skip_duplicates"];
+            if (d.is_boolean())
+                skipDuplicates = d.get<bool>();
         }
     }
 
-    initLuaState(lua);
+    if (valid)
+        initEnvironment(bot->getLuaState());
 }
 
 BotMessageEventHandlerLua::~BotMessageEventHandlerLua() = default;
 
-void BotMessageEventHandlerLua::initLuaState(sol::state &lua) {
-    lua.open_libraries(sol::lib::base, sol::lib::string, sol::lib::utf8, sol::lib::math);
-
-    //lua.set_exception_handler(&my_exception_handler);
-
-    auto message_type = lua.new_usertype<Chat::Message>("message");
-    message_type.set("user", sol::readonly(&Chat::Message::user));
-    message_type.set("channel", sol::readonly(&Chat::Message::channel));
-    message_type.set("text", sol::readonly(&Chat::Message::text));
-    message_type.set("lang", sol::readonly(&Chat::Message::lang));
-    message_type.set("timestamp", sol::readonly(&Chat::Message::timestamp));
-    message_type.set("valid", sol::readonly(&Chat::Message::valid));
+void BotMessageEventHandlerLua::initEnvironment(sol::state &lua) {
+    env = sol::environment(lua, sol::create, lua.globals());
+
+    engine = lua.create_table();
+    engine.set_function("log", [this] (const std::string& text) {
+        if (!current)
+            return;
+        const auto &config = this->bot->getConfig();
+        so_5::send<Bot::LogMessage>(this->bot->getBotLogger(), config.userId, config.botId, this->getId(),
+                                    current->uuid.first, CurrentTime<std::chrono::system_clock>::milliseconds(), text);
+    });
+    engine.set_function("send", [this] (const std::string& text) {
+        if (!current)
+            return;
+        const auto &config = this->bot->getConfig();
+        so_5::send<Chat::SendMessage>(this->bot->getMsgSender(), config.account, config.channel, text,
+                                      current->readTime, current->traceId);
+    });
+
+    // bot key value storage, ttl is in seconds
+    auto kv = lua.create_table();
+    kv.set_function("get", [this] (const std::string &key) -> sol::optional<std::string> {
+        auto value = this->bot->getKVStorage()->get(this->bot->getConfig().botId, key);
+        if (!value)
+            return sol::nullopt;
+        return std::move(*value);
+    });
+    kv.set_function("set", [this] (const std::string &key, const sol::object &value, sol::optional<long long> ttl) {
+        this->bot->getKVStorage()->set(this->bot->getConfig().botId, key, toString(value), ttl.value_or(0) * 1000);
+    });
+    kv.set_function("incr", [this] (const std::string &key, sol::optional<long long> delta,
+                                    sol::optional<long long> ttl) -> sol::optional<long long> {
+        auto value = this->bot->getKVStorage()->incr(this->bot->getConfig().botId, key,
+                                                     delta.value_or(1), ttl.value_or(0) * 1000);
+        if (!value)
+            return sol::nullopt;
+        return *value;
+    });
+    kv.set_function("expire", [this] (const std::string &key, long long ttl) {
+        return this->bot->getKVStorage()->expire(this->bot->getConfig().botId, key, ttl * 1000);
+    });
+    kv.set_function("del", [this] (const std::string &key) {
+        return this->bot->getKVStorage()->remove(this->bot->getConfig().botId, key);
+    });
+    engine["kv"] = kv;
+    env["engine"] = engine;
+
+    // compile script once, every message only calls prepared chunk
+    sol::load_result chunk = lua.load(script, fmt::format("handler_{}", getId()));
+    if (!chunk.valid()) {
+        sol::error err = chunk;
+        valid = false;
+        bot->getLogger()->logError("BotMessageEventHandlerLua bot(id={}) handler(id={}) failed to load script: {}",
+                                   bot->getConfig().botId, getId(), err.what());
+        return;
+    }
+    handler = chunk.get<sol::protected_function>();
+    env.set_on(handler);
 }
 
 void BotMessageEventHandlerLua::handleBotMessage(const BotMessageEvent &evt) {
@@ -88,31 +162,24 @@ void BotMessageEventHandlerLua::handleBotMessage(const BotMessageEvent &evt) {
 
     const auto & config = bot->getConfig();
 
-    auto messageToLua = [this, &message] (sol::state& lua) -> bool {
-        auto engine = lua.create_named_table("engine");
+    std::string error;
+    try {
+        current = message.get();
         engine["message"] = *message;
+        sol::protected_function_result pfr = handler();
+        if (!pfr.valid()) {
+            sol::error err = pfr;
+            error = err.what();
+        }
+    } catch (const sol::error &err) {
+        // raised outside of protected call, e.g. on memory limit
+        error = err.what();
+    }
+    current = nullptr;
 
-        engine.set_function("log", [this, &lua, &message] (const std::string& text) {
-            so_5::send<Bot::LogMessage>(this->bot->getBotLogger(),
-                                        this->bot->getConfig().userId,
-                                        this->bot->getConfig().botId,
-                                        this->getId(), message->uuid.first,
-                                        CurrentTime<std::chrono::system_clock>::milliseconds(), text);
-        });
-        engine.set_function("send", [this,
-            &account = this->bot->getConfig().account,
-            &channel = this->bot->getConfig().channel] (const std::string& text) {
-            so_5::send<Chat::SendMessage>(this->bot->getMsgSender(), account, channel, text);
-        });
-        return true;
-    };
-
-    bool inited = messageToLua(lua);
-    sol::protected_function_result pfr = lua.safe_script(script, &sol::script_pass_on_error);
-    if (inited && !pfr.valid()) {
-        sol::error err = pfr;
+    if (!error.empty()) {
         so_5::send<Bot::LogMessage>(this->bot->getBotLogger(), config.userId, config.botId, getId(), message->uuid.first,
-                                    CurrentTime<std::chrono::system_clock>::milliseconds(), err.what());
+                                    CurrentTime<std::chrono::system_clock>::milliseconds(), std::move(error));
     }
 }
 
@@ -120,13 +187,10 @@ bool BotMessageEventHandlerLua::match(const Chat::Message &msg) const {
     if (!valid)
         return false;
 
-    if (!text.pattern().empty()) {
-        if (!text.error().empty() || !text.PartialMatch(msg.text))
-            return false;
-    }
-    if (!user.pattern().empty()) {
-        if (!user.error().empty() || !user.PartialMatch(msg.user))
-            return false;
-    }
+    // invalid patterns disable handler on load, so only presence is checked here
+    if (text && !text->match(msg.text))
+        return false;
+    if (user && !user->match(msg.user))
+        return false;
     return true;
 };
@@ -5,9 +5,9 @@
 #ifndef CHATCONTROLLER_BOT_EVENTS_BOTMESSAGEEVENTHANDLERLUA_H_
 #define CHATCONTROLLER_BOT_EVENTS_BOTMESSAGEEVENTHANDLERLUA_H_
 
-#include <pcrecpp.h>
 #include <sol/sol.hpp>
 
+#include "../RegexMatcher.h"
 #include "BotMessageEventHandler.h"
 
 class BotMessageEventHandlerLua : public BotMessageEventHandler
@@ -19,16 +19,22 @@ class BotMessageEventHandlerLua : public BotMessageEventHandler
     // BotMessageEventHandler implementation
     void handleBotMessage(const BotMessageEvent& evt) override;
   private:
-    void initLuaState(sol::state& lua);
+    void initEnvironment(sol::state& lua);
 
     [[nodiscard]] bool match(const Chat::Message& msg) const;
 
-    sol::state lua;
+    // handler globals are isolated in own environment on top of bot shared lua state
+    sol::environment env;
+    sol::table engine;
+    sol::protected_function handler;
+
+    // message processed right now, valid only inside handler call
+    const Chat::Message *current = nullptr;
 
     std::string script;
 
-    pcrecpp::RE text;
-    pcrecpp::RE user;
+    RegexMatcher::Ptr text;
+    RegexMatcher::Ptr user;
 };
 
 #endif //CHATCONTROLLER_BOT_EVENTS_BOTMESSAGEEVENTHANDLERLUA_H_
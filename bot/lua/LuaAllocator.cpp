@@ -0,0 +1,153 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "LuaAllocator.h"
+
+LuaAllocator::LuaAllocator(size_t limit) : limit(limit) {
+}
+
+LuaAllocator::~LuaAllocator() {
+    for (void *chunk: chunks)
+        std::free(chunk);
+}
+
+void *LuaAllocator::alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
+    auto *self = static_cast<LuaAllocator *>(ud);
+    // when ptr is NULL, osize encodes the kind of object lua allocates
+    return self->reallocate(ptr, ptr ? osize : 0, nsize);
+}
+
+void LuaAllocator::setLimit(size_t value) {
+    limit.store(value, std::memory_order_relaxed);
+}
+
+LuaAllocator::Stats LuaAllocator::getStats() const {
+    Stats stats;
+    stats.used = used.load(std::memory_order_relaxed);
+    stats.peak = peak.load(std::memory_order_relaxed);
+    stats.reserved = reserved.load(std::memory_order_relaxed);
+    stats.limit = limit.load(std::memory_order_relaxed);
+    stats.failed = failed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t LuaAllocator::sizeClass(size_t size) {
+    if (size <= (size_t{1} << MIN_CLASS_BITS))
+        return 0;
+    size_t bits = 64 - __builtin_clzll(size - 1);
+    return bits - MIN_CLASS_BITS;
+}
+
+size_t LuaAllocator::classSize(size_t sizeClass) {
+    return size_t{1} << (sizeClass + MIN_CLASS_BITS);
+}
+
+void *LuaAllocator::reallocate(void *ptr, size_t osize, size_t nsize) {
+    if (nsize == 0) {
+        if (ptr) {
+            deallocate(ptr, osize);
+            used.fetch_sub(osize, std::memory_order_relaxed);
+        }
+        return nullptr;
+    }
+
+    // lua assumes that shrinking never fails, so limit is checked only on grow
+    size_t current = used.load(std::memory_order_relaxed);
+    size_t max = limit.load(std::memory_order_relaxed);
+    if (nsize > osize && max > 0 && current - osize + nsize > max) {
+        failed.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    void *res = nullptr;
+    if (!ptr) {
+        res = allocate(nsize);
+    } else if (osize <= MAX_POOLED_SIZE && nsize <= MAX_POOLED_SIZE && sizeClass(osize) == sizeClass(nsize)) {
+        res = ptr; // same block fits
+    } else if (osize > MAX_POOLED_SIZE && nsize > MAX_POOLED_SIZE) {
+        res = std::realloc(ptr, nsize);
+        if (res) {
+            reserved.fetch_add(nsize, std::memory_order_relaxed);
+            reserved.fetch_sub(osize, std::memory_order_relaxed);
+        }
+    } else {
+        res = allocate(nsize);
+        if (res) {
+            std::memcpy(res, ptr, std::min(osize, nsize));
+            deallocate(ptr, osize);
+        }
+    }
+
+    if (!res)
+        return nullptr;
+
+    current = used.fetch_add(nsize, std::memory_order_relaxed) + nsize;
+    used.fetch_sub(osize, std::memory_order_relaxed);
+    current -= osize;
+    if (current > peak.load(std::memory_order_relaxed))
+        peak.store(current, std::memory_order_relaxed);
+    return res;
+}
+
+void *LuaAllocator::allocate(size_t size) {
+    if (size > MAX_POOLED_SIZE) {
+        void *res = std::malloc(size);
+        if (res)
+            reserved.fetch_add(size, std::memory_order_relaxed);
+        return res;
+    }
+    return allocatePooled(sizeClass(size));
+}
+
+void LuaAllocator::deallocate(void *ptr, size_t size) {
+    if (size > MAX_POOLED_SIZE) {
+        std::free(ptr);
+        reserved.fetch_sub(size, std::memory_order_relaxed);
+        return;
+    }
+
+    // keep block for reuse, chunks are released only with allocator
+    auto &head = freeLists[sizeClass(size)];
+    auto *block = static_cast<FreeBlock *>(ptr);
+    block->next = head;
+    head = block;
+}
+
+void *LuaAllocator::allocatePooled(size_t sizeClass) {
+    auto &head = freeLists[sizeClass];
+    if (head) {
+        FreeBlock *block = head;
+        head = block->next;
+        return block;
+    }
+
+    size_t blockSize = classSize(sizeClass);
+    if (chunkLeft < blockSize) {
+        // put chunk tail to the free lists to avoid waste
+        while (chunkLeft >= classSize(0)) {
+            size_t tailBits = std::min<size_t>(63 - __builtin_clzll(chunkLeft), MAX_CLASS_BITS);
+            size_t tailClass = tailBits - MIN_CLASS_BITS;
+            deallocate(chunkPos, classSize(tailClass));
+            chunkPos += classSize(tailClass);
+            chunkLeft -= classSize(tailClass);
+        }
+
+        void *chunk = std::malloc(CHUNK_SIZE);
+        if (!chunk)
+            return nullptr;
+        chunks.push_back(chunk);
+        reserved.fetch_add(CHUNK_SIZE, std::memory_order_relaxed);
+        chunkPos = static_cast<char *>(chunk);
+        chunkLeft = CHUNK_SIZE;
+    }
+
+    void *res = chunkPos;
+    chunkPos += blockSize;
+    chunkLeft -= blockSize;
+    return res;
+}
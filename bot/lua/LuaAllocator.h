@@ -0,0 +1,70 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_BOT_LUA_LUAALLOCATOR_H_
+#define CHATCONTROLLER_BOT_LUA_LUAALLOCATOR_H_
+
+#include <array>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+// lua_Alloc implementation with size-class pools and memory accounting.
+// Small blocks(<= 512 bytes) are carved from chunks and reused through free lists,
+// bigger ones go directly to malloc. Not thread safe, must be used by one lua_State owner,
+// counters are atomic to be read from other threads.
+class LuaAllocator
+{
+  public:
+    static constexpr size_t MIN_CLASS_BITS = 4;  // 16 bytes
+    static constexpr size_t MAX_CLASS_BITS = 9;  // 512 bytes
+    static constexpr size_t SIZE_CLASSES = MAX_CLASS_BITS - MIN_CLASS_BITS + 1;
+    static constexpr size_t MAX_POOLED_SIZE = size_t{1} << MAX_CLASS_BITS;
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+    struct Stats {
+        size_t used = 0;     // bytes requested by lua
+        size_t peak = 0;     // max of used
+        size_t reserved = 0; // bytes taken from system(chunks + big blocks)
+        size_t limit = 0;    // 0 is unlimited
+        size_t failed = 0;   // allocations declined by limit
+    };
+
+  public:
+    explicit LuaAllocator(size_t limit = 0);
+    ~LuaAllocator();
+
+    LuaAllocator(const LuaAllocator&) = delete;
+    LuaAllocator& operator=(const LuaAllocator&) = delete;
+
+    /// lua_Alloc compatible function, ud must be LuaAllocator*
+    static void *alloc(void *ud, void *ptr, size_t osize, size_t nsize);
+
+    void setLimit(size_t limit);
+    [[nodiscard]] Stats getStats() const;
+
+  private:
+    struct FreeBlock { FreeBlock *next; };
+
+    static size_t sizeClass(size_t size);
+    static size_t classSize(size_t sizeClass);
+
+    void *reallocate(void *ptr, size_t osize, size_t nsize);
+    void *allocate(size_t size);
+    void deallocate(void *ptr, size_t size);
+    void *allocatePooled(size_t sizeClass);
+
+    std::array<FreeBlock *, SIZE_CLASSES> freeLists{};
+    std::vector<void *> chunks;
+    char *chunkPos = nullptr;
+    size_t chunkLeft = 0;
+
+    std::atomic<size_t> used{0};
+    std::atomic<size_t> peak{0};
+    std::atomic<size_t> reserved{0};
+    std::atomic<size_t> limit{0};
+    std::atomic<size_t> failed{0};
+};
+
+#endif //CHATCONTROLLER_BOT_LUA_LUAALLOCATOR_H_
@@ -43,8 +43,8 @@ class CurrentTime
     static long long nanoseconds() {
         return ClockT::now().time_since_epoch() / ::nanoseconds(1);
     }
-    static std::string utcTime() { return CurrentTime::utc<&std::time>(); }
-    static std::string utcTimeWithMilli() { return CurrentTime::utcWithMilli<&std::time>(); }
+    static std::string utcTime() { return CurrentTime::utc<&std::gmtime>(); }
+    static std::string utcTimeWithMilli() { return CurrentTime::utcWithMilli<&std::gmtime>(); }
     static std::string utcLocalTime() { return CurrentTime::utc<&std::localtime>(); }
     static std::string utcLocalTimeWithMilli() { return CurrentTime::utcWithMilli<&std::localtime>(); }
     static std::string utcGMTime() { return CurrentTime::utc<&std::gmtime>(); }
@@ -0,0 +1,83 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_COMMON_COUNTMINSKETCH_H_
+#define CHATCONTROLLER_COMMON_COUNTMINSKETCH_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+/// 64-bit hash of key for sketches, std::hash is mixed again because sketches take bits from both ends
+inline uint64_t sketchHash(std::string_view key) {
+    uint64_t x = std::hash<std::string_view>{}(key);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Count-Min sketch, depth rows of width counters. Estimate never underestimates,
+// overestimate is below total * e / width with probability 1 - e^-depth.
+// Counters are allocated on first add, so empty sketches kept in time rings cost nothing.
+class CountMinSketch
+{
+  public:
+    CountMinSketch() : CountMinSketch(1024, 4) {}
+    explicit CountMinSketch(uint32_t width, uint32_t depth = 4) : depth(std::max<uint32_t>(depth, 1)) {
+        this->width = 1;
+        while (this->width < width)
+            this->width *= 2;
+    }
+
+    void add(uint64_t hash, uint64_t count = 1) {
+        if (counters.empty())
+            counters.assign(static_cast<size_t>(width) * depth, 0);
+        for (uint32_t row = 0; row < depth; ++row)
+            counters[cell(hash, row)] += count;
+        sum += count;
+    }
+
+    [[nodiscard]] uint64_t estimate(uint64_t hash) const {
+        if (counters.empty())
+            return 0;
+        uint64_t res = UINT64_MAX;
+        for (uint32_t row = 0; row < depth; ++row)
+            res = std::min(res, counters[cell(hash, row)]);
+        return res;
+    }
+
+    /// Sketches must have the same dimensions, otherwise other is ignored
+    void merge(const CountMinSketch &other) {
+        if (other.counters.empty() || other.width != width || other.depth != depth)
+            return;
+        if (counters.empty()) {
+            counters = other.counters;
+        } else {
+            for (size_t i = 0; i < counters.size(); ++i)
+                counters[i] += other.counters[i];
+        }
+        sum += other.sum;
+    }
+
+    /// Sum of all added counts
+    [[nodiscard]] uint64_t total() const { return sum; }
+    [[nodiscard]] bool empty() const { return sum == 0; }
+
+  private:
+    [[nodiscard]] size_t cell(uint64_t hash, uint32_t row) const {
+        // row hashes are derived from two halves of one hash(Kirsch-Mitzenmacher)
+        auto h1 = static_cast<uint32_t>(hash);
+        auto h2 = static_cast<uint32_t>(hash >> 32) | 1;
+        return static_cast<size_t>(row) * width + ((h1 + row * h2) & (width - 1));
+    }
+
+    uint32_t width;
+    uint32_t depth;
+    uint64_t sum = 0;
+    std::vector<uint64_t> counters;
+};
+
+#endif //CHATCONTROLLER_COMMON_COUNTMINSKETCH_H_
@@ -0,0 +1,99 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_COMMON_HISTOGRAM_H_
+#define CHATCONTROLLER_COMMON_HISTOGRAM_H_
+
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+/// Log-linear histogram (HDR-like) with ~6% precision over [0, 2^40) range.
+/// Values are split by power of two magnitude and 16 linear sub-buckets inside each magnitude.
+class Histogram
+{
+  public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_VALUE_BITS = 40;
+    static constexpr int BUCKETS = SUB_BUCKETS * (MAX_VALUE_BITS - SUB_BUCKET_BITS) + SUB_BUCKETS;
+    static constexpr uint64_t MAX_VALUE = (uint64_t{1} << MAX_VALUE_BITS) - 1;
+
+  public:
+    void record(uint64_t value, uint64_t times = 1) {
+        value = std::min(value, MAX_VALUE);
+        buckets[bucketIndex(value)] += times;
+        total += times;
+        sum += value * times;
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+    }
+
+    void merge(const Histogram& other) {
+        if (other.total == 0)
+            return;
+        for (int i = 0; i < BUCKETS; ++i)
+            buckets[i] += other.buckets[i];
+        total += other.total;
+        sum += other.sum;
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+    }
+
+    void clear() { *this = {}; }
+
+    /// Returns upper bound of bucket that contains requested percentile, p in [0, 100]
+    [[nodiscard]] uint64_t percentile(double p) const {
+        if (total == 0)
+            return 0;
+
+        auto rank = static_cast<uint64_t>(static_cast<double>(total) * std::clamp(p, 0.0, 100.0) / 100.0);
+        rank = std::clamp<uint64_t>(rank, 1, total);
+
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += buckets[i];
+            if (seen >= rank)
+                return std::clamp(bucketUpperBound(i), minValue, maxValue);
+        }
+        return maxValue;
+    }
+
+    [[nodiscard]] uint64_t count() const { return total; }
+    [[nodiscard]] uint64_t min() const { return total ? minValue : 0; }
+    [[nodiscard]] uint64_t max() const { return maxValue; }
+    [[nodiscard]] uint64_t mean() const { return total ? sum / total : 0; }
+    [[nodiscard]] uint64_t valueSum() const { return sum; }
+    [[nodiscard]] uint64_t bucketCount(int index) const { return buckets[index]; }
+
+    static int bucketIndex(uint64_t value) {
+        if (value < SUB_BUCKETS)
+            return static_cast<int>(value);
+        int magnitude = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+        return SUB_BUCKETS * magnitude + static_cast<int>(value >> magnitude);
+    }
+
+    static uint64_t bucketLowerBound(int index) {
+        if (index < SUB_BUCKETS)
+            return index;
+        int magnitude = index / SUB_BUCKETS - 1;
+        return static_cast<uint64_t>(index - SUB_BUCKETS * magnitude) << magnitude;
+    }
+
+    static uint64_t bucketUpperBound(int index) {
+        if (index < SUB_BUCKETS)
+            return index;
+        int magnitude = index / SUB_BUCKETS - 1;
+        return bucketLowerBound(index) + (uint64_t{1} << magnitude) - 1;
+    }
+
+  private:
+    std::array<uint64_t, BUCKETS> buckets{};
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t minValue = UINT64_MAX;
+    uint64_t maxValue = 0;
+};
+
+#endif //CHATCONTROLLER_COMMON_HISTOGRAM_H_
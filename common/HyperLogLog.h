@@ -0,0 +1,108 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_COMMON_HYPERLOGLOG_H_
+#define CHATCONTROLLER_COMMON_HYPERLOGLOG_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/// HyperLogLog distinct counter with 2^12 registers (~1.6% standard error).
+/// Small sets are kept sparse as list of (register, rank) pairs and switch to 4KB of dense registers
+/// when the list grows over SPARSE_LIMIT, so thousands of mostly quiet keys stay cheap.
+class HyperLogLog
+{
+  public:
+    static constexpr int PRECISION = 12;
+    static constexpr uint32_t REGISTERS = 1u << PRECISION;
+    static constexpr size_t SPARSE_LIMIT = 256;
+
+  public:
+    /// Adds 64-bit hash of item, hash must be well mixed
+    void add(uint64_t hash) {
+        auto index = static_cast<uint32_t>(hash >> (64 - PRECISION));
+        uint64_t rest = (hash << PRECISION) | (uint64_t{1} << (PRECISION - 1)); // guard bit limits rank
+        auto rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+        set(index, rank);
+    }
+
+    void merge(const HyperLogLog &other) {
+        if (other.dense.empty()) {
+            for (auto entry: other.sparse)
+                set(entry >> 8, entry & 0xFF);
+            return;
+        }
+        if (dense.empty())
+            toDense();
+        for (uint32_t i = 0; i < REGISTERS; ++i)
+            dense[i] = std::max(dense[i], other.dense[i]);
+    }
+
+    [[nodiscard]] uint64_t estimate() const {
+        if (dense.empty()) {
+            // linear counting is exact enough while most registers are empty
+            return linearCounting(REGISTERS - static_cast<uint32_t>(sparse.size()));
+        }
+
+        double sum = 0;
+        uint32_t zeros = 0;
+        for (auto value: dense) {
+            sum += std::ldexp(1.0, -value);
+            zeros += value == 0;
+        }
+        constexpr double m = REGISTERS;
+        constexpr double alpha = 0.7213 / (1.0 + 1.079 / m);
+        double raw = alpha * m * m / sum;
+        if (raw <= 2.5 * m && zeros > 0)
+            return linearCounting(zeros);
+        return static_cast<uint64_t>(raw + 0.5);
+    }
+
+    [[nodiscard]] bool empty() const { return sparse.empty() && dense.empty(); }
+    [[nodiscard]] bool isSparse() const { return dense.empty(); }
+
+    /// Approximate heap bytes
+    [[nodiscard]] size_t memory() const {
+        return sparse.capacity() * sizeof(uint32_t) + dense.capacity();
+    }
+
+  private:
+    static uint64_t linearCounting(uint32_t zeros) {
+        constexpr double m = REGISTERS;
+        return static_cast<uint64_t>(m * std::log(m / std::max<uint32_t>(zeros, 1)) + 0.5);
+    }
+
+    void set(uint32_t index, uint8_t rank) {
+        if (!dense.empty()) {
+            dense[index] = std::max(dense[index], rank);
+            return;
+        }
+
+        // sparse entries are sorted by register, entry = register << 8 | rank
+        auto it = std::lower_bound(sparse.begin(), sparse.end(), index << 8);
+        if (it != sparse.end() && (*it >> 8) == index) {
+            if ((*it & 0xFF) < rank)
+                *it = (index << 8) | rank;
+            return;
+        }
+        sparse.insert(it, (index << 8) | rank);
+        if (sparse.size() > SPARSE_LIMIT)
+            toDense();
+    }
+
+    void toDense() {
+        dense.assign(REGISTERS, 0);
+        for (auto entry: sparse)
+            dense[entry >> 8] = std::max<uint8_t>(dense[entry >> 8], entry & 0xFF);
+        sparse.clear();
+        sparse.shrink_to_fit();
+    }
+
+    std::vector<uint32_t> sparse;
+    std::vector<uint8_t> dense;
+};
+
+#endif //CHATCONTROLLER_COMMON_HYPERLOGLOG_H_
@@ -0,0 +1,86 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_COMMON_MPSCQUEUE_H_
+#define CHATCONTROLLER_COMMON_MPSCQUEUE_H_
+
+#include <atomic>
+#include <utility>
+
+// Unbounded multi producer single consumer queue(D. Vyukov node based algorithm).
+// push() is wait-free and can be called from any thread, pop() must be called from one consumer thread.
+// While producer is between exchange and link pop() can miss its element and return false,
+// consumer sees it on the next call.
+template <typename T>
+class MPSCQueue
+{
+  public:
+    MPSCQueue() : head(&stub), tail(&stub) {}
+    ~MPSCQueue() {
+        T value;
+        while (pop(value));
+    }
+
+    MPSCQueue(const MPSCQueue &) = delete;
+    MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+    /// Appends value, any thread
+    void push(T value) {
+        push(new Node(std::move(value)));
+    }
+
+    /// Takes first value, consumer thread only
+    bool pop(T &value) {
+        Node *first = tail;
+        Node *next = first->next.load(std::memory_order_acquire);
+        if (first == &stub) {
+            if (!next)
+                return false;
+            tail = next;
+            first = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (!next) {
+            if (first != head.load(std::memory_order_acquire))
+                return false; // producer is linking new node
+            // last node can't be taken while it is a head, put stub behind it
+            push(&stub);
+            next = first->next.load(std::memory_order_acquire);
+            if (!next)
+                return false;
+        }
+
+        tail = next;
+        value = std::move(first->value);
+        delete first;
+        return true;
+    }
+
+    /// Approximate check, consumer thread only
+    [[nodiscard]] bool empty() const {
+        return tail == &stub && !stub.next.load(std::memory_order_acquire);
+    }
+
+  private:
+    struct Node {
+        Node() = default;
+        explicit Node(T &&value) : value(std::move(value)) {}
+
+        std::atomic<Node *> next{nullptr};
+        T value{};
+    };
+
+    void push(Node *node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node *prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    Node stub;
+    std::atomic<Node *> head; // producers side
+    Node *tail;               // consumer side
+};
+
+#endif //CHATCONTROLLER_COMMON_MPSCQUEUE_H_
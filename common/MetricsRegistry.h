@@ -0,0 +1,149 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_COMMON_METRICSREGISTRY_H_
+#define CHATCONTROLLER_COMMON_METRICSREGISTRY_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "OpenHashIndex.h"
+#include "ThreadShards.h"
+
+// Counters bumped inline by producer threads.
+// Every thread writes only to its own shard, so hot path is a relaxed atomic add on a cache line
+// no other producer touches. Names are interned to ids once per thread, ids are stable for registry lifetime.
+// collect() is the only reader, it takes values accumulated since previous collect.
+class MetricsRegistry
+{
+  public:
+    using Id = uint32_t;
+    static constexpr size_t CHUNK_SIZE = 4096;  // counters per lazily allocated chunk
+    static constexpr size_t MAX_CHUNKS = 1024;  // up to 4M counters
+    static constexpr Id NPOS = UINT32_MAX;
+
+    struct Snapshot {
+        std::vector<std::pair<Id, uint64_t>> counters; // only non zero
+    };
+
+  public:
+    MetricsRegistry() = default;
+    ~MetricsRegistry() = default;
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /// Interns counter name, any thread. Prefer add(name) on hot path, it caches ids per thread
+    Id counter(std::string_view name) {
+        std::lock_guard lg(mutex);
+        return intern(counterNames, counterIndex, name);
+    }
+
+    [[nodiscard]] std::string counterName(Id id) const {
+        std::lock_guard lg(mutex);
+        return id < counterNames.size() ? counterNames[id] : std::string();
+    }
+
+    /// Adds value to counter by id
+    void add(Id id, uint64_t value = 1) {
+        if (id >= CHUNK_SIZE * MAX_CHUNKS)
+            return;
+        auto &chunkPtr = shards.local().chunks[id / CHUNK_SIZE];
+        auto *chunk = chunkPtr.load(std::memory_order_acquire);
+        if (!chunk) {
+            chunk = new Chunk{};
+            chunkPtr.store(chunk, std::memory_order_release);
+        }
+        (*chunk)[id % CHUNK_SIZE].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /// Adds value to counter by name, name is interned once per thread
+    void add(std::string_view name, uint64_t value = 1) {
+        auto &shard = shards.local();
+        Id cached = shard.index.find(name);
+        if (cached == NPOS) {
+            cached = static_cast<Id>(shard.ids.size());
+            shard.names.emplace_back(name);
+            shard.ids.push_back(counter(name));
+            shard.index.insert(cached);
+        }
+        add(shard.ids[cached], value);
+    }
+
+    /// Takes values accumulated by all threads since previous collect
+    Snapshot collect() {
+        Snapshot res;
+        std::vector<uint64_t> counters;
+
+        std::lock_guard lg(mutex);
+        counters.resize(counterNames.size());
+        shards.forEach([&counters] (Shard &shard) {
+            for (size_t c = 0; c * CHUNK_SIZE < counters.size(); ++c) {
+                auto *chunk = shard.chunks[c].load(std::memory_order_acquire);
+                if (!chunk)
+                    continue;
+                size_t size = std::min(CHUNK_SIZE, counters.size() - c * CHUNK_SIZE);
+                for (size_t i = 0; i < size; ++i) {
+                    // plain load first, exchange would pull every cache line of producer in exclusive state
+                    if ((*chunk)[i].load(std::memory_order_relaxed))
+                        counters[c * CHUNK_SIZE + i] += (*chunk)[i].exchange(0, std::memory_order_relaxed);
+                }
+            }
+        });
+
+        for (size_t i = 0; i < counters.size(); ++i) {
+            if (counters[i])
+                res.counters.emplace_back(static_cast<Id>(i), counters[i]);
+        }
+        return res;
+    }
+
+  private:
+    using Chunk = std::array<std::atomic<uint64_t>, CHUNK_SIZE>;
+
+    struct NameOf {
+        const std::vector<std::string> *names;
+        std::string_view operator()(Id id) const { return (*names)[id]; }
+    };
+
+    // values of finished threads are not lost, shard outlives its thread
+    struct alignas(64) Shard {
+        Shard() : index(NameOf{&names}) {}
+        ~Shard() {
+            for (auto &chunk: chunks)
+                delete chunk.load(std::memory_order_relaxed);
+        }
+
+        std::array<std::atomic<Chunk *>, MAX_CHUNKS> chunks{};
+
+        // thread own name cache, never read by collect()
+        std::vector<std::string> names;
+        std::vector<Id> ids;
+        OpenHashIndex<NameOf> index;
+    };
+
+    Id intern(std::vector<std::string> &names, OpenHashIndex<NameOf> &index, std::string_view name) {
+        Id id = index.find(name);
+        if (id != NPOS)
+            return id;
+        id = static_cast<Id>(names.size());
+        names.emplace_back(name);
+        index.insert(id);
+        return id;
+    }
+
+    mutable std::mutex mutex; // guards names
+    ThreadShards<Shard> shards;
+    std::vector<std::string> counterNames;
+    OpenHashIndex<NameOf> counterIndex{NameOf{&counterNames}};
+};
+
+#endif //CHATCONTROLLER_COMMON_METRICSREGISTRY_H_
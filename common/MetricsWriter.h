@@ -0,0 +1,181 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_COMMON_METRICSWRITER_H_
+#define CHATCONTROLLER_COMMON_METRICSWRITER_H_
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+#include "Histogram.h"
+
+// Prometheus text exposition format (0.0.4) writer.
+// Appends to caller owned buffer, numbers and labels are formatted on stack,
+// so buffer kept between scrapes makes rendering allocation free.
+class MetricsWriter
+{
+  public:
+    struct Label {
+        Label(std::string_view name, std::string_view value) : name(name), value(value) {}
+        Label(std::string_view name, const char *value) : name(name), value(value) {}
+        Label(std::string_view name, unsigned long long number) : name(name) {
+            auto res = std::to_chars(digits, digits + sizeof(digits), number);
+            value = std::string_view(digits, res.ptr - digits);
+        }
+        Label(std::string_view name, unsigned long number) : Label(name, static_cast<unsigned long long>(number)) {}
+        Label(std::string_view name, unsigned int number) : Label(name, static_cast<unsigned long long>(number)) {}
+        Label(std::string_view name, int number) : Label(name, static_cast<unsigned long long>(number)) {}
+
+        Label(const Label &other) : name(other.name), value(other.value) {
+            if (other.value.data() == other.digits) {
+                std::copy(other.digits, other.digits + sizeof(digits), digits);
+                value = std::string_view(digits, other.value.size());
+            }
+        }
+        Label &operator=(const Label &) = delete;
+
+        std::string_view name;
+        std::string_view value;
+        char digits[24]{};
+    };
+    using Labels = std::initializer_list<Label>;
+
+  public:
+    explicit MetricsWriter(std::string &out) : out(out) {}
+
+    /// Writes HELP and TYPE lines, type is counter, gauge or histogram
+    void family(std::string_view name, std::string_view type, std::string_view help) {
+        out.append("# HELP ").append(name).push_back(' ');
+        out.append(help).push_back('\n');
+        out.append("# TYPE ").append(name).push_back(' ');
+        out.append(type).push_back('\n');
+    }
+
+    void sample(std::string_view name, Labels labels, unsigned long long value) {
+        head(name, labels);
+        number(value);
+        out.push_back('\n');
+    }
+
+    void sample(std::string_view name, Labels labels, double value) {
+        head(name, labels);
+        number(value);
+        out.push_back('\n');
+    }
+
+    void sample(std::string_view name, Labels labels, unsigned int value) {
+        sample(name, labels, static_cast<unsigned long long>(value));
+    }
+
+    void sample(std::string_view name, Labels labels, unsigned long value) {
+        sample(name, labels, static_cast<unsigned long long>(value));
+    }
+
+    void sample(std::string_view name, Labels labels, long long value) {
+        sample(name, labels, static_cast<double>(value));
+    }
+
+    void sample(std::string_view name, Labels labels, int value) {
+        sample(name, labels, static_cast<double>(value));
+    }
+
+    /// Writes _bucket, _sum and _count samples of histogram family name.
+    /// Buckets are powers of two of recorded unit up to 2^bits, le is scaled by scale(e.g. 1e-6 for us to seconds).
+    /// Recorded values are integers, so le = 2^k counts values below 2^k
+    void histogram(std::string_view name, Labels labels, const Histogram &hist, int bits, double scale = 1.0) {
+        int index = 0;
+        unsigned long long cumulative = 0;
+        for (int k = 0; k <= bits; ++k) {
+            auto bound = uint64_t{1} << k;
+            for (; index < Histogram::BUCKETS && Histogram::bucketUpperBound(index) < bound; ++index)
+                cumulative += hist.bucketCount(index);
+            bucket(name, labels, static_cast<double>(bound) * scale, cumulative);
+        }
+        bucket(name, labels, INFINITY, hist.count());
+
+        head(name, "_sum", labels);
+        number(static_cast<double>(hist.valueSum()) * scale);
+        out.push_back('\n');
+        head(name, "_count", labels);
+        number(static_cast<unsigned long long>(hist.count()));
+        out.push_back('\n');
+    }
+
+  private:
+    void head(std::string_view name, Labels labels) {
+        head(name, {}, labels);
+    }
+
+    void head(std::string_view name, std::string_view suffix, Labels labels) {
+        out.append(name).append(suffix);
+        if (labels.size()) {
+            out.push_back('{');
+            bool first = true;
+            for (auto &label: labels) {
+                if (!first)
+                    out.push_back(',');
+                first = false;
+                writeLabel(label.name, label.value);
+            }
+            out.push_back('}');
+        }
+        out.push_back(' ');
+    }
+
+    void bucket(std::string_view name, Labels labels, double le, unsigned long long count) {
+        out.append(name).append("_bucket{");
+        for (auto &label: labels) {
+            writeLabel(label.name, label.value);
+            out.push_back(',');
+        }
+        out.append("le=\"");
+        number(le);
+        out.append("\"} ");
+        number(count);
+        out.push_back('\n');
+    }
+
+    void writeLabel(std::string_view name, std::string_view value) {
+        out.append(name).append("=\"");
+        for (char c: value) {
+            switch (c) {
+                case '\\': out.append("\\\\"); break;
+                case '"': out.append("\\\""); break;
+                case '\n': out.append("\\n"); break;
+                default: out.push_back(c);
+            }
+        }
+        out.push_back('"');
+    }
+
+    void number(unsigned long long value) {
+        char buffer[24];
+        auto res = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, res.ptr - buffer);
+    }
+
+    void number(double value) {
+        if (std::isinf(value)) {
+            out.append(value > 0 ? "+Inf" : "-Inf");
+            return;
+        }
+        if (std::isnan(value)) {
+            out.append("NaN");
+            return;
+        }
+        char buffer[32];
+        int size = std::snprintf(buffer, sizeof(buffer), "%.10g", value);
+        out.append(buffer, size);
+    }
+
+    std::string &out;
+};
+
+#endif //CHATCONTROLLER_COMMON_METRICSWRITER_H_
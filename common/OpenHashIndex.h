@@ -0,0 +1,130 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_COMMON_OPENHASHINDEX_H_
+#define CHATCONTROLLER_COMMON_OPENHASHINDEX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// Open addressing(linear probing) index of items stored elsewhere, items are addressed by uint32_t id.
+// Buckets keep only id and hash, key of id is read through keyOf(id), so index doesn't copy keys.
+// Erase uses backward shift, table has no tombstones and load factor is kept under 1/2.
+template <typename KeyOf>
+class OpenHashIndex
+{
+  public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+  public:
+    explicit OpenHashIndex(KeyOf keyOf) : keyOf(std::move(keyOf)) {}
+
+    /// Returns id of key or npos
+    [[nodiscard]] uint32_t find(std::string_view key) const {
+        if (buckets.empty())
+            return npos;
+        size_t hash = hashOf(key);
+        for (size_t i = hash & mask();; i = (i + 1) & mask()) {
+            const auto &bucket = buckets[i];
+            if (bucket.id == npos)
+                return npos;
+            if (bucket.hash == static_cast<uint32_t>(hash) && keyOf(bucket.id) == key)
+                return bucket.id;
+        }
+    }
+
+    /// Adds id by its current key, returns false if key is already indexed
+    bool insert(uint32_t id) {
+        if ((count + 1) * 2 > buckets.size())
+            rehash(std::max<size_t>(buckets.size() * 2, 16));
+
+        std::string_view key = keyOf(id);
+        size_t hash = hashOf(key);
+        size_t i = hash & mask();
+        for (; buckets[i].id != npos; i = (i + 1) & mask()) {
+            if (buckets[i].hash == static_cast<uint32_t>(hash) && keyOf(buckets[i].id) == key)
+                return false;
+        }
+        buckets[i] = Bucket{id, static_cast<uint32_t>(hash)};
+        ++count;
+        return true;
+    }
+
+    /// Removes key, key of indexed ids must be readable during erase
+    bool erase(std::string_view key) {
+        if (buckets.empty())
+            return false;
+        size_t hash = hashOf(key);
+        size_t i = hash & mask();
+        for (;; i = (i + 1) & mask()) {
+            if (buckets[i].id == npos)
+                return false;
+            if (buckets[i].hash == static_cast<uint32_t>(hash) && keyOf(buckets[i].id) == key)
+                break;
+        }
+
+        // shift following buckets of the same cluster back, unless they are already at their home
+        for (size_t j = (i + 1) & mask(); buckets[j].id != npos; j = (j + 1) & mask()) {
+            size_t home = buckets[j].hash & mask();
+            if (((j - home) & mask()) >= ((j - i) & mask())) {
+                buckets[i] = buckets[j];
+                i = j;
+            }
+        }
+        buckets[i] = Bucket{};
+        --count;
+        return true;
+    }
+
+    void clear() {
+        buckets.clear();
+        count = 0;
+    }
+
+    void reserve(size_t size) {
+        size_t capacity = 16;
+        while (capacity < size * 2)
+            capacity *= 2;
+        if (capacity > buckets.size())
+            rehash(capacity);
+    }
+
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] bool empty() const { return count == 0; }
+
+  private:
+    struct Bucket {
+        uint32_t id = npos;
+        uint32_t hash = 0; // low bits of key hash, also gives home bucket on rehash
+    };
+
+    static size_t hashOf(std::string_view key) {
+        return static_cast<uint32_t>(std::hash<std::string_view>{}(key));
+    }
+
+    [[nodiscard]] size_t mask() const { return buckets.size() - 1; }
+
+    void rehash(size_t capacity) {
+        std::vector<Bucket> old(capacity);
+        old.swap(buckets);
+        for (const auto &bucket: old) {
+            if (bucket.id == npos)
+                continue;
+            size_t i = bucket.hash & mask();
+            while (buckets[i].id != npos)
+                i = (i + 1) & mask();
+            buckets[i] = bucket;
+        }
+    }
+
+    KeyOf keyOf;
+    std::vector<Bucket> buckets; // size is power of two
+    size_t count = 0;
+};
+
+#endif //CHATCONTROLLER_COMMON_OPENHASHINDEX_H_
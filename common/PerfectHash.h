@@ -0,0 +1,138 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_COMMON_PERFECTHASH_H_
+#define CHATCONTROLLER_COMMON_PERFECTHASH_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Static minimal-probe hash set built with "hash and displace" method.
+/// Keys are split into buckets, for every bucket seed is searched that places all its keys to free slots,
+/// so lookup costs two hash calculations and one key comparison.
+class PerfectHash
+{
+  public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+  public:
+    PerfectHash() = default;
+
+    /// Duplicated keys are ignored, index of the first one is returned on lookup
+    explicit PerfectHash(std::vector<std::string> keys) : keys(std::move(keys)) {
+        build();
+    }
+
+    /// Returns index of key in constructor vector or NOT_FOUND
+    [[nodiscard]] uint32_t find(std::string_view key) const {
+        if (slots.empty())
+            return NOT_FOUND;
+        uint32_t bucket = hash(key, 0) % seeds.size();
+        uint32_t index = slots[hash(key, seeds[bucket]) % slots.size()];
+        return index != NOT_FOUND && keys[index] == key ? index : NOT_FOUND;
+    }
+
+    [[nodiscard]] size_t size() const { return keys.size(); }
+
+    static uint64_t hash(std::string_view key, uint64_t seed) {
+        uint64_t h = mix(seed * 0x9E3779B97F4A7C15ULL + key.size());
+        size_t i = 0;
+        for (; i + 8 <= key.size(); i += 8) {
+            uint64_t value;
+            std::memcpy(&value, key.data() + i, 8);
+            h = mix(h ^ value);
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, key.data() + i, key.size() - i);
+        return mix(h ^ tail);
+    }
+
+  private:
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xFF51AFD7ED558CCDULL;
+        x ^= x >> 33;
+        x *= 0xC4CEB9FE1A85EC53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    void build() {
+        if (keys.empty())
+            return;
+
+        size_t slotCount = keys.size() + keys.size() / 4 + 1;
+        while (!tryBuild(slotCount))
+            slotCount += slotCount / 8 + 1;
+    }
+
+    bool tryBuild(size_t slotCount) {
+        static constexpr uint32_t MAX_SEED = 1u << 16;
+
+        seeds.assign(keys.size() / 4 + 1, 0);
+        slots.assign(slotCount, NOT_FOUND);
+
+        std::vector<std::vector<uint32_t>> buckets(seeds.size());
+        for (uint32_t i = 0; i < keys.size(); ++i)
+            buckets[hash(keys[i], 0) % seeds.size()].push_back(i);
+
+        // place the biggest buckets first, while table is mostly free
+        std::vector<uint32_t> order(buckets.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&buckets] (uint32_t lhs, uint32_t rhs) {
+            return buckets[lhs].size() > buckets[rhs].size();
+        });
+
+        std::vector<uint32_t> placed;
+        for (uint32_t bucket: order) {
+            auto &items = buckets[bucket];
+            if (items.empty())
+                break;
+
+            removeDuplicates(items);
+
+            uint32_t seed = 1;
+            for (; seed < MAX_SEED; ++seed) {
+                placed.clear();
+                for (uint32_t index: items) {
+                    size_t slot = hash(keys[index], seed) % slotCount;
+                    if (slots[slot] != NOT_FOUND)
+                        break;
+                    slots[slot] = index;
+                    placed.push_back(slot);
+                }
+                if (placed.size() == items.size())
+                    break;
+                for (auto slot: placed)
+                    slots[slot] = NOT_FOUND;
+            }
+            if (seed == MAX_SEED)
+                return false;
+            seeds[bucket] = seed;
+        }
+        return true;
+    }
+
+    void removeDuplicates(std::vector<uint32_t> &items) const {
+        for (size_t i = 0; i < items.size(); ++i) {
+            for (size_t j = i + 1; j < items.size();) {
+                if (keys[items[i]] == keys[items[j]])
+                    items.erase(items.begin() + j);
+                else
+                    ++j;
+            }
+        }
+    }
+
+    std::vector<std::string> keys;
+    std::vector<uint32_t> seeds; // seed per bucket
+    std::vector<uint32_t> slots; // key index per slot
+};
+
+#endif //CHATCONTROLLER_COMMON_PERFECTHASH_H_
@@ -0,0 +1,232 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_COMMON_SPACESAVING_H_
+#define CHATCONTROLLER_COMMON_SPACESAVING_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "OpenHashIndex.h"
+
+// Space-Saving top-K summary, monitors at most capacity keys.
+// Unknown key replaces the key with minimal count and inherits that count as error,
+// so any key with true count above total / capacity is guaranteed to be monitored.
+// Minimum is kept by indexed binary heap, add is O(log capacity) and doesn't allocate for known keys.
+class SpaceSaving
+{
+  public:
+    struct Item {
+        std::string key;
+        uint64_t count = 0; // upper bound of true count
+        uint64_t error = 0; // count - error is lower bound
+    };
+
+  public:
+    SpaceSaving() : SpaceSaving(256) {}
+    explicit SpaceSaving(size_t capacity) : limit(std::max<size_t>(capacity, 1)) {}
+
+    SpaceSaving(const SpaceSaving &other) : limit(other.limit), entries(other.entries), heap(other.heap) {
+        reindex();
+    }
+    SpaceSaving(SpaceSaving &&other) : limit(other.limit), entries(std::move(other.entries)), heap(std::move(other.heap)) {
+        reindex();
+        other.clear();
+    }
+    SpaceSaving &operator=(const SpaceSaving &other) {
+        if (this != &other) {
+            limit = other.limit;
+            entries = other.entries;
+            heap = other.heap;
+            reindex();
+        }
+        return *this;
+    }
+    SpaceSaving &operator=(SpaceSaving &&other) {
+        if (this != &other) {
+            limit = other.limit;
+            entries = std::move(other.entries);
+            heap = std::move(other.heap);
+            reindex();
+            other.clear();
+        }
+        return *this;
+    }
+
+    void add(std::string_view key, uint64_t count = 1) {
+        uint32_t id = index.find(key);
+        if (id != Index::npos) {
+            entries[id].item.count += count;
+            siftDown(entries[id].heapPos);
+            return;
+        }
+
+        if (entries.size() < limit) {
+            id = static_cast<uint32_t>(entries.size());
+            entries.push_back(Entry{Item{std::string(key), count, 0}, static_cast<uint32_t>(heap.size())});
+            heap.push_back(id);
+            index.insert(id);
+            siftUp(entries[id].heapPos);
+            return;
+        }
+
+        // replace the minimum, key storage is reused
+        id = heap.front();
+        auto &item = entries[id].item;
+        index.erase(item.key);
+        item.key.assign(key);
+        item.error = item.count;
+        item.count += count;
+        index.insert(id);
+        siftDown(0);
+    }
+
+    /// Merges other summary. Key missing in full summary could have count up to its minimum,
+    /// so minimum is added to count and error, result keeps capacity largest keys
+    void merge(const SpaceSaving &other) {
+        if (other.entries.empty())
+            return;
+        const uint64_t thisMin = full() ? minCount() : 0;
+        const uint64_t otherMin = other.full() ? other.minCount() : 0;
+
+        std::vector<Item> merged;
+        std::vector<bool> matched(other.entries.size());
+        merged.reserve(entries.size() + other.entries.size());
+        for (auto &entry: entries) {
+            Item item = std::move(entry.item);
+            uint32_t id = other.index.find(item.key);
+            const Item *rhs = id != Index::npos ? &other.entries[id].item : nullptr;
+            if (rhs)
+                matched[id] = true;
+            item.count += rhs ? rhs->count : otherMin;
+            item.error += rhs ? rhs->error : otherMin;
+            merged.push_back(std::move(item));
+        }
+        for (uint32_t id = 0; id < other.entries.size(); ++id) {
+            if (matched[id])
+                continue;
+            auto &item = other.entries[id].item;
+            merged.push_back(Item{item.key, item.count + thisMin, item.error + thisMin});
+        }
+
+        if (merged.size() > limit) {
+            std::nth_element(merged.begin(), merged.begin() + limit, merged.end(), byCount);
+            merged.resize(limit);
+        }
+        assign(std::move(merged));
+    }
+
+    /// Up to n monitored keys with the largest counts, sorted by count
+    [[nodiscard]] std::vector<Item> top(size_t n) const {
+        std::vector<Item> res;
+        res.reserve(entries.size());
+        for (auto &entry: entries)
+            res.push_back(entry.item);
+        n = std::min(n, res.size());
+        std::partial_sort(res.begin(), res.begin() + n, res.end(), byCount);
+        res.resize(n);
+        return res;
+    }
+
+    /// Count of monitored key or 0
+    [[nodiscard]] uint64_t count(std::string_view key) const {
+        uint32_t id = index.find(key);
+        return id != Index::npos ? entries[id].item.count : 0;
+    }
+
+    /// Minimal monitored count, upper bound of any unmonitored key when summary is full
+    [[nodiscard]] uint64_t minCount() const { return heap.empty() ? 0 : entries[heap.front()].item.count; }
+    [[nodiscard]] size_t size() const { return entries.size(); }
+    [[nodiscard]] size_t capacity() const { return limit; }
+    [[nodiscard]] bool full() const { return entries.size() >= limit; }
+    [[nodiscard]] bool empty() const { return entries.empty(); }
+
+    void clear() {
+        entries.clear();
+        heap.clear();
+        index.clear();
+    }
+
+  private:
+    struct Entry {
+        Item item;
+        uint32_t heapPos;
+    };
+
+    struct KeyOf {
+        const std::vector<Entry> *entries;
+        std::string_view operator()(uint32_t id) const { return (*entries)[id].item.key; }
+    };
+    using Index = OpenHashIndex<KeyOf>;
+
+    static bool byCount(const Item &lhs, const Item &rhs) {
+        return lhs.count > rhs.count || (lhs.count == rhs.count && lhs.key < rhs.key);
+    }
+
+    void assign(std::vector<Item> &&items) {
+        entries.clear();
+        heap.clear();
+        for (auto &item: items) {
+            heap.push_back(static_cast<uint32_t>(entries.size()));
+            entries.push_back(Entry{std::move(item), 0});
+        }
+        for (size_t i = heap.size(); i-- > 0;)
+            siftDown(i);
+        reindex();
+    }
+
+    void reindex() {
+        index = Index(KeyOf{&entries});
+        index.reserve(entries.size());
+        for (uint32_t id = 0; id < entries.size(); ++id)
+            index.insert(id);
+        for (uint32_t pos = 0; pos < heap.size(); ++pos)
+            entries[heap[pos]].heapPos = pos;
+    }
+
+    [[nodiscard]] uint64_t heapCount(size_t pos) const { return entries[heap[pos]].item.count; }
+
+    void swapHeap(size_t a, size_t b) {
+        std::swap(heap[a], heap[b]);
+        entries[heap[a]].heapPos = static_cast<uint32_t>(a);
+        entries[heap[b]].heapPos = static_cast<uint32_t>(b);
+    }
+
+    void siftUp(size_t pos) {
+        while (pos > 0) {
+            size_t parent = (pos - 1) / 2;
+            if (heapCount(parent) <= heapCount(pos))
+                break;
+            swapHeap(parent, pos);
+            pos = parent;
+        }
+    }
+
+    void siftDown(size_t pos) {
+        for (;;) {
+            size_t smallest = pos;
+            size_t left = pos * 2 + 1;
+            size_t right = left + 1;
+            if (left < heap.size() && heapCount(left) < heapCount(smallest))
+                smallest = left;
+            if (right < heap.size() && heapCount(right) < heapCount(smallest))
+                smallest = right;
+            if (smallest == pos)
+                return;
+            swapHeap(pos, smallest);
+            pos = smallest;
+        }
+    }
+
+    size_t limit;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> heap; // min-heap of entry ids by count
+    Index index{KeyOf{&entries}};
+};
+
+#endif //CHATCONTROLLER_COMMON_SPACESAVING_H_
@@ -0,0 +1,83 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_COMMON_THREADSHARDS_H_
+#define CHATCONTROLLER_COMMON_THREADSHARDS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Per thread shards of one owner object, e.g. metrics registry or trace buffer.
+// Shard is created on first use by thread and found by thread local cache without locks afterwards.
+// Shards are owned by this object and outlive threads that filled them, so their data is not lost.
+template <typename Shard>
+class ThreadShards
+{
+  public:
+    ThreadShards() : generation(nextGeneration()) {}
+    ~ThreadShards() = default;
+
+    ThreadShards(const ThreadShards&) = delete;
+    ThreadShards& operator=(const ThreadShards&) = delete;
+
+    /// Shard of calling thread, new one is passed to init(shard, index) before it is visible to forEach()
+    template <typename Init>
+    Shard &local(Init &&init) {
+        // cache is addressed by generation, address of destroyed owner can be reused
+        struct Cached {
+            uint64_t generation = 0;
+            Shard *shard = nullptr;
+        };
+        thread_local Cached last;
+        thread_local std::vector<Cached> cached;
+        if (last.generation == generation)
+            return *last.shard;
+
+        for (auto &entry: cached) {
+            if (entry.generation == generation) {
+                last = entry;
+                return *entry.shard;
+            }
+        }
+
+        auto shard = std::make_unique<Shard>();
+        Shard *res;
+        {
+            std::lock_guard lg(mutex);
+            init(*shard, shards.size());
+            res = shards.emplace_back(std::move(shard)).get();
+        }
+        last = Cached{generation, res};
+        cached.push_back(last);
+        return *res;
+    }
+
+    Shard &local() {
+        return local([] (Shard &, size_t) {});
+    }
+
+    /// Calls func for every shard in creation order
+    template <typename Func>
+    void forEach(Func &&func) const {
+        std::lock_guard lg(mutex);
+        for (auto &shard: shards)
+            func(*shard);
+    }
+
+  private:
+    static uint64_t nextGeneration() {
+        static std::atomic<uint64_t> last = 0;
+        return last.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    const uint64_t generation;
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Shard>> shards;
+};
+
+#endif //CHATCONTROLLER_COMMON_THREADSHARDS_H_
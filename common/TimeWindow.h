@@ -0,0 +1,102 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_COMMON_TIMEWINDOW_H_
+#define CHATCONTROLLER_COMMON_TIMEWINDOW_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+/// Adds src to dst, arithmetic values are summed, other types must have merge()
+template <typename T>
+inline void timeWindowMerge(T &dst, const T &src) {
+    if constexpr (std::is_arithmetic_v<T>)
+        dst += src;
+    else
+        dst.merge(src);
+}
+
+// Ring of SLOTS consecutive time slots, slot is a time divided by slot duration.
+// Ring rolls forward on add, slots that fell out of ring are reset, so memory is fixed.
+template <typename T, size_t SLOTS>
+class TimeRing
+{
+  public:
+    void add(long long slot, const T &value) {
+        if (slot > head) {
+            auto gap = std::min<long long>(slot - head, SLOTS);
+            for (long long i = 1; i <= gap; ++i)
+                values[(head + i) % SLOTS] = T{};
+            head = slot;
+        } else if (slot <= head - static_cast<long long>(SLOTS)) {
+            return; // older than ring
+        }
+        timeWindowMerge(values[slot % SLOTS], value);
+    }
+
+    /// Merges slots in [from, to], slots outside ring are skipped
+    [[nodiscard]] T sum(long long from, long long to) const {
+        T res{};
+        from = std::max(from, head - static_cast<long long>(SLOTS) + 1);
+        to = std::min(to, head);
+        for (long long slot = from; slot <= to; ++slot)
+            timeWindowMerge(res, values[slot % SLOTS]);
+        return res;
+    }
+
+    /// The latest slot written, 0 if nothing was added
+    [[nodiscard]] long long last() const { return head; }
+
+  private:
+    std::array<T, SLOTS> values{};
+    long long head = 0;
+};
+
+// Time series of T with per-second slots for the last SECONDS seconds
+// and per-minute slots for the last MINUTES minutes. SECONDS may be 0 to keep minutes only.
+// Times are in seconds, caller passes current time so all windows of one owner share a clock.
+template <typename T, size_t SECONDS, size_t MINUTES>
+class TimeWindow
+{
+  public:
+    static constexpr long long HORIZON = MINUTES * 60; // the longest window in seconds
+
+    void add(long long now, const T &value) {
+        if constexpr (SECONDS > 0)
+            seconds.add(now, value);
+        minutes.add(now / 60, value);
+    }
+
+    /// Merges values of last window seconds up to now. Windows longer than seconds ring are
+    /// rounded up to whole minutes, covered receives real length of summed period to compute rates
+    [[nodiscard]] T sum(long long now, long long window, long long *covered = nullptr) const {
+        window = std::clamp(window, 1LL, HORIZON);
+        if constexpr (SECONDS > 0) {
+            if (window <= static_cast<long long>(SECONDS)) {
+                if (covered)
+                    *covered = window;
+                return seconds.sum(now - window + 1, now);
+            }
+        }
+        // current minute is partial, it counts as much as passed of it
+        long long full = (window - 1) / 60;
+        if (covered)
+            *covered = full * 60 + now % 60 + 1;
+        return minutes.sum(now / 60 - full, now / 60);
+    }
+
+    /// Nothing was added during the whole horizon
+    [[nodiscard]] bool idle(long long now) const {
+        return minutes.last() <= now / 60 - static_cast<long long>(MINUTES);
+    }
+
+  private:
+    struct NoSeconds {};
+    std::conditional_t<(SECONDS > 0), TimeRing<T, SECONDS>, NoSeconds> seconds;
+    TimeRing<T, MINUTES> minutes;
+};
+
+#endif //CHATCONTROLLER_COMMON_TIMEWINDOW_H_
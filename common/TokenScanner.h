@@ -0,0 +1,79 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_COMMON_TOKENSCANNER_H_
+#define CHATCONTROLLER_COMMON_TOKENSCANNER_H_
+
+#include <cstddef>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// Whitespace tokenizer for chat text. Uses SSE2 to scan 16 bytes at once when available.
+/// Multibyte UTF-8 sequences never contain ASCII bytes, so splitting by ASCII whitespace is UTF-8 safe.
+namespace TokenScanner
+{
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+/// Returns position of first byte matching(space == true) or not matching whitespace, or size
+template<bool space>
+inline size_t find(const char *data, size_t pos, size_t size) {
+#if defined(__SSE2__)
+    const __m128i spaces = _mm_set1_epi8(' ');
+    const __m128i tabs = _mm_set1_epi8('\t');
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        __m128i matched = _mm_or_si128(_mm_cmpeq_epi8(chunk, spaces), _mm_cmpeq_epi8(chunk, tabs));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(matched));
+        if constexpr (!space)
+            mask = ~mask & 0xFFFFu;
+        if (mask)
+            return pos + __builtin_ctz(mask);
+    }
+#endif
+    for (; pos < size; ++pos) {
+        if (isSpace(data[pos]) == space)
+            return pos;
+    }
+    return size;
+}
+
+/// Checks that all bytes are 7-bit ASCII
+inline bool isAscii(const char *data, size_t size) {
+    size_t pos = 0;
+#if defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+    for (; pos + 16 <= size; pos += 16)
+        acc = _mm_or_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos)));
+    if (_mm_movemask_epi8(acc))
+        return false;
+#endif
+    for (; pos < size; ++pos) {
+        if (static_cast<unsigned char>(data[pos]) & 0x80u)
+            return false;
+    }
+    return true;
+}
+
+/// Calls handler(std::string_view token, bool ascii) for every whitespace separated token
+template<typename Handler>
+inline void scan(std::string_view text, Handler &&handler) {
+    const char *data = text.data();
+    size_t size = text.size();
+    size_t pos = find<false>(data, 0, size);
+    while (pos < size) {
+        size_t end = find<true>(data, pos, size);
+        handler(text.substr(pos, end - pos), isAscii(data + pos, end - pos));
+        pos = find<false>(data, end, size);
+    }
+}
+
+}
+
+#endif //CHATCONTROLLER_COMMON_TOKENSCANNER_H_
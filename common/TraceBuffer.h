@@ -0,0 +1,319 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_COMMON_TRACEBUFFER_H_
+#define CHATCONTROLLER_COMMON_TRACEBUFFER_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ThreadName.h"
+#include "ThreadShards.h"
+
+// Spans of sampled chat messages, one ring of the latest spans per writer thread.
+// Writer stores span fields and publishes it by ring head, no locks and no allocations on hot path.
+// Reader copies rings and drops slots that could be overwritten during copy.
+// Spans of one trace are linked as flow in Chrome JSON and Perfetto exports.
+class TraceBuffer
+{
+  public:
+    static constexpr size_t RING_SIZE = 4096; // spans kept per thread
+
+    struct Span {
+        uint64_t trace = 0;
+        const char *name = "";  // static string
+        long long begin = 0;    // monotonic microseconds
+        long long end = 0;
+        long long arg = 0;      // hop specific value, e.g. bot id
+        uint32_t thread = 0;    // index in Dump::threads
+    };
+
+    struct Thread {
+        uint32_t tid = 0; // registration order, starts from 1
+        std::string name;
+    };
+
+    struct Dump {
+        std::vector<Thread> threads;
+        std::vector<Span> spans; // sorted by begin
+    };
+
+  public:
+    TraceBuffer() = default;
+    ~TraceBuffer() = default;
+
+    TraceBuffer(const TraceBuffer&) = delete;
+    TraceBuffer& operator=(const TraceBuffer&) = delete;
+
+    /// Traces 1 of rate messages, 0 disables tracing
+    void setSampleRate(unsigned int rate) { sampleRate.store(rate, std::memory_order_relaxed); }
+    [[nodiscard]] unsigned int getSampleRate() const { return sampleRate.load(std::memory_order_relaxed); }
+
+    /// Returns id of new trace if message is sampled, 0 otherwise. Counts messages per thread
+    uint64_t sample() {
+        unsigned int rate = sampleRate.load(std::memory_order_relaxed);
+        if (rate == 0)
+            return 0;
+        thread_local unsigned int counter = 0;
+        if (++counter < rate)
+            return 0;
+        counter = 0;
+        return lastTrace.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    /// Records span of trace, does nothing for trace 0
+    void span(uint64_t trace, const char *name, long long begin, long long end, long long arg = 0) {
+        if (!trace)
+            return;
+        auto &ring = rings.local([] (Ring &ring, size_t index) {
+            ring.tid = static_cast<uint32_t>(index + 1);
+            ring.name = get_thread_name();
+        });
+        uint64_t index = ring.head.load(std::memory_order_relaxed);
+        auto &slot = ring.slots[index % RING_SIZE];
+        slot.trace.store(trace, std::memory_order_relaxed);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.begin.store(begin, std::memory_order_relaxed);
+        slot.end.store(end, std::memory_order_relaxed);
+        slot.arg.store(arg, std::memory_order_relaxed);
+        ring.head.store(index + 1, std::memory_order_release);
+    }
+
+    /// Copies spans of all threads, buffer is not cleared
+    [[nodiscard]] Dump collect() const {
+        Dump res;
+        rings.forEach([&res] (const Ring &ring) {
+            auto thread = static_cast<uint32_t>(res.threads.size());
+            res.threads.push_back(Thread{ring.tid, ring.name});
+
+            uint64_t head = ring.head.load(std::memory_order_acquire);
+            uint64_t from = head > RING_SIZE ? head - RING_SIZE : 0;
+            size_t first = res.spans.size();
+            for (uint64_t i = from; i < head; ++i) {
+                auto &slot = ring.slots[i % RING_SIZE];
+                res.spans.push_back(Span{slot.trace.load(std::memory_order_relaxed),
+                                         slot.name.load(std::memory_order_relaxed),
+                                         slot.begin.load(std::memory_order_relaxed),
+                                         slot.end.load(std::memory_order_relaxed),
+                                         slot.arg.load(std::memory_order_relaxed),
+                                         thread});
+            }
+
+            // writer could overwrite the oldest copied slots meanwhile, including one it writes right now
+            uint64_t after = ring.head.load(std::memory_order_acquire);
+            uint64_t valid = after + 1 > RING_SIZE ? after + 1 - RING_SIZE : 0;
+            if (valid > from) {
+                auto drop = static_cast<size_t>(std::min(valid, head) - from);
+                res.spans.erase(res.spans.begin() + first, res.spans.begin() + first + drop);
+            }
+        });
+        std::sort(res.spans.begin(), res.spans.end(), [] (const Span &lhs, const Span &rhs) {
+            return lhs.begin < rhs.begin;
+        });
+        return res;
+    }
+
+    /// Chrome trace event format(JSON object), spans are complete events linked by flow events
+    static void writeChromeJson(const Dump &dump, std::string &out) {
+        out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+        bool first = true;
+        auto next = [&out, &first] () {
+            if (!first)
+                out.push_back(',');
+            first = false;
+        };
+
+        for (auto &thread: dump.threads) {
+            next();
+            out.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+            number(out, thread.tid);
+            out.append(",\"args\":{\"name\":");
+            string(out, thread.name);
+            out.append("}}");
+        }
+
+        auto flows = flowSteps(dump);
+        for (size_t i = 0; i < dump.spans.size(); ++i) {
+            const auto &span = dump.spans[i];
+            const auto tid = dump.threads[span.thread].tid;
+            next();
+            out.append("{\"name\":");
+            string(out, span.name);
+            out.append(",\"cat\":\"chat\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+            number(out, tid);
+            out.append(",\"ts\":");
+            number(out, span.begin);
+            out.append(",\"dur\":");
+            number(out, std::max(span.end - span.begin, 0LL));
+            out.append(",\"args\":{\"trace\":");
+            number(out, span.trace);
+            out.append(",\"arg\":");
+            number(out, span.arg);
+            out.append("}}");
+
+            // flow step binds to enclosing slice at its timestamp
+            if (flows[i] == Flow::None)
+                continue;
+            next();
+            out.append("{\"name\":\"message\",\"cat\":\"chat\",\"ph\":\"");
+            out.push_back(flows[i] == Flow::Start ? 's' : flows[i] == Flow::Step ? 't' : 'f');
+            out.append("\",\"bp\":\"e\",\"pid\":1,\"tid\":");
+            number(out, tid);
+            out.append(",\"ts\":");
+            number(out, span.begin);
+            out.append(",\"id\":");
+            number(out, span.trace);
+            out.append("}");
+        }
+        out.append("]}");
+    }
+
+    /// Perfetto protobuf trace: a track per thread, slice begin/end events with trace id as flow id
+    static void writePerfetto(const Dump &dump, std::string &out) {
+        constexpr uint64_t TRACK_BASE = 1000;
+        constexpr uint32_t SEQUENCE = 1;
+        std::string packet, message, nested;
+
+        // first packet clears incremental state of sequence, otherwise readers skip its track events
+        packet.clear();
+        varintField(packet, 10, SEQUENCE);
+        varintField(packet, 13, 1); // sequence_flags = SEQ_INCREMENTAL_STATE_CLEARED
+        bytesField(out, 1, packet);
+
+        for (auto &thread: dump.threads) {
+            // TrackDescriptor{uuid = 1, thread = 4 {pid = 1, tid = 2, thread_name = 5}}
+            nested.clear();
+            varintField(nested, 1, 1);
+            varintField(nested, 2, thread.tid);
+            bytesField(nested, 5, thread.name);
+            message.clear();
+            varintField(message, 1, TRACK_BASE + thread.tid);
+            bytesField(message, 4, nested);
+            packet.clear();
+            varintField(packet, 10, SEQUENCE);
+            bytesField(packet, 60, message);
+            bytesField(out, 1, packet);
+        }
+
+        auto flows = flowSteps(dump);
+        for (size_t i = 0; i < dump.spans.size(); ++i) {
+            const auto &span = dump.spans[i];
+            const uint64_t track = TRACK_BASE + dump.threads[span.thread].tid;
+            for (int end = 0; end < 2; ++end) {
+                // TrackEvent{type = 9, track_uuid = 11, name = 23, flow_ids = 47, terminating_flow_ids = 48}
+                message.clear();
+                varintField(message, 9, end ? 2 : 1);
+                varintField(message, 11, track);
+                if (!end) {
+                    bytesField(message, 23, span.name);
+                    if (flows[i] == Flow::Start || flows[i] == Flow::Step)
+                        fixed64Field(message, 47, span.trace);
+                    else if (flows[i] == Flow::Finish)
+                        fixed64Field(message, 48, span.trace);
+                }
+                // TracePacket{timestamp = 8, trusted_packet_sequence_id = 10, track_event = 11}
+                packet.clear();
+                varintField(packet, 8, static_cast<uint64_t>(std::max(end ? span.end : span.begin, 0LL)) * 1000);
+                varintField(packet, 10, SEQUENCE);
+                bytesField(packet, 11, message);
+                bytesField(out, 1, packet);
+            }
+        }
+    }
+
+  private:
+    struct Slot {
+        std::atomic<uint64_t> trace{0};
+        std::atomic<const char *> name{""};
+        std::atomic<long long> begin{0};
+        std::atomic<long long> end{0};
+        std::atomic<long long> arg{0};
+    };
+
+    struct alignas(64) Ring {
+        std::atomic<uint64_t> head{0};
+        std::array<Slot, RING_SIZE> slots;
+        uint32_t tid = 0;
+        std::string name;
+    };
+
+    enum class Flow { None, Start, Step, Finish };
+
+    // position of every span in its trace, single span traces have no flow
+    static std::vector<Flow> flowSteps(const Dump &dump) {
+        std::map<uint64_t, std::pair<size_t, size_t>> bounds; // trace -> first and last span
+        for (size_t i = 0; i < dump.spans.size(); ++i) {
+            auto [it, inserted] = bounds.try_emplace(dump.spans[i].trace, i, i);
+            if (!inserted)
+                it->second.second = i;
+        }
+        std::vector<Flow> res(dump.spans.size(), Flow::None);
+        for (size_t i = 0; i < dump.spans.size(); ++i) {
+            auto [first, last] = bounds[dump.spans[i].trace];
+            if (first == last)
+                continue;
+            res[i] = i == first ? Flow::Start : i == last ? Flow::Finish : Flow::Step;
+        }
+        return res;
+    }
+
+    template <typename T>
+    static void number(std::string &out, T value) {
+        char buffer[24];
+        auto res = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, res.ptr - buffer);
+    }
+
+    static void string(std::string &out, std::string_view value) {
+        out.push_back('"');
+        for (char c: value) {
+            if (c == '"' || c == '\\') {
+                out.push_back('\\');
+                out.push_back(c);
+            } else if (static_cast<unsigned char>(c) >= 0x20) {
+                out.push_back(c);
+            }
+        }
+        out.push_back('"');
+    }
+
+    static void varint(std::string &out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    static void varintField(std::string &out, uint32_t field, uint64_t value) {
+        varint(out, field << 3);
+        varint(out, value);
+    }
+
+    static void fixed64Field(std::string &out, uint32_t field, uint64_t value) {
+        varint(out, (field << 3) | 1);
+        for (int i = 0; i < 8; ++i)
+            out.push_back(static_cast<char>(value >> (i * 8)));
+    }
+
+    static void bytesField(std::string &out, uint32_t field, std::string_view value) {
+        varint(out, (field << 3) | 2);
+        varint(out, value.size());
+        out.append(value);
+    }
+
+    std::atomic<unsigned int> sampleRate{0};
+    std::atomic<uint64_t> lastTrace{0};
+
+    ThreadShards<Ring> rings;
+};
+
+#endif //CHATCONTROLLER_COMMON_TRACEBUFFER_H_
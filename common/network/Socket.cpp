@@ -61,7 +61,7 @@ void Socket::create(HANDLE fd) {
 
 void Socket::close() {
     // Close the socket
-    if (sock == INVALID_SOCKET) {
+    if (sock != INVALID_SOCKET) {
         ::close(sock);
         sock = INVALID_SOCKET;
     }
@@ -145,5 +145,6 @@ std::string Socket::getAddress(const struct sockaddr *sa) {
             break;
         default:res.clear();
     }
+    res.resize(std::strlen(res.c_str()));
     return res;
 }
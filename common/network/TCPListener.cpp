@@ -22,6 +22,10 @@ Socket::Status TCPListener::listen(const std::string &address, unsigned short po
     if ((address.empty()))
         return Error;
 
+    // Allow fast restart while old connections are in TIME_WAIT
+    int yes = 1;
+    setsockopt(getHandle(), SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char *>(&yes), sizeof(yes));
+
     // Bind the socket to the specified port
     sockaddr_in addr = Socket::createAddress(address, port);
     if (bind(getHandle(), reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1) {
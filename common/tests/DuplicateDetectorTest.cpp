@@ -0,0 +1,171 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+#include "../../DuplicateDetector.h"
+#include <gtest/gtest.h>
+
+static uint128_t makeId(uint64_t value) {
+    return {value, 0};
+}
+
+static DuplicateDetectorConfig makeConfig() {
+    DuplicateDetectorConfig config;
+    config.minTextLength = 8;
+    config.windowSize = 4;
+    config.windowTime = 1000;
+    config.maxDistance = 3;
+    return config;
+}
+
+//-----------------------------------------------------------------------------
+TEST(Fingerprint, Normalization) {
+    auto print = DuplicateDetector::fingerprint("This is a copypasta text");
+    EXPECT_EQ(DuplicateDetector::fingerprint("this IS a   copypasta\ttext"), print);
+    EXPECT_EQ(DuplicateDetector::fingerprint("  This is a copypasta text"), print);
+    EXPECT_EQ(DuplicateDetector::distance(print, print), 0);
+    EXPECT_EQ(DuplicateDetector::distance(0, ~uint64_t{0}), 64);
+}
+
+TEST(Fingerprint, Distance) {
+    const std::string text = "HAHAHA look at this streamer playing with mouse upside down LUL LUL LUL";
+    auto print = DuplicateDetector::fingerprint(text);
+
+    // small edits of long text keep SimHash close, unrelated texts are around half of bits away
+    EXPECT_LE(DuplicateDetector::distance(print, DuplicateDetector::fingerprint(text + "!")), 8);
+    EXPECT_LE(DuplicateDetector::distance(print, DuplicateDetector::fingerprint("HAHAHA look at this streamer "
+                                                                                "playing with mouse upside down LUL LUL")), 12);
+    EXPECT_GT(DuplicateDetector::distance(print, DuplicateDetector::fingerprint("does anyone know what game is next?")), 20);
+}
+
+TEST(Detector, ExactAndSimilar) {
+    DuplicateDetector detector(makeConfig());
+    const std::string text = "HAHAHA look at this streamer playing with mouse upside down LUL LUL LUL";
+
+    auto res = detector.check("chan", makeId(1), text, 0);
+    EXPECT_EQ(res.dupOf, makeId(0));
+    EXPECT_FALSE(res.exact);
+
+    res = detector.check("chan", makeId(2), text, 10);
+    EXPECT_EQ(res.dupOf, makeId(1));
+    EXPECT_TRUE(res.exact);
+
+    // normalized text is a near duplicate, not exact one: stored text differs
+    std::string upper = text;
+    for (auto &c: upper)
+        c = static_cast<char>(std::toupper(c));
+    res = detector.check("chan", makeId(3), upper, 20);
+    EXPECT_EQ(res.dupOf, makeId(1));
+    EXPECT_FALSE(res.exact);
+
+    // other channels have own window
+    res = detector.check("other", makeId(4), text, 30);
+    EXPECT_EQ(res.dupOf, makeId(0));
+
+    // short texts are not checked at all
+    EXPECT_EQ(detector.check("chan", makeId(5), "!join", 40).dupOf, makeId(0));
+    EXPECT_EQ(detector.check("chan", makeId(6), "!join", 50).dupOf, makeId(0));
+
+    auto stats = detector.collectStats();
+    EXPECT_EQ(stats.checked, 4u);
+    EXPECT_EQ(stats.duplicates, 2u);
+    EXPECT_EQ(stats.exact, 1u);
+    EXPECT_EQ(detector.collectStats().checked, 0u);
+}
+
+TEST(Detector, Threshold) {
+    const std::string text = "HAHAHA look at this streamer playing with mouse upside down LUL LUL LUL";
+    const std::string edited = text + " KEKW";
+    int distance = DuplicateDetector::distance(DuplicateDetector::fingerprint(text),
+                                               DuplicateDetector::fingerprint(edited));
+    ASSERT_GT(distance, 0);
+
+    auto config = makeConfig();
+    config.maxDistance = distance;
+    DuplicateDetector loose(config);
+    loose.check("chan", makeId(1), text, 0);
+    EXPECT_EQ(loose.check("chan", makeId(2), edited, 0).dupOf, makeId(1));
+
+    config.maxDistance = distance - 1;
+    DuplicateDetector strict(config);
+    strict.check("chan", makeId(1), text, 0);
+    EXPECT_EQ(strict.check("chan", makeId(2), edited, 0).dupOf, makeId(0));
+}
+
+TEST(Detector, DefaultCatchesEdit) {
+    DuplicateDetector detector(DuplicateDetectorConfig{});
+    const std::string text = "if you are reading this you are a legend, do not scroll up to check";
+    detector.check("chan", makeId(1), text, 0);
+
+    // typo, extra and missing character of copypasta are caught by default distance
+    std::string typo = text;
+    typo[20] = 'x';
+    std::string extra = text + "!";
+    std::string missing = text.substr(1);
+    EXPECT_EQ(detector.check("chan", makeId(2), typo, 10).dupOf, makeId(1));
+    EXPECT_EQ(detector.check("chan", makeId(3), extra, 20).dupOf, makeId(1));
+    EXPECT_EQ(detector.check("chan", makeId(4), missing, 30).dupOf, makeId(1));
+
+    // different copypasta is not
+    EXPECT_EQ(detector.check("chan", makeId(5), "this chat is so fast nobody will notice that I love pineapple pizza",
+                             40).dupOf, makeId(0));
+}
+
+TEST(Detector, WindowEviction) {
+    DuplicateDetector detector(makeConfig()); // 4 entries, 1000 ms
+    const std::vector<std::string> texts = {
+        "first completely different message",
+        "second one talks about the weather",
+        "third asks when the stream starts",
+        "fourth is about favourite pizza",
+        "fifth message pushes the first out",
+    };
+    for (size_t i = 0; i < texts.size(); ++i)
+        EXPECT_EQ(detector.check("chan", makeId(i + 1), texts[i], 0).dupOf, makeId(0));
+
+    // the oldest original is evicted by size, newer ones are still there
+    EXPECT_EQ(detector.check("chan", makeId(10), texts[0], 0).dupOf, makeId(0));
+    EXPECT_EQ(detector.check("chan", makeId(11), texts[4], 0).dupOf, makeId(5));
+
+    // match refreshes original, the rest expire by time
+    EXPECT_EQ(detector.check("chan", makeId(12), texts[4], 900).dupOf, makeId(5));
+    EXPECT_EQ(detector.check("chan", makeId(13), texts[4], 1800).dupOf, makeId(5));
+    EXPECT_EQ(detector.check("chan", makeId(14), texts[2], 1800).dupOf, makeId(0));
+    EXPECT_EQ(detector.check("chan", makeId(15), texts[4], 5000).dupOf, makeId(0));
+}
+
+TEST(Detector, RefreshedOriginalOutlivesOthers) {
+    DuplicateDetector detector(makeConfig()); // 4 entries, 1000 ms
+    const std::string wave = "first completely different message";
+    detector.check("chan", makeId(1), wave, 0);
+    detector.check("chan", makeId(2), "second one talks about the weather", 100);
+    detector.check("chan", makeId(3), "third asks when the stream starts", 200);
+
+    // match moves original to the back, size eviction takes the oldest one of the others
+    EXPECT_EQ(detector.check("chan", makeId(4), wave, 300).dupOf, makeId(1));
+    detector.check("chan", makeId(5), "fourth is about favourite pizza", 400);
+    detector.check("chan", makeId(6), "fifth message pushes the second out", 500);
+    EXPECT_EQ(detector.check("chan", makeId(7), "second one talks about the weather", 600).dupOf, makeId(0));
+    EXPECT_EQ(detector.check("chan", makeId(8), wave, 600).dupOf, makeId(1));
+
+    // refreshed original is not hidden behind expired front entries
+    EXPECT_EQ(detector.check("chan", makeId(9), wave, 1500).dupOf, makeId(1));
+}
+
+TEST(Detector, IdleChannelsDropped) {
+    DuplicateDetector detector(makeConfig()); // 1000 ms
+    for (int i = 0; i < 100; ++i)
+        detector.check("chan" + std::to_string(i), makeId(i + 1), "first completely different message", 0);
+    EXPECT_EQ(detector.channelsCount(), 100u);
+
+    // windows of channels without messages for window time are dropped by the next sweep of their shard
+    for (int i = 0; i < 100; ++i)
+        detector.check("late" + std::to_string(i), makeId(1000 + i), "second one talks about the weather", 2000);
+    EXPECT_EQ(detector.channelsCount(), 100u);
+    EXPECT_EQ(detector.check("late0", makeId(2000), "second one talks about the weather", 2100).dupOf, makeId(1000));
+    EXPECT_EQ(detector.check("chan0", makeId(2001), "first completely different message", 2100).dupOf, makeId(0));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
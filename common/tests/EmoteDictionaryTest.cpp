@@ -0,0 +1,50 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+#include "../../EmoteDictionary.h"
+#include <gtest/gtest.h>
+
+using Ids = std::vector<std::string>;
+
+//-----------------------------------------------------------------------------
+TEST(Basic, Extract) {
+    EmoteDictionary dictionary({{"Kappa", "25"}, {"PogChamp", "305954156"}, {"LUL", "425618"}});
+    EXPECT_EQ(dictionary.size(), 3u);
+    ASSERT_NE(dictionary.find("Kappa"), nullptr);
+    EXPECT_EQ(*dictionary.find("Kappa"), "25");
+    EXPECT_EQ(dictionary.find("kappa"), nullptr);
+    EXPECT_EQ(dictionary.extract("LUL that was Kappa PogChamp LUL"), (Ids{"425618", "25", "305954156", "425618"}));
+    EXPECT_TRUE(dictionary.extract("Kappa, KappaKappa").empty()); // emotes are whole words, like twitch renders them
+    EXPECT_TRUE(dictionary.extract("nothing here").empty());
+}
+
+TEST(Tag, Order) {
+    // single emote, several emotes and several ranges are sorted by position in text
+    EXPECT_EQ(EmoteDictionary::fromTag("25:0-4"), (Ids{"25"}));
+    EXPECT_EQ(EmoteDictionary::fromTag("25:0-4,12-16/1902:6-10"), (Ids{"25", "1902", "25"}));
+    EXPECT_EQ(EmoteDictionary::fromTag("1902:6-10/25:12-16,0-4"), (Ids{"25", "1902", "25"}));
+    EXPECT_EQ(EmoteDictionary::fromTag("emotesv2_abc:20-24/25:0-4"), (Ids{"25", "emotesv2_abc"}));
+    EXPECT_TRUE(EmoteDictionary::fromTag("").empty());
+}
+
+TEST(Tag, Malformed) {
+    EXPECT_TRUE(EmoteDictionary::fromTag("25").empty());          // no ranges
+    EXPECT_TRUE(EmoteDictionary::fromTag("25:").empty());
+    EXPECT_TRUE(EmoteDictionary::fromTag(":0-4").empty());        // no id
+    EXPECT_TRUE(EmoteDictionary::fromTag("25:abc").empty());
+    EXPECT_TRUE(EmoteDictionary::fromTag("25:4").empty());        // no end
+    EXPECT_TRUE(EmoteDictionary::fromTag("25:4-").empty());
+    EXPECT_TRUE(EmoteDictionary::fromTag("25:-1-3").empty());     // negative
+    EXPECT_TRUE(EmoteDictionary::fromTag("25:8-4").empty());      // end before start
+    EXPECT_TRUE(EmoteDictionary::fromTag("25:0-4x").empty());     // trailing garbage
+    EXPECT_TRUE(EmoteDictionary::fromTag("25:99999999999-99999999999").empty()); // overflow
+    EXPECT_TRUE(EmoteDictionary::fromTag("///").empty());
+
+    // broken parts are skipped, valid ones are kept
+    EXPECT_EQ(EmoteDictionary::fromTag("25:0-4,,x-y,12-16//:1-2/1902:6-10/"), (Ids{"25", "1902", "25"}));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
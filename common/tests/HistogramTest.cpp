@@ -0,0 +1,57 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+#include "../Histogram.h"
+#include <gtest/gtest.h>
+
+//-----------------------------------------------------------------------------
+TEST(Basic, BucketBounds) {
+    for (uint64_t value : std::initializer_list<uint64_t>{0, 1, 15, 16, 17, 31, 32, 1000, 123456789, Histogram::MAX_VALUE}) {
+        int index = Histogram::bucketIndex(value);
+        ASSERT_LT(index, Histogram::BUCKETS);
+        EXPECT_LE(Histogram::bucketLowerBound(index), value);
+        EXPECT_GE(Histogram::bucketUpperBound(index), value);
+    }
+    EXPECT_EQ(Histogram::bucketIndex(Histogram::MAX_VALUE), Histogram::BUCKETS - 1);
+}
+
+//-----------------------------------------------------------------------------
+TEST(Basic, Percentiles) {
+    Histogram hist;
+    EXPECT_EQ(hist.percentile(50), 0);
+
+    for (uint64_t i = 1; i <= 1000; ++i)
+        hist.record(i);
+
+    EXPECT_EQ(hist.count(), 1000);
+    EXPECT_EQ(hist.min(), 1);
+    EXPECT_EQ(hist.max(), 1000);
+    EXPECT_EQ(hist.mean(), 500);
+    EXPECT_NEAR(hist.percentile(50), 500, 500 / 16);
+    EXPECT_NEAR(hist.percentile(99), 990, 990 / 16);
+    EXPECT_EQ(hist.percentile(100), 1000);
+}
+
+//-----------------------------------------------------------------------------
+TEST(Basic, Merge) {
+    Histogram first, second;
+    first.record(10, 5);
+    second.record(1000, 5);
+
+    first.merge(second);
+    EXPECT_EQ(first.count(), 10);
+    EXPECT_EQ(first.min(), 10);
+    EXPECT_EQ(first.max(), 1000);
+    EXPECT_EQ(first.percentile(50), 10);
+    EXPECT_NEAR(first.percentile(90), 1000, 1000 / 16);
+
+    first.clear();
+    EXPECT_EQ(first.count(), 0);
+    EXPECT_EQ(first.min(), 0);
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
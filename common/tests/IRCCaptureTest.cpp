@@ -0,0 +1,209 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+#include "../../irc/IRCCapture.h"
+#include "../../irc/IRCCaptureReader.h"
+#include "../Logger.h"
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "spdlog/sinks/ostream_sink.h"
+
+// keeps log lines to check errors
+class CaptureLogger : public Logger
+{
+  public:
+    CaptureLogger() {
+        logger = std::make_shared<spdlog::logger>("capture_test", std::make_shared<spdlog::sinks::ostream_sink_mt>(out));
+    }
+    std::string text() {
+        logger->flush();
+        return out.str();
+    }
+  private:
+    std::ostringstream out;
+};
+
+struct Written {
+    std::string session;
+    std::string line;
+};
+
+static IRCCaptureConfig makeConfig() {
+    IRCCaptureConfig config;
+    config.path = (std::filesystem::temp_directory_path() / "irc_capture_test").string();
+    config.segments = 0;
+    std::filesystem::remove_all(config.path);
+    return config;
+}
+
+static std::string randomLine(std::mt19937 &random, size_t size) {
+    std::string line = "PRIVMSG #channel :";
+    while (line.size() < size)
+        line.push_back(static_cast<char>('a' + random() % 26));
+    return line;
+}
+
+static std::vector<Written> readAll(IRCCaptureReader &reader) {
+    std::vector<Written> res;
+    IRCCaptureRecord record;
+    long long time = 0;
+    while (reader.next(record)) {
+        EXPECT_GE(record.time, time);
+        time = record.time;
+        res.push_back(Written{std::string(record.session), std::string(record.line)});
+    }
+    return res;
+}
+
+//-----------------------------------------------------------------------------
+TEST(Capture, RoundTrip) {
+    auto config = makeConfig();
+    auto logger = std::make_shared<CaptureLogger>();
+    std::vector<Written> written;
+    {
+        IRCCapture capture(config, logger);
+        ASSERT_TRUE(capture.start());
+        auto alpha = capture.addSession("alpha");
+        auto beta = capture.addSession("beta");
+        for (int i = 0; i < 100; ++i) {
+            const char *name = i % 3 ? "alpha" : "beta";
+            written.push_back(Written{name, ":nick!nick@host PRIVMSG #channel :message " + std::to_string(i)});
+            capture.write(i % 3 ? alpha : beta, written.back().line);
+        }
+        capture.stop();
+        EXPECT_EQ(capture.getStats().lines, written.size());
+        EXPECT_EQ(capture.getStats().dropped, 0u);
+    }
+
+    IRCCaptureReader reader(config.path);
+    ASSERT_EQ(reader.segments().size(), 1u);
+    auto records = readAll(reader);
+    ASSERT_EQ(records.size(), written.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(records[i].session, written[i].session);
+        EXPECT_EQ(records[i].line, written[i].line);
+    }
+    EXPECT_TRUE(reader.error().empty());
+    EXPECT_EQ(logger->text().find("Failed"), std::string::npos);
+}
+
+TEST(Capture, SessionsRepeatedAfterRotation) {
+    auto config = makeConfig();
+    config.segmentSize = 1; // every written block closes segment
+    std::vector<Written> written;
+    {
+        IRCCapture capture(config, std::make_shared<CaptureLogger>());
+        ASSERT_TRUE(capture.start());
+        auto alpha = capture.addSession("alpha");
+        auto beta = capture.addSession("beta");
+        for (int batch = 0; batch < 5; ++batch) {
+            written.push_back(Written{"alpha", "PRIVMSG #a :batch " + std::to_string(batch)});
+            capture.write(alpha, written.back().line);
+            written.push_back(Written{"beta", "PRIVMSG #b :batch " + std::to_string(batch)});
+            capture.write(beta, written.back().line);
+            // let writer drain the batch, so next one goes to new segment
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        capture.stop();
+    }
+
+    IRCCaptureReader reader(config.path);
+    ASSERT_GE(reader.segments().size(), 2u);
+    auto records = readAll(reader);
+    ASSERT_EQ(records.size(), written.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(records[i].session, written[i].session);
+        EXPECT_EQ(records[i].line, written[i].line);
+    }
+
+    // every segment is readable on its own, sessions are declared again
+    size_t withLines = 0;
+    for (auto &file: reader.segments()) {
+        IRCCaptureReader single(file);
+        auto part = readAll(single);
+        for (auto &record: part)
+            EXPECT_FALSE(record.session.empty()) << file;
+        withLines += !part.empty();
+    }
+    EXPECT_GE(withLines, 2u);
+}
+
+TEST(Capture, TruncatedLastSegment) {
+    auto config = makeConfig();
+    std::vector<std::string> written;
+    {
+        IRCCapture capture(config, std::make_shared<CaptureLogger>());
+        ASSERT_TRUE(capture.start());
+        auto session = capture.addSession("alpha");
+        // several LZ4 blocks, so a cut in the middle leaves complete blocks before it
+        std::mt19937 random(42);
+        for (int i = 0; i < 2000; ++i) {
+            written.push_back(randomLine(random, 600));
+            capture.write(session, written.back());
+        }
+        capture.stop();
+    }
+
+    // writer killed in the middle of segment: no frame end and half of data
+    IRCCaptureReader full(config.path);
+    ASSERT_EQ(full.segments().size(), 1u);
+    const auto &file = full.segments().front();
+    std::filesystem::resize_file(file, std::filesystem::file_size(file) / 2);
+
+    IRCCaptureReader reader(config.path);
+    auto records = readAll(reader);
+    EXPECT_GT(records.size(), 0u);
+    EXPECT_LT(records.size(), written.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(records[i].session, "alpha");
+        ASSERT_EQ(records[i].line, written[i]);
+    }
+    // truncated tail is expected, not an error
+    EXPECT_TRUE(reader.error().empty()) << reader.error();
+}
+
+TEST(Capture, ViewsValidUntilNext) {
+    auto config = makeConfig();
+    std::vector<Written> written;
+    {
+        IRCCapture capture(config, std::make_shared<CaptureLogger>());
+        ASSERT_TRUE(capture.start());
+        auto alpha = capture.addSession("alpha");
+        auto beta = capture.addSession("beta");
+        // lines bigger than decompression chunk make reader grow and shift its buffer
+        std::mt19937 random(7);
+        for (size_t size: {20, 300000, 20, 600000, 20}) {
+            bool first = written.size() % 2 == 0;
+            written.push_back(Written{first ? "alpha" : "beta", randomLine(random, size)});
+            capture.write(first ? alpha : beta, written.back().line);
+        }
+        capture.stop();
+    }
+
+    IRCCaptureReader reader(config.path);
+    IRCCaptureRecord record;
+    size_t count = 0;
+    while (reader.next(record)) {
+        ASSERT_LT(count, written.size());
+        // views are checked right before the next call invalidates them
+        std::string_view session = record.session;
+        std::string_view line = record.line;
+        EXPECT_EQ(session, written[count].session);
+        EXPECT_EQ(line.size(), written[count].line.size());
+        EXPECT_TRUE(line == written[count].line);
+        ++count;
+    }
+    EXPECT_EQ(count, written.size());
+    EXPECT_TRUE(reader.error().empty()) << reader.error();
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
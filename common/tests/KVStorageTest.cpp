@@ -0,0 +1,175 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+#include "../../db/kv/KVStorage.h"
+#include "../Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "spdlog/sinks/ostream_sink.h"
+
+// keeps log lines to check warnings
+class CaptureLogger : public Logger
+{
+  public:
+    CaptureLogger() {
+        logger = std::make_shared<spdlog::logger>("kv_test", std::make_shared<spdlog::sinks::ostream_sink_st>(out));
+    }
+    std::string text() {
+        logger->flush();
+        return out.str();
+    }
+  private:
+    std::ostringstream out;
+};
+
+static KVStorageConfig makeConfig() {
+    KVStorageConfig config;
+    config.path = (std::filesystem::temp_directory_path() / "kv_storage_test").string();
+    config.shards = 4;
+    std::filesystem::remove_all(config.path);
+    return config;
+}
+
+//-----------------------------------------------------------------------------
+TEST(Basic, Replay) {
+    auto config = makeConfig();
+    {
+        KVStorage kv(config, std::make_shared<CaptureLogger>());
+        ASSERT_TRUE(kv.open());
+        kv.set(1, "name", "value");
+        kv.set(2, "name", "other");
+        EXPECT_EQ(kv.incr(1, "counter", 5), 5);
+        EXPECT_EQ(kv.incr(1, "counter"), 6);
+        kv.set(1, "removed", "x");
+        EXPECT_TRUE(kv.remove(1, "removed"));
+        EXPECT_EQ(kv.incr(1, "name"), std::nullopt); // not an integer
+    } // WAL is closed without snapshot
+
+    KVStorage kv(config, std::make_shared<CaptureLogger>());
+    ASSERT_TRUE(kv.open());
+    EXPECT_EQ(kv.get(1, "name"), "value");
+    EXPECT_EQ(kv.get(2, "name"), "other");
+    EXPECT_EQ(kv.get(1, "counter"), "6");
+    EXPECT_EQ(kv.get(1, "removed"), std::nullopt);
+    EXPECT_EQ(kv.getStats().keys, 3u);
+    // open() compacts everything to snapshot
+    EXPECT_TRUE(std::filesystem::exists(std::filesystem::path(config.path) / "snapshot.kv"));
+    EXPECT_EQ(std::filesystem::file_size(std::filesystem::path(config.path) / "wal.kv"), 0u);
+}
+
+TEST(Basic, Rotation) {
+    auto config = makeConfig();
+    const auto dir = std::filesystem::path(config.path);
+    {
+        KVStorage kv(config, std::make_shared<CaptureLogger>());
+        ASSERT_TRUE(kv.open());
+        kv.set(1, "before", "1");
+        ASSERT_TRUE(kv.snapshot());
+        EXPECT_FALSE(std::filesystem::exists(dir / "wal.kv.1"));
+        kv.set(1, "after", "2");
+        kv.remove(1, "before");
+    }
+    {
+        KVStorage kv(config, std::make_shared<CaptureLogger>());
+        ASSERT_TRUE(kv.open());
+        EXPECT_EQ(kv.get(1, "before"), std::nullopt);
+        EXPECT_EQ(kv.get(1, "after"), "2");
+        kv.set(1, "interrupted", "3");
+    }
+
+    // snapshot interrupted after rotation leaves rotated WAL, it is replayed before current one
+    std::filesystem::rename(dir / "wal.kv", dir / "wal.kv.1");
+    {
+        KVStorage kv(config, std::make_shared<CaptureLogger>());
+        ASSERT_TRUE(kv.open());
+        EXPECT_EQ(kv.get(1, "interrupted"), "3");
+        EXPECT_EQ(kv.get(1, "after"), "2");
+        EXPECT_FALSE(std::filesystem::exists(dir / "wal.kv.1"));
+    }
+}
+
+TEST(Basic, TornTail) {
+    auto config = makeConfig();
+    const auto wal = (std::filesystem::path(config.path) / "wal.kv").string();
+    {
+        KVStorage kv(config, std::make_shared<CaptureLogger>());
+        ASSERT_TRUE(kv.open());
+        kv.set(1, "first", "1");
+        kv.set(1, "second", "2");
+    }
+    // crash in the middle of record: op, key size and half of key
+    auto size = std::filesystem::file_size(wal);
+    std::filesystem::resize_file(wal, size - 3);
+
+    auto logger = std::make_shared<CaptureLogger>();
+    KVStorage kv(config, logger);
+    ASSERT_TRUE(kv.open());
+    EXPECT_EQ(kv.get(1, "first"), "1");
+    EXPECT_EQ(kv.get(1, "second"), std::nullopt);
+    EXPECT_NE(logger->text().find("is truncated after 1 records"), std::string::npos);
+
+    // clean files don't warn
+    auto clean = std::make_shared<CaptureLogger>();
+    {
+        KVStorage other(config, clean);
+        ASSERT_TRUE(other.open());
+    }
+    EXPECT_EQ(clean->text().find("truncated"), std::string::npos);
+}
+
+TEST(Basic, CorruptSize) {
+    auto config = makeConfig();
+    const auto wal = (std::filesystem::path(config.path) / "wal.kv").string();
+    {
+        KVStorage kv(config, std::make_shared<CaptureLogger>());
+        ASSERT_TRUE(kv.open());
+        kv.set(1, "first", "1");
+    }
+    // garbage record with key size far past end of file must not be allocated
+    std::FILE *file = std::fopen(wal.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    int op = std::fgetc(file);
+    std::fseek(file, 0, SEEK_END);
+    const uint32_t huge = UINT32_MAX;
+    std::fputc(op, file);
+    std::fwrite(&huge, sizeof(huge), 1, file);
+    std::fwrite("key", 1, 3, file);
+    std::fclose(file);
+
+    auto logger = std::make_shared<CaptureLogger>();
+    KVStorage kv(config, logger);
+    ASSERT_TRUE(kv.open());
+    EXPECT_EQ(kv.get(1, "first"), "1");
+    EXPECT_EQ(kv.getStats().keys, 1u);
+    EXPECT_NE(logger->text().find("is truncated after 1 records"), std::string::npos);
+}
+
+TEST(Basic, TtlOnReplay) {
+    auto config = makeConfig();
+    {
+        KVStorage kv(config, std::make_shared<CaptureLogger>());
+        ASSERT_TRUE(kv.open());
+        kv.set(1, "short", "1", 50);
+        kv.set(1, "long", "2", 60000);
+        EXPECT_EQ(kv.incr(1, "cooldown", 1, 50), 1);
+        EXPECT_EQ(kv.get(1, "short"), "1");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    KVStorage kv(config, std::make_shared<CaptureLogger>());
+    ASSERT_TRUE(kv.open());
+    EXPECT_EQ(kv.get(1, "short"), std::nullopt);
+    EXPECT_EQ(kv.get(1, "cooldown"), std::nullopt);
+    EXPECT_EQ(kv.get(1, "long"), "2");
+    EXPECT_EQ(kv.getStats().keys, 1u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
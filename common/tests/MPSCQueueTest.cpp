@@ -0,0 +1,77 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+#include "../MPSCQueue.h"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+TEST(Basic, Fifo) {
+    MPSCQueue<std::string> queue;
+    std::string value;
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.pop(value));
+
+    queue.push("first");
+    queue.push("second");
+    EXPECT_FALSE(queue.empty());
+
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, "first");
+    queue.push("third");
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, "second");
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, "third");
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+//-----------------------------------------------------------------------------
+TEST(Basic, DestroyNotEmpty) {
+    MPSCQueue<std::string> queue;
+    for (int i = 0; i < 100; ++i)
+        queue.push(std::string(64, 'a'));
+}
+
+//-----------------------------------------------------------------------------
+TEST(Concurrency, ProducersOrder) {
+    constexpr int PRODUCERS = 4;
+    constexpr int COUNT = 100000;
+
+    MPSCQueue<std::pair<int, int>> queue;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < COUNT; ++i)
+                queue.push({p, i});
+        });
+    }
+
+    // order is kept per producer
+    std::vector<int> expected(PRODUCERS, 0);
+    std::pair<int, int> value;
+    int received = 0;
+    while (received < PRODUCERS * COUNT) {
+        if (!queue.pop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(value.second, expected[value.first]);
+        ++expected[value.first];
+        ++received;
+    }
+
+    for (auto &producer: producers)
+        producer.join();
+    EXPECT_FALSE(queue.pop(value));
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
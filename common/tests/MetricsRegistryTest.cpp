@@ -0,0 +1,91 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+#include "../MetricsRegistry.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::map<std::string, uint64_t> countersOf(MetricsRegistry &registry) {
+    std::map<std::string, uint64_t> res;
+    for (auto &[id, value]: registry.collect().counters)
+        res[registry.counterName(id)] += value;
+    return res;
+}
+
+//-----------------------------------------------------------------------------
+TEST(Counters, InternAndCollect) {
+    MetricsRegistry registry;
+    auto a = registry.counter("alpha");
+    EXPECT_EQ(registry.counter("alpha"), a);
+    EXPECT_NE(registry.counter("beta"), a);
+    EXPECT_EQ(registry.counterName(a), "alpha");
+
+    registry.add(a, 3);
+    registry.add("alpha");
+    registry.add("gamma", 5);
+
+    auto counters = countersOf(registry);
+    EXPECT_EQ(counters.size(), 2u); // beta was not touched
+    EXPECT_EQ(counters["alpha"], 4u);
+    EXPECT_EQ(counters["gamma"], 5u);
+
+    // collect takes values, next one starts from zero
+    EXPECT_TRUE(countersOf(registry).empty());
+    registry.add("gamma");
+    EXPECT_EQ(countersOf(registry)["gamma"], 1u);
+}
+
+TEST(Counters, ManyIds) {
+    MetricsRegistry registry;
+    const size_t count = MetricsRegistry::CHUNK_SIZE * 2 + 10;
+    for (size_t i = 0; i < count; ++i)
+        registry.add("channel" + std::to_string(i), i + 1);
+
+    auto snapshot = registry.collect();
+    ASSERT_EQ(snapshot.counters.size(), count);
+    for (auto &[id, value]: snapshot.counters)
+        EXPECT_EQ(registry.counterName(id), "channel" + std::to_string(value - 1));
+}
+
+TEST(Counters, Threads) {
+    MetricsRegistry registry;
+    const int threads = 8;
+    const int iterations = 100000;
+
+    std::atomic_bool done = false;
+    uint64_t collected = 0;
+    std::thread collector([&] {
+        // concurrent collects must not lose increments
+        while (!done.load()) {
+            for (auto &[id, value]: registry.collect().counters)
+                collected += value;
+        }
+    });
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([&registry, t] {
+            for (int i = 0; i < iterations; ++i)
+                registry.add(i % 2 ? "even" : "odd");
+            registry.add("thread" + std::to_string(t));
+        });
+    }
+    for (auto &thread: producers)
+        thread.join();
+    done = true;
+    collector.join();
+
+    for (auto &[id, value]: registry.collect().counters)
+        collected += value;
+    EXPECT_EQ(collected, static_cast<uint64_t>(threads) * (iterations + 1));
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
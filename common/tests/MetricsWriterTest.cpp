@@ -0,0 +1,88 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+#include "../MetricsWriter.h"
+#include <gtest/gtest.h>
+
+#include <string>
+
+//-----------------------------------------------------------------------------
+TEST(Samples, CounterAndGauge) {
+    std::string out;
+    MetricsWriter writer(out);
+    writer.family("irc_lines_total", "counter", "Inbound IRC lines");
+    writer.sample("irc_lines_total", {{"account", "bot"}, {"session", 3u}}, 42ull);
+    writer.family("queue_size", "gauge", "Queue size");
+    writer.sample("queue_size", {}, 0.5);
+    writer.sample("queue_size", {{"id", 12}}, -3);
+
+    EXPECT_EQ(out,
+              "# HELP irc_lines_total Inbound IRC lines\n"
+              "# TYPE irc_lines_total counter\n"
+              "irc_lines_total{account=\"bot\",session=\"3\"} 42\n"
+              "# HELP queue_size Queue size\n"
+              "# TYPE queue_size gauge\n"
+              "queue_size 0.5\n"
+              "queue_size{id=\"12\"} -3\n");
+}
+
+TEST(Samples, LabelEscaping) {
+    std::string out;
+    MetricsWriter writer(out);
+    writer.sample("m", {{"name", "a\"b\\c\nd"}}, 1u);
+    EXPECT_EQ(out, "m{name=\"a\\\"b\\\\c\\nd\"} 1\n");
+}
+
+TEST(Samples, BufferReuse) {
+    std::string out;
+    out.reserve(1024);
+    auto data = out.data();
+    for (int i = 0; i < 10; ++i) {
+        out.clear();
+        MetricsWriter writer(out);
+        writer.sample("metric_with_long_name_total", {{"label", 1234567890123ull}}, 1234567890123ull);
+    }
+    EXPECT_EQ(out.data(), data);
+}
+
+TEST(Histograms, Buckets) {
+    Histogram hist;
+    hist.record(0);
+    hist.record(1);
+    hist.record(3);
+    hist.record(100);
+
+    std::string out;
+    MetricsWriter writer(out);
+    writer.histogram("lat", {{"stage", "x"}}, hist, 3, 0.5);
+    EXPECT_EQ(out,
+              "lat_bucket{stage=\"x\",le=\"0.5\"} 1\n"
+              "lat_bucket{stage=\"x\",le=\"1\"} 2\n"
+              "lat_bucket{stage=\"x\",le=\"2\"} 3\n"
+              "lat_bucket{stage=\"x\",le=\"4\"} 3\n"
+              "lat_bucket{stage=\"x\",le=\"+Inf\"} 4\n"
+              "lat_sum{stage=\"x\"} 52\n"
+              "lat_count{stage=\"x\"} 4\n");
+}
+
+TEST(Histograms, CumulativeMatchesCount) {
+    Histogram hist;
+    for (uint64_t i = 0; i < 100000; i += 7)
+        hist.record(i);
+
+    std::string out;
+    MetricsWriter writer(out);
+    writer.histogram("h", {}, hist, 20);
+
+    // the last finite bucket covers every recorded value
+    auto pos = out.find("h_bucket{le=\"1048576\"} ");
+    ASSERT_NE(pos, std::string::npos);
+    auto value = std::stoull(out.substr(pos + std::string("h_bucket{le=\"1048576\"} ").size()));
+    EXPECT_EQ(value, hist.count());
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
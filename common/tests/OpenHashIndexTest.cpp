@@ -0,0 +1,78 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+#include "../OpenHashIndex.h"
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct KeyOf {
+    const std::vector<std::string> *keys;
+    std::string_view operator()(uint32_t id) const { return (*keys)[id]; }
+};
+
+//-----------------------------------------------------------------------------
+TEST(Basic, InsertFindErase) {
+    std::vector<std::string> keys{"alpha", "beta", "gamma"};
+    OpenHashIndex<KeyOf> index{KeyOf{&keys}};
+    EXPECT_EQ(index.find("alpha"), index.npos);
+    EXPECT_FALSE(index.erase("alpha"));
+
+    for (uint32_t i = 0; i < keys.size(); ++i)
+        EXPECT_TRUE(index.insert(i));
+    EXPECT_EQ(index.size(), 3u);
+    EXPECT_EQ(index.find("alpha"), 0u);
+    EXPECT_EQ(index.find("beta"), 1u);
+    EXPECT_EQ(index.find("gamma"), 2u);
+    EXPECT_EQ(index.find("delta"), index.npos);
+
+    keys.emplace_back("beta");
+    EXPECT_FALSE(index.insert(3)); // duplicated key
+
+    EXPECT_TRUE(index.erase("beta"));
+    EXPECT_FALSE(index.erase("beta"));
+    EXPECT_EQ(index.find("beta"), index.npos);
+    EXPECT_EQ(index.find("gamma"), 2u);
+    EXPECT_EQ(index.size(), 2u);
+
+    index.clear();
+    EXPECT_TRUE(index.empty());
+    EXPECT_EQ(index.find("alpha"), index.npos);
+}
+
+//-----------------------------------------------------------------------------
+TEST(Random, MatchesUnorderedMap) {
+    std::vector<std::string> keys;
+    for (int i = 0; i < 5000; ++i)
+        keys.push_back("channel_" + std::to_string(i));
+
+    OpenHashIndex<KeyOf> index{KeyOf{&keys}};
+    index.reserve(100);
+    std::unordered_map<std::string, uint32_t> expected;
+
+    // mixed inserts and erases keep long probe clusters, so backward shift is exercised
+    std::mt19937 random(7);
+    for (int step = 0; step < 200000; ++step) {
+        uint32_t id = random() % keys.size();
+        if (random() % 3) {
+            EXPECT_EQ(index.insert(id), expected.emplace(keys[id], id).second);
+        } else {
+            EXPECT_EQ(index.erase(keys[id]), expected.erase(keys[id]) == 1);
+        }
+    }
+
+    ASSERT_EQ(index.size(), expected.size());
+    for (uint32_t id = 0; id < keys.size(); ++id) {
+        auto it = expected.find(keys[id]);
+        EXPECT_EQ(index.find(keys[id]), it == expected.end() ? index.npos : it->second);
+    }
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
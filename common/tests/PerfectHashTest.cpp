@@ -0,0 +1,46 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+#include "../PerfectHash.h"
+#include "../TokenScanner.h"
+#include <gtest/gtest.h>
+
+//-----------------------------------------------------------------------------
+TEST(PerfectHash, Lookup) {
+    std::vector<std::string> keys;
+    for (int i = 0; i < 5000; ++i)
+        keys.push_back("Emote" + std::to_string(i));
+    keys.emplace_back("Kappa");
+    keys.emplace_back("Kappa");
+
+    PerfectHash hash(keys);
+    for (uint32_t i = 0; i < 5000; ++i)
+        EXPECT_EQ(hash.find(keys[i]), i);
+    EXPECT_EQ(hash.find("Kappa"), 5000);
+    EXPECT_EQ(hash.find("Emote"), PerfectHash::NOT_FOUND);
+    EXPECT_EQ(hash.find(""), PerfectHash::NOT_FOUND);
+    EXPECT_EQ(PerfectHash().find("Kappa"), PerfectHash::NOT_FOUND);
+}
+
+//-----------------------------------------------------------------------------
+TEST(TokenScanner, Tokens) {
+    std::vector<std::pair<std::string, bool>> tokens;
+    auto collect = [&tokens] (std::string_view token, bool ascii) { tokens.emplace_back(token, ascii); };
+
+    TokenScanner::scan("  Kappa  привет\tLUL PogChamp_with_a_very_long_name_over_16_bytes   ", collect);
+    ASSERT_EQ(tokens.size(), 4);
+    EXPECT_EQ(tokens[0], std::make_pair(std::string("Kappa"), true));
+    EXPECT_EQ(tokens[1], std::make_pair(std::string("привет"), false));
+    EXPECT_EQ(tokens[2], std::make_pair(std::string("LUL"), true));
+    EXPECT_EQ(tokens[3], std::make_pair(std::string("PogChamp_with_a_very_long_name_over_16_bytes"), true));
+
+    tokens.clear();
+    TokenScanner::scan("                                    ", collect);
+    EXPECT_TRUE(tokens.empty());
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
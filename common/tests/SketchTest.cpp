@@ -0,0 +1,171 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+#include "../CountMinSketch.h"
+#include "../SpaceSaving.h"
+#include "../HyperLogLog.h"
+#include "../TimeWindow.h"
+#include <string>
+#include <gtest/gtest.h>
+
+//-----------------------------------------------------------------------------
+TEST(CountMin, NeverUnderestimates) {
+    CountMinSketch sketch(256, 4);
+    EXPECT_EQ(sketch.estimate(sketchHash("a")), 0u);
+    for (int i = 0; i < 1000; ++i)
+        sketch.add(sketchHash("key" + std::to_string(i % 100)), i % 100 + 1);
+
+    uint64_t total = 0;
+    for (int i = 0; i < 100; ++i) {
+        uint64_t exact = (i + 1) * 10;
+        total += exact;
+        auto estimate = sketch.estimate(sketchHash("key" + std::to_string(i)));
+        EXPECT_GE(estimate, exact);
+        EXPECT_LE(estimate, exact + total / 16);
+    }
+    EXPECT_EQ(sketch.total(), total);
+}
+
+TEST(CountMin, Merge) {
+    CountMinSketch lhs, rhs;
+    lhs.add(sketchHash("a"), 3);
+    rhs.add(sketchHash("a"), 4);
+    rhs.add(sketchHash("b"), 1);
+    CountMinSketch empty;
+    empty.merge(lhs);
+    empty.merge(rhs);
+    EXPECT_EQ(empty.estimate(sketchHash("a")), 7u);
+    EXPECT_EQ(empty.estimate(sketchHash("b")), 1u);
+    EXPECT_EQ(empty.total(), 8u);
+
+    CountMinSketch other(64, 2);
+    other.add(sketchHash("a"));
+    empty.merge(other); // different dimensions are ignored
+    EXPECT_EQ(empty.total(), 8u);
+}
+
+//-----------------------------------------------------------------------------
+TEST(SpaceSaving, ExactUnderCapacity) {
+    SpaceSaving top(4);
+    top.add("a", 5);
+    top.add("b", 2);
+    top.add("a");
+    top.add("c", 7);
+    auto items = top.top(10);
+    ASSERT_EQ(items.size(), 3u);
+    EXPECT_EQ(items[0].key, "c");
+    EXPECT_EQ(items[0].count, 7u);
+    EXPECT_EQ(items[1].key, "a");
+    EXPECT_EQ(items[1].count, 6u);
+    EXPECT_EQ(items[2].error, 0u);
+    EXPECT_EQ(top.top(1).size(), 1u);
+}
+
+TEST(SpaceSaving, KeepsHeavyHitters) {
+    SpaceSaving top(8);
+    for (int round = 0; round < 100; ++round) {
+        top.add("heavy1", 10);
+        top.add("heavy2", 5);
+        for (int i = 0; i < 20; ++i)
+            top.add("noise" + std::to_string(round * 20 + i));
+    }
+    auto items = top.top(2);
+    ASSERT_EQ(items.size(), 2u);
+    EXPECT_EQ(items[0].key, "heavy1");
+    EXPECT_EQ(items[1].key, "heavy2");
+    EXPECT_GE(items[0].count, 1000u);
+    EXPECT_LE(items[0].count - items[0].error, 1000u);
+    EXPECT_EQ(top.size(), 8u);
+    EXPECT_TRUE(top.full());
+
+    // replaced entry inherits minimum as error
+    uint64_t min = top.minCount();
+    top.add("fresh");
+    EXPECT_EQ(top.count("fresh"), min + 1);
+}
+
+TEST(SpaceSaving, MergeAndCopy) {
+    SpaceSaving lhs(3), rhs(3);
+    lhs.add("a", 10);
+    lhs.add("b", 4);
+    rhs.add("a", 1);
+    rhs.add("c", 8);
+    lhs.merge(rhs);
+    auto items = lhs.top(3);
+    ASSERT_EQ(items.size(), 3u);
+    EXPECT_EQ(items[0].key, "a");
+    EXPECT_EQ(items[0].count, 11u);
+    EXPECT_EQ(items[1].key, "c");
+
+    SpaceSaving copy = lhs;
+    copy.add("b", 100);
+    EXPECT_EQ(copy.count("b"), 104u);
+    EXPECT_EQ(lhs.count("b"), 4u);
+
+    SpaceSaving moved = std::move(copy);
+    moved.add("a");
+    EXPECT_EQ(moved.count("a"), 12u);
+    EXPECT_TRUE(copy.empty());
+
+    // full summaries add minimum of the other side to unmatched keys
+    SpaceSaving full(2), other(2);
+    full.add("x", 5);
+    full.add("y", 3);
+    other.add("z", 4);
+    other.add("w", 2);
+    full.merge(other);
+    EXPECT_EQ(full.count("x"), 7u);
+    EXPECT_EQ(full.count("z"), 7u);
+    EXPECT_EQ(full.size(), 2u);
+}
+
+//-----------------------------------------------------------------------------
+static HyperLogLog fill(int from, int to) {
+    HyperLogLog hll;
+    for (int i = from; i < to; ++i)
+        hll.add(sketchHash("user" + std::to_string(i)));
+    return hll;
+}
+
+TEST(HyperLogLog, SparseIsNearExact) {
+    HyperLogLog hll;
+    EXPECT_TRUE(hll.empty());
+    EXPECT_EQ(hll.estimate(), 0u);
+    hll = fill(0, 100);
+    hll.merge(fill(0, 100));
+    EXPECT_TRUE(hll.isSparse());
+    EXPECT_NEAR(static_cast<double>(hll.estimate()), 100.0, 3.0);
+}
+
+TEST(HyperLogLog, DenseError) {
+    for (int n: {1000, 20000, 200000}) {
+        auto hll = fill(0, n);
+        EXPECT_FALSE(hll.isSparse());
+        EXPECT_NEAR(static_cast<double>(hll.estimate()), n, n * 0.05) << n;
+    }
+}
+
+TEST(HyperLogLog, MergeIsUnion) {
+    auto lhs = fill(0, 30000);
+    lhs.merge(fill(20000, 50000));
+    EXPECT_NEAR(static_cast<double>(lhs.estimate()), 50000.0, 2500.0);
+
+    auto sparse = fill(0, 50);
+    sparse.merge(fill(100000, 110000)); // sparse merged with dense becomes dense
+    EXPECT_FALSE(sparse.isSparse());
+    EXPECT_NEAR(static_cast<double>(sparse.estimate()), 10050.0, 500.0);
+}
+
+TEST(HyperLogLog, InTimeRing) {
+    TimeRing<HyperLogLog, 6> ring;
+    ring.add(1, fill(0, 1000));
+    ring.add(2, fill(500, 1500));
+    EXPECT_NEAR(static_cast<double>(ring.sum(1, 2).estimate()), 1500.0, 75.0);
+    ring.add(8, fill(0, 10)); // slots 1 and 2 fell out
+    EXPECT_NEAR(static_cast<double>(ring.sum(0, 8).estimate()), 10.0, 1.0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
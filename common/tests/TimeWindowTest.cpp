@@ -0,0 +1,97 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+#include "../TimeWindow.h"
+#include "../Histogram.h"
+#include <gtest/gtest.h>
+
+struct Counts {
+    unsigned int in = 0;
+    unsigned int out = 0;
+    void merge(const Counts &rhs) {
+        in += rhs.in;
+        out += rhs.out;
+    }
+};
+
+//-----------------------------------------------------------------------------
+TEST(Ring, RollsAndDrops) {
+    TimeRing<int, 4> ring;
+    ring.add(100, 1);
+    ring.add(101, 2);
+    ring.add(101, 3);
+    EXPECT_EQ(ring.sum(100, 101), 6);
+    EXPECT_EQ(ring.sum(101, 101), 5);
+
+    ring.add(104, 10); // slot 100 is out of ring now
+    EXPECT_EQ(ring.sum(0, 200), 15);
+    ring.add(100, 7); // too old, ignored
+    EXPECT_EQ(ring.sum(0, 200), 15);
+    ring.add(102, 1); // late but still inside ring
+    EXPECT_EQ(ring.sum(101, 104), 16);
+
+    ring.add(200, 1); // gap longer than ring resets everything
+    EXPECT_EQ(ring.sum(0, 200), 1);
+    EXPECT_EQ(ring.last(), 200);
+}
+
+TEST(Window, SecondsAndMinutes) {
+    TimeWindow<unsigned long long, 60, 60> window;
+    long long start = 1'000'020; // 20 seconds into a minute
+    for (long long t = start; t < start + 600; ++t)
+        window.add(t, 1);
+    long long now = start + 599;
+
+    long long covered = 0;
+    EXPECT_EQ(window.sum(now, 10, &covered), 10u);
+    EXPECT_EQ(covered, 10);
+    EXPECT_EQ(window.sum(now, 60, &covered), 60u);
+    EXPECT_EQ(covered, 60);
+
+    // 5 minutes are rounded to minutes, current minute is partial
+    auto sum = window.sum(now, 300, &covered);
+    EXPECT_EQ(sum, static_cast<unsigned long long>(covered));
+    EXPECT_GE(covered, 240);
+    EXPECT_LE(covered, 300);
+
+    // longer than recorded
+    EXPECT_EQ(window.sum(now, 3600, &covered), 600u);
+    EXPECT_EQ(window.sum(now, 1'000'000, &covered), 600u); // clamped to horizon
+    EXPECT_EQ(covered, 3600 - 60 + now % 60 + 1);
+}
+
+TEST(Window, MinutesOnlyStruct) {
+    TimeWindow<Counts, 0, 60> window;
+    long long now = 600'030; // 30 seconds into a minute
+    window.add(now - 120, Counts{1, 0});
+    window.add(now - 5, Counts{2, 3});
+    window.add(now, Counts{4, 0});
+
+    auto last = window.sum(now, 60);
+    EXPECT_EQ(last.in, 6u);
+    EXPECT_EQ(last.out, 3u);
+    EXPECT_EQ(window.sum(now, 180).in, 7u);
+
+    EXPECT_FALSE(window.idle(now));
+    EXPECT_FALSE(window.idle(now + 59 * 60));
+    EXPECT_TRUE(window.idle(now + 60 * 60));
+}
+
+TEST(Window, Histograms) {
+    TimeWindow<Histogram, 0, 10> window;
+    long long now = 6'000;
+    for (uint64_t i = 1; i <= 100; ++i) {
+        Histogram hist;
+        hist.record(i);
+        window.add(now - 60 * static_cast<long long>(i % 5), hist);
+    }
+    EXPECT_EQ(window.sum(now, 600).count(), 100u);
+    EXPECT_EQ(window.sum(now, 60).count(), 20u);
+    EXPECT_EQ(window.sum(now + 600, 600).count(), 0u);
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
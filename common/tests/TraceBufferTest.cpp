@@ -0,0 +1,96 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+#include "../TraceBuffer.h"
+#include <string>
+#include <thread>
+#include <gtest/gtest.h>
+
+//-----------------------------------------------------------------------------
+TEST(Trace, Sampling) {
+    TraceBuffer buffer;
+    EXPECT_EQ(buffer.sample(), 0u); // disabled by default
+
+    buffer.setSampleRate(4);
+    int sampled = 0;
+    uint64_t last = 0;
+    for (int i = 0; i < 100; ++i) {
+        if (auto id = buffer.sample()) {
+            EXPECT_GT(id, last);
+            last = id;
+            ++sampled;
+        }
+    }
+    EXPECT_EQ(sampled, 25);
+}
+
+TEST(Trace, SpansAndRing) {
+    TraceBuffer buffer;
+    buffer.span(0, "ignored", 1, 2);
+    buffer.span(1, "read", 10, 20);
+    buffer.span(1, "process", 30, 35, 7);
+    auto dump = buffer.collect();
+    ASSERT_EQ(dump.threads.size(), 1u);
+    EXPECT_EQ(dump.threads[0].tid, 1u);
+    ASSERT_EQ(dump.spans.size(), 2u);
+    EXPECT_STREQ(dump.spans[0].name, "read");
+    EXPECT_EQ(dump.spans[1].arg, 7);
+
+    for (long long i = 0; i < static_cast<long long>(TraceBuffer::RING_SIZE) + 10; ++i)
+        buffer.span(2, "hop", 100 + i, 101 + i);
+    dump = buffer.collect();
+    // the oldest are overwritten, slot next write goes to is never reported
+    ASSERT_EQ(dump.spans.size(), TraceBuffer::RING_SIZE - 1);
+    EXPECT_EQ(dump.spans.front().begin, 111);
+}
+
+TEST(Trace, Threads) {
+    TraceBuffer buffer;
+    std::thread writer([&buffer] {
+        set_thread_name("trace_writer");
+        for (long long i = 0; i < 100000; ++i)
+            buffer.span(i / 3 + 1, "hop", i, i + 1);
+    });
+    for (int i = 0; i < 50; ++i) {
+        auto dump = buffer.collect();
+        for (size_t s = 1; s < dump.spans.size(); ++s)
+            ASSERT_LE(dump.spans[s - 1].begin, dump.spans[s].begin);
+    }
+    writer.join();
+    buffer.span(1, "main", 0, 1);
+
+    auto dump = buffer.collect();
+    ASSERT_EQ(dump.threads.size(), 2u);
+    EXPECT_EQ(dump.threads[0].name, "trace_writer");
+    EXPECT_EQ(dump.spans.size(), TraceBuffer::RING_SIZE);
+}
+
+TEST(Trace, Export) {
+    TraceBuffer buffer;
+    buffer.span(5, "irc.read", 1000, 1010);
+    buffer.span(5, "processor", 1020, 1050);
+    buffer.span(5, "storage.insert", 2000, 2100);
+    buffer.span(6, "irc.read", 3000, 3001);
+    auto dump = buffer.collect();
+
+    std::string json;
+    TraceBuffer::writeChromeJson(dump, json);
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+    EXPECT_NE(json.find(R"({"name":"processor","cat":"chat","ph":"X","pid":1,"tid":1,"ts":1020,"dur":30)"), std::string::npos);
+    EXPECT_NE(json.find(R"("ph":"s","bp":"e","pid":1,"tid":1,"ts":1000,"id":5)"), std::string::npos);
+    EXPECT_NE(json.find(R"("ph":"t","bp":"e","pid":1,"tid":1,"ts":1020,"id":5)"), std::string::npos);
+    EXPECT_NE(json.find(R"("ph":"f","bp":"e","pid":1,"tid":1,"ts":2000,"id":5)"), std::string::npos);
+    EXPECT_EQ(json.find(R"("id":6)"), std::string::npos); // single span trace has no flow
+
+    std::string proto;
+    TraceBuffer::writePerfetto(dump, proto);
+    ASSERT_GT(proto.size(), 2u);
+    EXPECT_EQ(static_cast<unsigned char>(proto[0]), 0x0a); // Trace.packet, length delimited
+    EXPECT_NE(proto.find("storage.insert"), std::string::npos);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -53,7 +53,7 @@ class CHConnection : public DBConnection
 
     [[nodiscard]] clickhouse::Client *raw() const { return conn.get();}
 
-    void insert(const std::string& table_name, const clickhouse::Block& block) {
+    bool insert(const std::string& table_name, const clickhouse::Block& block) {
         auto first = CurrentTime<std::chrono::system_clock>::milliseconds();
         try {
             conn->Insert(table_name, block);
@@ -64,6 +64,7 @@ class CHConnection : public DBConnection
                 stats.rows += block.GetRowCount();
                 stats.rtt = now - first;
             }
+            return true;
         } catch (const std::exception& e) {
             fprintf(stderr, "Failed to insert to CH: %s\n", e.what());
             auto now = CurrentTime<std::chrono::system_clock>::milliseconds();
@@ -73,6 +74,7 @@ class CHConnection : public DBConnection
                 stats.rtt = now - first;
             }
         }
+        return false;
     }
 
     [[nodiscard]] CHStatistics getStats() {
@@ -0,0 +1,339 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Clock.h"
+#include "Logger.h"
+
+#include "KVStorage.h"
+
+static constexpr const char *SNAPSHOT_FILE = "snapshot.kv";
+static constexpr const char *SNAPSHOT_TMP_FILE = "snapshot.kv.tmp";
+static constexpr const char *WAL_FILE = "wal.kv";
+static constexpr const char *WAL_ROTATED_FILE = "wal.kv.1";
+
+KVStorage::KVStorage(KVStorageConfig config, std::shared_ptr<Logger> logger)
+  : config(std::move(config)), logger(std::move(logger)) {
+    size_t count = std::max(this->config.shards, 1u);
+    shards.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        shards.emplace_back(std::make_unique<Shard>());
+}
+
+KVStorage::~KVStorage() {
+    std::lock_guard lg(walMutex);
+    if (wal)
+        std::fclose(wal);
+}
+
+bool KVStorage::open() {
+    std::error_code ec;
+    std::filesystem::create_directories(config.path, ec);
+    if (ec) {
+        logger->logError("KVStorage Failed to create directory {}: {}", config.path, ec.message());
+        return false;
+    }
+
+    // snapshot is followed by rotated WAL(if snapshot was interrupted) and current WAL
+    replay(fileName(SNAPSHOT_FILE));
+    replay(fileName(WAL_ROTATED_FILE));
+    replay(fileName(WAL_FILE));
+
+    // compact on start, it also drops torn WAL tail left after crash.
+    // WAL files are removed only after snapshot is durable, otherwise crash could leave nothing to recover from
+    if (!writeSnapshot())
+        return false;
+    std::remove(fileName(WAL_ROTATED_FILE).c_str());
+    std::remove(fileName(WAL_FILE).c_str());
+
+    std::lock_guard lg(walMutex);
+    wal = std::fopen(fileName(WAL_FILE).c_str(), "ab");
+    if (!wal) {
+        logger->logError("KVStorage Failed to open WAL {}", fileName(WAL_FILE));
+        return false;
+    }
+    return true;
+}
+
+std::optional<std::string> KVStorage::get(int ns, std::string_view key) {
+    auto fullKey = makeKey(ns, key);
+    auto &shard = shardFor(fullKey);
+    std::lock_guard lg(shard.mutex);
+    if (auto *entry = find(shard, fullKey, now()))
+        return entry->value;
+    return std::nullopt;
+}
+
+void KVStorage::set(int ns, std::string_view key, std::string_view value, long long ttl) {
+    auto fullKey = makeKey(ns, key);
+    auto &shard = shardFor(fullKey);
+    std::lock_guard lg(shard.mutex);
+    auto &entry = shard.data[fullKey];
+    entry.value = value;
+    entry.expire = ttl > 0 ? now() + ttl : 0;
+    appendWal(Op::Set, fullKey, &entry);
+}
+
+std::optional<long long> KVStorage::incr(int ns, std::string_view key, long long delta, long long ttl) {
+    auto fullKey = makeKey(ns, key);
+    auto &shard = shardFor(fullKey);
+    long long time = now();
+
+    std::lock_guard lg(shard.mutex);
+    long long value = 0;
+    auto *entry = find(shard, fullKey, time);
+    if (entry) {
+        const auto &str = entry->value;
+        auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+        if (ec != std::errc() || ptr != str.data() + str.size())
+            return std::nullopt;
+    } else {
+        entry = &shard.data[fullKey];
+        // ttl is applied only to new keys, like cooldown counters
+        entry->expire = ttl > 0 ? time + ttl : 0;
+    }
+
+    value += delta;
+    entry->value = std::to_string(value);
+    appendWal(Op::Set, fullKey, entry);
+    return value;
+}
+
+bool KVStorage::expire(int ns, std::string_view key, long long ttl) {
+    auto fullKey = makeKey(ns, key);
+    auto &shard = shardFor(fullKey);
+    long long time = now();
+
+    std::lock_guard lg(shard.mutex);
+    auto *entry = find(shard, fullKey, time);
+    if (!entry)
+        return false;
+    entry->expire = ttl > 0 ? time + ttl : 0;
+    appendWal(Op::Set, fullKey, entry);
+    return true;
+}
+
+bool KVStorage::remove(int ns, std::string_view key) {
+    auto fullKey = makeKey(ns, key);
+    auto &shard = shardFor(fullKey);
+    std::lock_guard lg(shard.mutex);
+    if (shard.data.erase(fullKey) == 0)
+        return false;
+    appendWal(Op::Remove, fullKey, nullptr);
+    return true;
+}
+
+void KVStorage::flush() {
+    long long time = now();
+    size_t expired = 0;
+    for (auto &shard: shards) {
+        std::lock_guard lg(shard->mutex);
+        for (auto it = shard->data.begin(); it != shard->data.end();) {
+            if (it->second.expire != 0 && it->second.expire <= time) {
+                it = shard->data.erase(it);
+                ++expired;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // expired keys are dropped on replay by their deadline, so no WAL records needed
+    std::lock_guard lg(walMutex);
+    stats.expired += expired;
+    if (wal)
+        std::fflush(wal);
+}
+
+bool KVStorage::snapshot() {
+    std::lock_guard slg(snapshotMutex);
+
+    // new mutations go to fresh WAL while shards are dumped,
+    // rotated WAL left by failed snapshot is kept and current one keeps growing
+    if (!std::filesystem::exists(fileName(WAL_ROTATED_FILE))) {
+        std::lock_guard lg(walMutex);
+        if (wal)
+            std::fclose(wal);
+        std::rename(fileName(WAL_FILE).c_str(), fileName(WAL_ROTATED_FILE).c_str());
+        wal = std::fopen(fileName(WAL_FILE).c_str(), "ab");
+        if (!wal)
+            logger->logError("KVStorage Failed to open WAL {}", fileName(WAL_FILE));
+    }
+
+    if (!writeSnapshot())
+        return false;
+    std::remove(fileName(WAL_ROTATED_FILE).c_str());
+    return true;
+}
+
+bool KVStorage::writeSnapshot() {
+    auto tmpName = fileName(SNAPSHOT_TMP_FILE);
+    std::FILE *file = std::fopen(tmpName.c_str(), "wb");
+    if (!file) {
+        logger->logError("KVStorage Failed to create snapshot {}", tmpName);
+        return false;
+    }
+
+    size_t keys = 0;
+    long long time = now();
+    for (auto &shard: shards) {
+        std::lock_guard lg(shard->mutex);
+        for (auto &[key, entry]: shard->data) {
+            if (entry.expire != 0 && entry.expire <= time)
+                continue;
+            writeRecord(file, Op::Set, key, &entry);
+            ++keys;
+        }
+    }
+
+    // data must reach disk before rename, and rename itself before caller removes WAL
+    bool written = std::fflush(file) == 0 && !std::ferror(file) && ::fsync(fileno(file)) == 0;
+    std::fclose(file);
+    if (!written || std::rename(tmpName.c_str(), fileName(SNAPSHOT_FILE).c_str()) != 0) {
+        logger->logError("KVStorage Failed to write snapshot {}", tmpName);
+        return false;
+    }
+    if (!syncDirectory()) {
+        logger->logError("KVStorage Failed to sync directory {}", config.path);
+        return false;
+    }
+
+    std::lock_guard lg(walMutex);
+    ++stats.snapshots;
+    stats.keys = keys;
+    logger->logInfo("KVStorage Snapshot with {} keys created", keys);
+    return true;
+}
+
+bool KVStorage::syncDirectory() const {
+    int fd = ::open(config.path.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
+        return false;
+    bool res = ::fsync(fd) == 0;
+    ::close(fd);
+    return res;
+}
+
+KVStorage::Stats KVStorage::getStats() const {
+    std::lock_guard lg(walMutex);
+    return stats;
+}
+
+std::string KVStorage::makeKey(int ns, std::string_view key) {
+    std::string res;
+    res.reserve(sizeof(ns) + key.size());
+    res.append(reinterpret_cast<const char *>(&ns), sizeof(ns));
+    res.append(key);
+    return res;
+}
+
+long long KVStorage::now() {
+    return CurrentTime<std::chrono::system_clock>::milliseconds();
+}
+
+KVStorage::Shard &KVStorage::shardFor(const std::string &key) {
+    return *shards[std::hash<std::string>{}(key) % shards.size()];
+}
+
+KVStorage::Entry *KVStorage::find(Shard &shard, const std::string &key, long long time) {
+    auto it = shard.data.find(key);
+    if (it == shard.data.end())
+        return nullptr;
+    if (it->second.expire != 0 && it->second.expire <= time) {
+        shard.data.erase(it);
+        return nullptr;
+    }
+    return &it->second;
+}
+
+void KVStorage::writeRecord(std::FILE *file, Op op, const std::string &key, const Entry *entry) {
+    auto keySize = static_cast<uint32_t>(key.size());
+    std::fputc(static_cast<char>(op), file);
+    std::fwrite(&keySize, sizeof(keySize), 1, file);
+    std::fwrite(key.data(), 1, key.size(), file);
+    if (op == Op::Set) {
+        auto valueSize = static_cast<uint32_t>(entry->value.size());
+        std::fwrite(&entry->expire, sizeof(entry->expire), 1, file);
+        std::fwrite(&valueSize, sizeof(valueSize), 1, file);
+        std::fwrite(entry->value.data(), 1, entry->value.size(), file);
+    }
+}
+
+void KVStorage::appendWal(Op op, const std::string &key, const Entry *entry) {
+    // buffered write, disk is touched on flush() or when stdio buffer is full
+    std::lock_guard lg(walMutex);
+    if (!wal)
+        return;
+    writeRecord(wal, op, key, entry);
+    ++stats.walRecords;
+}
+
+bool KVStorage::replay(const std::string &name) {
+    std::FILE *file = std::fopen(name.c_str(), "rb");
+    if (!file)
+        return false;
+
+    std::error_code ec;
+    const auto fileSize = static_cast<long long>(std::filesystem::file_size(name, ec));
+    auto readString = [file, fileSize] (std::string &str) {
+        uint32_t size = 0;
+        if (std::fread(&size, sizeof(size), 1, file) != 1)
+            return false;
+        // size from torn or corrupt record can be anything, never allocate past end of file
+        long long pos = std::ftell(file);
+        if (pos < 0 || size > fileSize - pos)
+            return false;
+        str.resize(size);
+        return std::fread(str.data(), 1, size, file) == size;
+    };
+
+    size_t records = 0;
+    long long time = now();
+    std::string key;
+    Entry entry;
+    int op;
+    bool complete = false;
+    while (true) {
+        if ((op = std::fgetc(file)) == EOF) {
+            complete = true;
+            break;
+        }
+        if (!readString(key))
+            break;
+
+        auto &shard = shardFor(key);
+        if (op == static_cast<int>(Op::Remove)) {
+            shard.data.erase(key);
+        } else if (op == static_cast<int>(Op::Set)) {
+            if (std::fread(&entry.expire, sizeof(entry.expire), 1, file) != 1 || !readString(entry.value))
+                break;
+            if (entry.expire != 0 && entry.expire <= time)
+                shard.data.erase(key);
+            else
+                shard.data[key] = entry;
+        } else {
+            logger->logError("KVStorage Broken record in {} after {} records", name, records);
+            break;
+        }
+        ++records;
+    }
+
+    // torn tail after crash is expected, following writes go to new WAL
+    if (!complete)
+        logger->logWarn("KVStorage File {} is truncated after {} records", name, records);
+    std::fclose(file);
+    return true;
+}
+
+std::string KVStorage::fileName(const char *name) const {
+    return (std::filesystem::path(config.path) / name).string();
+}
@@ -0,0 +1,103 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_DB_KV_KVSTORAGE_H_
+#define CHATCONTROLLER_DB_KV_KVSTORAGE_H_
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct KVStorageConfig {
+    std::string path = "data/kv"; // directory for snapshot and WAL files
+    unsigned int shards = 16;
+};
+
+class Logger;
+
+// In-process key value storage for bots state.
+// Keys are grouped by namespace(bot id) and spread between shards, each shard has own mutex.
+// Every mutation is appended to WAL with absolute value, so WAL replay is idempotent.
+// Snapshot rotates WAL, dumps all shards to new file and removes rotated WAL.
+class KVStorage
+{
+  public:
+    struct Stats {
+        size_t keys = 0;
+        size_t expired = 0;
+        size_t walRecords = 0;
+        size_t snapshots = 0;
+    };
+
+  public:
+    KVStorage(KVStorageConfig config, std::shared_ptr<Logger> logger);
+    ~KVStorage();
+
+    KVStorage(const KVStorage&) = delete;
+    KVStorage& operator=(const KVStorage&) = delete;
+
+    /// Restores state from snapshot and WAL files, opens WAL for writing
+    bool open();
+
+    std::optional<std::string> get(int ns, std::string_view key);
+    /// ttl in milliseconds, 0 - key never expires
+    void set(int ns, std::string_view key, std::string_view value, long long ttl = 0);
+    /// Returns new value or nullopt if current value is not an integer
+    std::optional<long long> incr(int ns, std::string_view key, long long delta = 1, long long ttl = 0);
+    bool expire(int ns, std::string_view key, long long ttl);
+    bool remove(int ns, std::string_view key);
+
+    /// Removes expired keys and flushes WAL buffer to disk
+    void flush();
+    /// Writes all keys to new snapshot file and drops WAL
+    bool snapshot();
+
+    [[nodiscard]] Stats getStats() const;
+
+  private:
+    enum class Op : char { Set = 'S', Remove = 'R' };
+
+    struct Entry {
+        std::string value;
+        long long expire = 0; // system clock milliseconds
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Entry> data;
+    };
+
+    static std::string makeKey(int ns, std::string_view key);
+    static long long now();
+
+    Shard &shardFor(const std::string &key);
+    Entry *find(Shard &shard, const std::string &key, long long time);
+
+    void writeRecord(std::FILE *file, Op op, const std::string &key, const Entry *entry);
+    void appendWal(Op op, const std::string &key, const Entry *entry);
+    bool replay(const std::string &fileName);
+    bool writeSnapshot();
+    /// Makes rename of snapshot durable
+    [[nodiscard]] bool syncDirectory() const;
+
+    [[nodiscard]] std::string fileName(const char *name) const;
+
+    const KVStorageConfig config;
+    const std::shared_ptr<Logger> logger;
+
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    mutable std::mutex walMutex;
+    std::FILE *wal = nullptr;
+    std::mutex snapshotMutex;
+
+    Stats stats;
+};
+
+#endif //CHATCONTROLLER_DB_KV_KVSTORAGE_H_
@@ -23,6 +23,8 @@ class PGConnectionPool : public DBConnectionPool
 
     // request handlers
     std::string statsDump();
+    /// Connections created so far, statistic of each is read with getStats()
+    [[nodiscard]] const std::vector<std::shared_ptr<PGConnection>> &connections() const { return all; }
   private:
     PGConnectionConfig config;
     std::vector<std::shared_ptr<PGConnection>> all;
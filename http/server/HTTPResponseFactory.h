@@ -24,10 +24,11 @@ inline constexpr std::string_view sv(const boost::beast::string_view& view) {
 
 struct HTTPResponseFactory {
     template<class Request>
-    static auto CreateResponse(const Request& req, http::status status, std::string&& body) {
+    static auto CreateResponse(const Request& req, http::status status, std::string&& body,
+                               beast::string_view contentType = "application/json") {
         http::response<http::string_body> res{status, req.version()};
         res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-        res.set(http::field::content_type, "application/json");
+        res.set(http::field::content_type, contentType);
         res.keep_alive(req.keep_alive());
         res.body() = std::move(body);
         res.prepare_payload();
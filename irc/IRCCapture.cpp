@@ -0,0 +1,303 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#include <lz4frame.h>
+#include <fmt/format.h>
+
+#include "Clock.h"
+#include "Logger.h"
+#include "ThreadName.h"
+
+#include "IRCCapture.h"
+
+#define BLOCK_SIZE (64 * 1024)
+#define FLUSH_PERIOD_MS 1000
+#define IDLE_SLEEP_MS 10
+
+static const LZ4F_preferences_t PREFERENCES = [] {
+    LZ4F_preferences_t prefs{};
+    prefs.frameInfo.blockSizeID = LZ4F_max256KB;
+    prefs.frameInfo.blockMode = LZ4F_blockLinked;
+    prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+    return prefs;
+}();
+
+template <typename T>
+static void appendInt(std::string &str, T value) {
+    str.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void appendSession(std::string &str, uint32_t key, const std::string &name) {
+    auto size = static_cast<uint16_t>(std::min<size_t>(name.size(), UINT16_MAX));
+    str.push_back(IRCCaptureFormat::SESSION);
+    appendInt(str, key);
+    appendInt(str, size);
+    str.append(name, 0, size);
+}
+
+IRCCapture::IRCCapture(IRCCaptureConfig config, std::shared_ptr<Logger> logger)
+  : config(std::move(config)), logger(std::move(logger)) {
+}
+
+IRCCapture::~IRCCapture() {
+    stop();
+    closeSegment();
+    if (context)
+        LZ4F_freeCompressionContext(context);
+}
+
+bool IRCCapture::start() {
+    std::error_code ec;
+    std::filesystem::create_directories(config.path, ec);
+    if (ec) {
+        logger->logError("IRCCapture Failed to create directory {}: {}", config.path, ec.message());
+        return false;
+    }
+
+    if (auto res = LZ4F_createCompressionContext(&context, LZ4F_VERSION); LZ4F_isError(res)) {
+        logger->logError("IRCCapture Failed to create LZ4 context: {}", LZ4F_getErrorName(res));
+        return false;
+    }
+
+    if (!openSegment())
+        return false;
+
+    running = true;
+    thread = std::thread(&IRCCapture::run, this);
+    set_thread_name(thread, "irc_capture");
+    logger->logInfo("IRCCapture Recording inbound IRC lines to {}", config.path);
+    return true;
+}
+
+void IRCCapture::stop() {
+    if (!running.exchange(false))
+        return;
+    if (thread.joinable())
+        thread.join();
+}
+
+uint32_t IRCCapture::addSession(std::string name) {
+    uint32_t key = lastSession.fetch_add(1, std::memory_order_relaxed) + 1;
+    // declarations are never dropped, otherwise lines can't be attributed
+    pending.fetch_add(1, std::memory_order_relaxed);
+    queue.push(Entry{IRCCaptureFormat::SESSION, 0, key, std::move(name)});
+    return key;
+}
+
+void IRCCapture::write(uint32_t session, std::string line) {
+    if (pending.load(std::memory_order_relaxed) >= config.queueLimit) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    pending.fetch_add(1, std::memory_order_relaxed);
+    queue.push(Entry{IRCCaptureFormat::LINE, CurrentTime<std::chrono::system_clock>::microseconds(),
+                     session, std::move(line)});
+}
+
+std::string IRCCapture::makeLine(std::string_view event,
+                                 std::string_view origin,
+                                 const std::vector<std::string_view> &params) {
+    std::string line;
+    line.reserve(origin.size() + event.size() + 64);
+    if (!origin.empty()) {
+        line.push_back(':');
+        line.append(origin);
+        line.push_back(' ');
+    }
+
+    // libircclient reports /me as separate event, put CTCP framing back
+    if (event == "ACTION" && params.size() > 1) {
+        line.append("PRIVMSG ").append(params.front()).append(" :\001ACTION ").append(params.back());
+        line.push_back('\001');
+        return line;
+    }
+
+    line.append(event);
+    for (size_t i = 0; i < params.size(); ++i) {
+        const auto &param = params[i];
+        line.push_back(' ');
+        if (i + 1 == params.size() && (param.empty() || param.front() == ':' || param.find(' ') != std::string_view::npos))
+            line.push_back(':');
+        line.append(param);
+    }
+    return line;
+}
+
+IRCCapture::Stats IRCCapture::getStats() const {
+    std::lock_guard lg(statsMutex);
+    Stats res = stats;
+    res.dropped = dropped.load(std::memory_order_relaxed);
+    return res;
+}
+
+void IRCCapture::run() {
+    lastFlush = CurrentTime<std::chrono::steady_clock>::milliseconds();
+    while (true) {
+        // read flag before draining, so lines pushed before stop() are written
+        bool stopping = !running.load(std::memory_order_acquire);
+
+        size_t count = 0;
+        Entry entry;
+        while (queue.pop(entry)) {
+            pending.fetch_sub(1, std::memory_order_relaxed);
+            append(entry);
+            ++count;
+            if (block.size() >= BLOCK_SIZE)
+                compress(false);
+        }
+
+        // LZ4 keeps partial block inside context, so small updates don't hurt ratio
+        auto now = CurrentTime<std::chrono::steady_clock>::milliseconds();
+        bool flush = now - lastFlush >= FLUSH_PERIOD_MS;
+        if (!block.empty() || flush)
+            compress(flush);
+        if (flush)
+            lastFlush = now;
+
+        if (stopping)
+            break;
+        if (count == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_SLEEP_MS));
+    }
+    closeSegment();
+}
+
+void IRCCapture::append(const Entry &entry) {
+    if (entry.type == IRCCaptureFormat::SESSION) {
+        sessions[entry.session] = entry.data;
+        appendSession(block, entry.session, entry.data);
+        return;
+    }
+
+    block.push_back(IRCCaptureFormat::LINE);
+    appendInt(block, static_cast<int64_t>(entry.time));
+    appendInt(block, entry.session);
+    appendInt(block, static_cast<uint32_t>(entry.data.size()));
+    block.append(entry.data);
+
+    ++current.lines;
+    current.bytes += entry.data.size();
+}
+
+void IRCCapture::compress(bool flush) {
+    if (!segment && !openSegment()) {
+        block.clear();
+        return;
+    }
+
+    size_t bound = std::max(LZ4F_compressBound(block.size(), &PREFERENCES), LZ4F_compressBound(0, &PREFERENCES));
+    if (output.size() < bound)
+        output.resize(bound);
+
+    if (!block.empty()) {
+        size_t size = LZ4F_compressUpdate(context, output.data(), output.size(), block.data(), block.size(), nullptr);
+        block.clear();
+        if (LZ4F_isError(size)) {
+            logger->logError("IRCCapture Failed to compress block: {}", LZ4F_getErrorName(size));
+            closeSegment();
+            return;
+        }
+        writeSegment(output.data(), size);
+    }
+
+    if (flush) {
+        // makes everything written so far readable from unfinished segment
+        size_t size = LZ4F_flush(context, output.data(), output.size(), nullptr);
+        if (!LZ4F_isError(size))
+            writeSegment(output.data(), size);
+        std::fflush(segment);
+    }
+
+    if (segmentWritten >= config.segmentSize)
+        closeSegment();
+
+    std::lock_guard lg(statsMutex);
+    stats = current;
+}
+
+void IRCCapture::writeSegment(const char *data, size_t size) {
+    if (size == 0)
+        return;
+    if (std::fwrite(data, 1, size, segment) != size)
+        logger->logError("IRCCapture Failed to write segment, {} bytes lost", size);
+    segmentWritten += size;
+    current.written += size;
+}
+
+bool IRCCapture::openSegment() {
+    // names are sortable by creation time
+    auto time = CurrentTime<std::chrono::system_clock>::milliseconds();
+    std::filesystem::path path;
+    do {
+        auto name = fmt::format("{}{:013}{}", IRCCaptureFormat::PREFIX, time++, IRCCaptureFormat::SUFFIX);
+        path = std::filesystem::path(config.path) / name;
+    } while (std::filesystem::exists(path));
+
+    segment = std::fopen(path.c_str(), "wb");
+    if (!segment) {
+        logger->logError("IRCCapture Failed to create segment {}", path.string());
+        return false;
+    }
+
+    if (output.size() < LZ4F_HEADER_SIZE_MAX)
+        output.resize(LZ4F_HEADER_SIZE_MAX);
+    size_t size = LZ4F_compressBegin(context, output.data(), output.size(), &PREFERENCES);
+    if (LZ4F_isError(size)) {
+        logger->logError("IRCCapture Failed to start LZ4 frame: {}", LZ4F_getErrorName(size));
+        std::fclose(segment);
+        segment = nullptr;
+        return false;
+    }
+    segmentWritten = 0;
+    writeSegment(output.data(), size);
+    ++current.segments;
+
+    // every segment is readable on its own
+    std::string header(IRCCaptureFormat::MAGIC);
+    for (auto &[key, name]: sessions)
+        appendSession(header, key, name);
+    block.insert(0, header);
+
+    removeOldSegments();
+    return true;
+}
+
+void IRCCapture::closeSegment() {
+    if (!segment)
+        return;
+
+    size_t bound = LZ4F_compressBound(0, &PREFERENCES);
+    if (output.size() < bound)
+        output.resize(bound);
+    size_t size = LZ4F_compressEnd(context, output.data(), output.size(), nullptr);
+    if (!LZ4F_isError(size))
+        writeSegment(output.data(), size);
+    std::fclose(segment);
+    segment = nullptr;
+}
+
+void IRCCapture::removeOldSegments() {
+    if (config.segments == 0)
+        return;
+
+    std::error_code ec;
+    std::vector<std::filesystem::path> files;
+    for (auto &file: std::filesystem::directory_iterator(config.path, ec)) {
+        auto name = file.path().filename().string();
+        if (name.size() > IRCCaptureFormat::PREFIX.size() + IRCCaptureFormat::SUFFIX.size() &&
+            name.compare(0, IRCCaptureFormat::PREFIX.size(), IRCCaptureFormat::PREFIX) == 0 &&
+            name.compare(name.size() - IRCCaptureFormat::SUFFIX.size(), std::string::npos, IRCCaptureFormat::SUFFIX) == 0)
+            files.push_back(file.path());
+    }
+    if (files.size() <= config.segments)
+        return;
+
+    std::sort(files.begin(), files.end());
+    for (size_t i = 0; i < files.size() - config.segments; ++i)
+        std::filesystem::remove(files[i], ec);
+}
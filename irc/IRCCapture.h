@@ -0,0 +1,124 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_IRC_IRCCAPTURE_H_
+#define CHATCONTROLLER_IRC_IRCCAPTURE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "MPSCQueue.h"
+
+struct IRCCaptureConfig {
+    std::string path;               // directory for segment files
+    size_t segmentSize = 64 << 20;  // compressed bytes before rotation
+    unsigned int segments = 16;     // kept segments, 0 keeps all
+    size_t queueLimit = 100000;     // lines waiting for writer, extra lines are dropped
+};
+
+// Segment file layout, shared with IRCCaptureReader.
+// Every segment is one LZ4 frame(readable by `lz4 -d`) with uncompressed stream:
+//   magic "IRCCAP01"
+//   'S' u32 key, u16 size, session name           - session declaration, repeated in every segment
+//   'L' i64 time(us), u32 key, u32 size, raw line - inbound line without CRLF
+// Integers are little endian, time is system clock microseconds when line was parsed.
+namespace IRCCaptureFormat {
+    inline constexpr std::string_view MAGIC = "IRCCAP01";
+    inline constexpr char SESSION = 'S';
+    inline constexpr char LINE = 'L';
+    inline constexpr std::string_view PREFIX = "irc-";
+    inline constexpr std::string_view SUFFIX = ".lz4";
+}
+
+struct LZ4F_cctx_s;
+class Logger;
+
+// Raw inbound IRC traffic recorder.
+// Sessions push lines from selector threads to lock-free queue, background writer
+// compresses them into rotating segment files. Selector never waits for disk,
+// lines above queueLimit are dropped and counted.
+class IRCCapture
+{
+  public:
+    struct Stats {
+        size_t lines = 0;    // lines written
+        size_t dropped = 0;  // lines dropped by queue limit
+        size_t bytes = 0;    // raw lines bytes
+        size_t written = 0;  // compressed bytes
+        size_t segments = 0; // segments created
+    };
+
+  public:
+    IRCCapture(IRCCaptureConfig config, std::shared_ptr<Logger> logger);
+    ~IRCCapture();
+
+    IRCCapture(const IRCCapture&) = delete;
+    IRCCapture& operator=(const IRCCapture&) = delete;
+
+    /// Creates capture directory and starts writer thread
+    bool start();
+    /// Writes queued lines, closes current segment and stops writer thread
+    void stop();
+
+    /// Declares session, returned key is used for its lines, any thread
+    uint32_t addSession(std::string name);
+    /// Queues line with current time, never blocks, any thread
+    void write(uint32_t session, std::string line);
+
+    /// Rebuilds server line from parsed libircclient event
+    static std::string makeLine(std::string_view event, std::string_view origin,
+                                const std::vector<std::string_view> &params);
+
+    [[nodiscard]] Stats getStats() const;
+
+  private:
+    struct Entry {
+        char type = 0;
+        long long time = 0;
+        uint32_t session = 0;
+        std::string data;
+    };
+
+    void run();
+    void append(const Entry &entry);
+    void compress(bool flush);
+    void writeSegment(const char *data, size_t size);
+    bool openSegment();
+    void closeSegment();
+    void removeOldSegments();
+
+    const IRCCaptureConfig config;
+    const std::shared_ptr<Logger> logger;
+
+    MPSCQueue<Entry> queue;
+    std::atomic<size_t> pending = 0;
+    std::atomic<size_t> dropped = 0;
+    std::atomic<uint32_t> lastSession = 0;
+    std::atomic_bool running = false;
+    std::thread thread;
+
+    // writer thread
+    std::map<uint32_t, std::string> sessions;
+    std::string block;
+    std::vector<char> output;
+    std::FILE *segment = nullptr;
+    size_t segmentWritten = 0;
+    long long lastFlush = 0;
+    LZ4F_cctx_s *context = nullptr;
+
+    Stats current;
+
+    mutable std::mutex statsMutex;
+    Stats stats; // copy of current for other threads
+};
+
+#endif //CHATCONTROLLER_IRC_IRCCAPTURE_H_
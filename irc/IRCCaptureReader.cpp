@@ -0,0 +1,182 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <lz4frame.h>
+
+#include "IRCCapture.h"
+#include "IRCCaptureReader.h"
+
+#define DECOMPRESS_CHUNK (256 * 1024)
+
+template <typename T>
+static T readInt(const char *data) {
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+IRCCaptureReader::IRCCaptureReader(const std::string &path) {
+    std::error_code ec;
+    if (std::filesystem::is_directory(path, ec)) {
+        for (auto &file: std::filesystem::directory_iterator(path, ec)) {
+            auto name = file.path().filename().string();
+            if (name.size() > IRCCaptureFormat::PREFIX.size() + IRCCaptureFormat::SUFFIX.size() &&
+                name.compare(0, IRCCaptureFormat::PREFIX.size(), IRCCaptureFormat::PREFIX) == 0 &&
+                name.compare(name.size() - IRCCaptureFormat::SUFFIX.size(), std::string::npos, IRCCaptureFormat::SUFFIX) == 0)
+                files.push_back(file.path().string());
+        }
+        std::sort(files.begin(), files.end());
+    } else {
+        files.push_back(path);
+    }
+
+    if (auto res = LZ4F_createDecompressionContext(&context, LZ4F_VERSION); LZ4F_isError(res)) {
+        lastError = LZ4F_getErrorName(res);
+        files.clear();
+    }
+}
+
+IRCCaptureReader::~IRCCaptureReader() {
+    closeSegment();
+    if (context)
+        LZ4F_freeDecompressionContext(context);
+}
+
+bool IRCCaptureReader::next(IRCCaptureRecord &record) {
+    static constexpr size_t SESSION_HEADER = 1 + sizeof(uint32_t) + sizeof(uint16_t);
+    static constexpr size_t LINE_HEADER = 1 + sizeof(int64_t) + sizeof(uint32_t) + sizeof(uint32_t);
+
+    while (true) {
+        if (!mapped) {
+            if (fileIndex >= files.size())
+                return false;
+            if (!openSegment()) {
+                closeSegment();
+                ++fileIndex;
+                continue;
+            }
+        }
+
+        // truncated record is a tail of unfinished segment
+        if (!ensure(1)) {
+            closeSegment();
+            ++fileIndex;
+            continue;
+        }
+
+        char type = buffer[position];
+        if (type == IRCCaptureFormat::SESSION && ensure(SESSION_HEADER)) {
+            auto key = readInt<uint32_t>(buffer.data() + position + 1);
+            auto size = readInt<uint16_t>(buffer.data() + position + 1 + sizeof(uint32_t));
+            if (ensure(SESSION_HEADER + size)) {
+                sessions[key].assign(buffer.data() + position + SESSION_HEADER, size);
+                position += SESSION_HEADER + size;
+                continue;
+            }
+        } else if (type == IRCCaptureFormat::LINE && ensure(LINE_HEADER)) {
+            const char *header = buffer.data() + position + 1;
+            auto time = readInt<int64_t>(header);
+            auto key = readInt<uint32_t>(header + sizeof(int64_t));
+            auto size = readInt<uint32_t>(header + sizeof(int64_t) + sizeof(uint32_t));
+            if (ensure(LINE_HEADER + size)) {
+                auto it = sessions.find(key);
+                record.time = time;
+                record.session = it != sessions.end() ? std::string_view(it->second) : std::string_view();
+                record.line = std::string_view(buffer.data() + position + LINE_HEADER, size);
+                position += LINE_HEADER + size;
+                return true;
+            }
+        } else if (type != IRCCaptureFormat::SESSION && type != IRCCaptureFormat::LINE) {
+            lastError = "Broken record in " + files[fileIndex];
+        }
+
+        closeSegment();
+        ++fileIndex;
+    }
+}
+
+bool IRCCaptureReader::openSegment() {
+    int fd = ::open(files[fileIndex].c_str(), O_RDONLY);
+    if (fd < 0) {
+        lastError = "Failed to open " + files[fileIndex];
+        return false;
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void *data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        lastError = "Failed to map " + files[fileIndex];
+        return false;
+    }
+    ::madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    mapped = static_cast<const char *>(data);
+    mappedSize = st.st_size;
+    mappedPos = 0;
+
+    if (!ensure(IRCCaptureFormat::MAGIC.size()) ||
+        std::string_view(buffer.data(), IRCCaptureFormat::MAGIC.size()) != IRCCaptureFormat::MAGIC) {
+        lastError = "Not a capture segment " + files[fileIndex];
+        return false;
+    }
+    position = IRCCaptureFormat::MAGIC.size();
+    return true;
+}
+
+void IRCCaptureReader::closeSegment() {
+    if (mapped)
+        ::munmap(const_cast<char *>(mapped), mappedSize);
+    mapped = nullptr;
+    mappedSize = 0;
+    mappedPos = 0;
+    buffer.clear();
+    position = 0;
+    // session keys are declared again in every segment
+    sessions.clear();
+    if (context)
+        LZ4F_resetDecompressionContext(context);
+}
+
+bool IRCCaptureReader::ensure(size_t size) {
+    if (buffer.size() - position >= size)
+        return true;
+
+    // drop consumed records before growing buffer
+    buffer.erase(0, position);
+    position = 0;
+
+    while (buffer.size() < size && mappedPos < mappedSize) {
+        size_t used = buffer.size();
+        buffer.resize(used + DECOMPRESS_CHUNK);
+
+        size_t dstSize = DECOMPRESS_CHUNK;
+        size_t srcSize = mappedSize - mappedPos;
+        size_t res = LZ4F_decompress(context, buffer.data() + used, &dstSize, mapped + mappedPos, &srcSize, nullptr);
+        buffer.resize(used + dstSize);
+        mappedPos += srcSize;
+        if (LZ4F_isError(res)) {
+            lastError = std::string("Failed to decompress ") + files[fileIndex] + ": " + LZ4F_getErrorName(res);
+            mappedPos = mappedSize;
+            break;
+        }
+        if (dstSize == 0 && srcSize == 0)
+            break;
+    }
+    return buffer.size() >= size;
+}
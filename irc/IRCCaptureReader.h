@@ -0,0 +1,64 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_IRC_IRCCAPTUREREADER_H_
+#define CHATCONTROLLER_IRC_IRCCAPTUREREADER_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct IRCCaptureRecord {
+    long long time = 0;       // system clock microseconds
+    std::string_view session; // session name given to IRCCapture::addSession
+    std::string_view line;    // raw line without CRLF
+};
+
+struct LZ4F_dctx_s;
+
+// Sequential reader of IRCCapture segments.
+// Segment files are mapped to memory and decompressed by chunks, so captures bigger than RAM are fine.
+// Unfinished segment(still written by capture) is read up to the last flushed record.
+class IRCCaptureReader
+{
+  public:
+    /// path is a segment file or capture directory(all segments in creation order)
+    explicit IRCCaptureReader(const std::string &path);
+    ~IRCCaptureReader();
+
+    IRCCaptureReader(const IRCCaptureReader&) = delete;
+    IRCCaptureReader& operator=(const IRCCaptureReader&) = delete;
+
+    /// Segment files found for path
+    [[nodiscard]] const std::vector<std::string> &segments() const { return files; }
+
+    /// Reads next record, views stay valid until next call. Returns false at the end of capture
+    bool next(IRCCaptureRecord &record);
+
+    /// Error of the last broken segment, reading continues with the next one
+    [[nodiscard]] const std::string &error() const { return lastError; }
+
+  private:
+    bool openSegment();
+    void closeSegment();
+    /// Decompresses until buffer has size bytes after position
+    bool ensure(size_t size);
+
+    std::vector<std::string> files;
+    size_t fileIndex = 0;
+
+    const char *mapped = nullptr;
+    size_t mappedSize = 0;
+    size_t mappedPos = 0;
+    LZ4F_dctx_s *context = nullptr;
+
+    std::string buffer;
+    size_t position = 0;
+    std::unordered_map<uint32_t, std::string> sessions;
+    std::string lastError;
+};
+
+#endif //CHATCONTROLLER_IRC_IRCCAPTUREREADER_H_
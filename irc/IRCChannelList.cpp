@@ -2,18 +2,13 @@
 // Created by l2pic on 04.05.2021.
 //
 
+#include <algorithm>
+
 #include "Logger.h"
 #include "../DBController.h"
 #include "IRCChannelList.h"
 #include "IRCSession.h"
 
-inline void fillChannelsMap(const std::shared_ptr<DBController> db, std::map<std::string, Channel>& target) {
-    auto list = db->loadChannels();
-    std::transform(list.begin(), list.end(), std::inserter(target, target.end()), [] (auto& name) {
-        return std::make_pair(name, Channel{name});
-    });
-}
-
 IRCChannelList::IRCChannelList(const Sessions &sessions, const IRCClientConfig& cliConfig, std::shared_ptr<Logger> logger, std::shared_ptr<DBController> db)
   : sessions(sessions), cliConfig(cliConfig), logger(std::move(logger)), db(std::move(db)) {
 
@@ -27,110 +22,475 @@ void IRCChannelList::load() {
                      fmt::ptr(this), cliConfig.id);
     auto loadedChannels = db->loadChannelsFor(cliConfig.id);
 
-    Channels temp;
-    std::transform(loadedChannels.begin(), loadedChannels.end(),
-                   std::inserter(temp, temp.end()), [] (auto& name) {
-        return std::make_pair(name, Channel{name});
-    });
-
     logger->logInfo("IRCChannelList[{}] loaded {} channels, that will be joined to {} sessions",
                      fmt::ptr(this), loadedChannels.size(), cliConfig.session_count);
 
     std::lock_guard lg(mutex);
-    channels.swap(temp);
+    clear();
+    slots.reserve(loadedChannels.size());
+    index.reserve(loadedChannels.size());
+    for (auto &name: loadedChannels)
+        insert(Channel{std::move(name)});
+    fullDelta = true;
+    changed.clear();
 }
 
 void IRCChannelList::addChannel(Channel channel) {
     std::lock_guard lg(mutex);
-    channels.emplace(channel.getName(), std::move(channel));
+    if (find(channel.getName()) != NONE)
+        return;
+    trackChange(channel);
+    insert(std::move(channel));
 }
 
 std::optional<Channel> IRCChannelList::extractChannel(const std::string &name) {
     std::lock_guard lg(mutex);
-    auto it = channels.find(name);
-    if (it == channels.end())
+    auto id = find(name);
+    if (id == NONE)
         return {};
 
-    Channel res{std::move(it->second)};
-    channels.erase(it);
-    return res;
+    trackChange(channelAt(id), true);
+    return erase(id);
 }
 
-void IRCChannelList::markChannelJoined(const std::string &name) {
+IRCSession *IRCChannelList::markChannelJoined(const std::string &name) {
     std::lock_guard lg(mutex);
-    auto it = channels.find(name);
-    if (it != channels.end())
-        it->second.setJoined(true);
+    auto id = find(name);
+    if (id == NONE)
+        return nullptr;
+
+    auto &channel = channelAt(id);
+    channel.setJoined(true);
+    auto *handoff = channel.getHandoff();
+    setHandoff(id, nullptr);
+    return handoff;
 }
 
 void IRCChannelList::removeChannel(const std::string &name) {
     std::lock_guard lg(mutex);
-    channels.erase(name);
+    auto id = find(name);
+    if (id == NONE)
+        return;
+
+    trackChange(channelAt(id), true);
+    erase(id);
 }
 
 std::vector<std::string> IRCChannelList::reserveChannelsForSession(IRCSession *session) {
     std::vector<std::string> result;
 
     std::lock_guard lg(mutex);
-    size_t capacity = (channels.size() / cliConfig.session_count) + 1;
-    result.reserve(capacity);
+    std::vector<uint32_t> unattached;
+    unattached.reserve(lists[nullptr].channels.size);
+    forEach(lists[nullptr].channels, &Slot::bySession, [&unattached] (uint32_t id) {
+        unattached.push_back(id);
+    });
 
-    for (auto &[name, channel]: channels) {
-        if (channel.attached())
-            continue;
+    // channels are spread between this and other sessions without channels(they will login later),
+    // hottest first to the least loaded one, this session takes its own share only
+    size_t freeSessions = 1;
+    for (const auto &other: sessions) {
+        auto it = lists.find(other.get());
+        if (other.get() != session && (it == lists.end() || it->second.channels.size == 0))
+            ++freeSessions;
+    }
+
+    std::sort(unattached.begin(), unattached.end(), [this] (uint32_t lhs, uint32_t rhs) {
+        return channelAt(lhs).getActivity() > channelAt(rhs).getActivity();
+    });
 
-        channel.attach(session);
-        result.push_back(channel.getName());
+    std::vector<std::pair<double, size_t>> load(freeSessions); // load and channels count of every free session
+    for (auto id: unattached) {
+        auto &channel = channelAt(id);
+        auto target = std::min_element(load.begin(), load.end());
+        target->first += channel.getActivity();
+        ++target->second;
+        if (target == load.begin()) {
+            attach(id, session);
+            result.push_back(channel.getName());
+        }
+    }
 
-        if (result.size() == capacity)
+    return result;
+}
+
+std::vector<IRCChannelList::Migration> IRCChannelList::rebalance(double band, size_t maxMoves) {
+    std::vector<Migration> result;
+
+    std::lock_guard lg(mutex);
+    std::unordered_map<IRCSession *, double> load;
+    for (const auto &session: sessions) {
+        if (session->loggedIn())
+            load.emplace(session.get(), 0.0);
+    }
+    if (load.size() < 2)
+        return result;
+
+    double total = 0;
+    for (auto &[session, activity]: load) {
+        forEach(lists[session].channels, &Slot::bySession, [this, &activity = activity] (uint32_t id) {
+            auto &channel = channelAt(id);
+            if (channel.getJoined())
+                activity += channel.getActivity();
+        });
+        total += activity;
+    }
+    double limit = total / static_cast<double>(load.size()) * (1.0 + band);
+
+    auto byLoad = [] (const auto &lhs, const auto &rhs) { return lhs.second < rhs.second; };
+    while (result.size() < maxMoves) {
+        auto [cold, hot] = std::minmax_element(load.begin(), load.end(), byLoad);
+        if (hot->second <= limit)
+            break;
+
+        // the hottest channel that does not make target session hotter than source
+        double maxActivity = (hot->second - cold->second) / 2;
+        uint32_t best = NONE;
+        forEach(lists[hot->first].channels, &Slot::bySession, [this, &best, maxActivity] (uint32_t id) {
+            auto &channel = channelAt(id);
+            if (!channel.getJoined() || channel.getActivity() > maxActivity)
+                return;
+            if (best == NONE || channel.getActivity() > channelAt(best).getActivity())
+                best = id;
+        });
+        if (best == NONE || channelAt(best).getActivity() <= 0)
             break;
+
+        auto &channel = channelAt(best);
+        hot->second -= channel.getActivity();
+        cold->second += channel.getActivity();
+        result.push_back(Migration{channel.getName(), hot->first, cold->first});
+        setHandoff(best, hot->first);
+        attach(best, cold->first);
+        channel.setJoined(false);
     }
 
     return result;
 }
 
-void IRCChannelList::detachAndPartFromSession(IRCSession *session) {
+std::vector<IRCChannelList::Migration> IRCChannelList::fill(IRCSession *session, size_t count) {
+    std::vector<Migration> result;
+
     std::lock_guard lg(mutex);
-    for (auto &[name, channel]: channels) {
-        if (channel.attachedTo(session)) {
-            channel.detach();
-            channel.setJoined(false);
-        }
+    size_t own = lists[session].channels.size;
+    std::unordered_map<IRCSession *, std::vector<uint32_t>> bySession;
+    for (auto &[other, list]: lists) {
+        if (other == nullptr || other == session || list.channels.size == 0)
+            continue;
+        auto &joined = bySession[other];
+        forEach(list.channels, &Slot::bySession, [this, &joined] (uint32_t id) {
+            if (channelAt(id).getJoined())
+                joined.push_back(id);
+        });
+        std::sort(joined.begin(), joined.end(), [this] (uint32_t lhs, uint32_t rhs) {
+            return channelAt(lhs).getActivity() > channelAt(rhs).getActivity();
+        });
+    }
+    if (bySession.empty())
+        return result;
+
+    while (own + result.size() < count) {
+        auto donor = std::max_element(bySession.begin(), bySession.end(), [] (const auto &lhs, const auto &rhs) {
+            return lhs.second.size() < rhs.second.size();
+        });
+        if (donor->second.size() <= own + result.size() + 1)
+            break;
+
+        auto id = donor->second.back();
+        donor->second.pop_back();
+        auto &channel = channelAt(id);
+        result.push_back(Migration{channel.getName(), donor->first, session});
+        setHandoff(id, donor->first);
+        attach(id, session);
+        channel.setJoined(false);
     }
+
+    return result;
 }
 
-bool IRCChannelList::inList(const std::string &name) {
+std::vector<IRCChannelList::Migration> IRCChannelList::evacuate(IRCSession *session) {
+    std::vector<Migration> result;
+
+    std::lock_guard lg(mutex);
+    std::unordered_map<IRCSession *, double> load;
+    for (const auto &other: sessions) {
+        if (other.get() != session && other->loggedIn())
+            load.emplace(other.get(), 0.0);
+    }
+    if (load.empty())
+        return result;
+
+    for (auto &[other, activity]: load) {
+        forEach(lists[other].channels, &Slot::bySession, [this, &activity = activity] (uint32_t id) {
+            activity += channelAt(id).getActivity();
+        });
+    }
+
+    std::vector<uint32_t> moving;
+    forEach(lists[session].channels, &Slot::bySession, [&moving] (uint32_t id) {
+        moving.push_back(id);
+    });
+    std::sort(moving.begin(), moving.end(), [this] (uint32_t lhs, uint32_t rhs) {
+        return channelAt(lhs).getActivity() > channelAt(rhs).getActivity();
+    });
+
+    for (auto id: moving) {
+        auto &channel = channelAt(id);
+        auto target = std::min_element(load.begin(), load.end(), [] (const auto &lhs, const auto &rhs) {
+            return lhs.second < rhs.second;
+        });
+        target->second += channel.getActivity();
+        result.push_back(Migration{channel.getName(), session, target->first});
+        // not joined channel has nothing to hand off
+        setHandoff(id, channel.getJoined() ? session : nullptr);
+        attach(id, target->first);
+        channel.setJoined(false);
+    }
+
+    return result;
+}
+
+bool IRCChannelList::hasHandoffFrom(IRCSession *session) {
     std::lock_guard lg(mutex);
-    return channels.find(name) != channels.end();
+    auto it = lists.find(session);
+    return it != lists.end() && it->second.handoffs.size > 0;
 }
 
-IRCChannelList::ChannelsToSessionId IRCChannelList::dumpChannelsToSessionId() {
-    ChannelsToSessionId res;
-    {
-        std::lock_guard lg(mutex);
-        res.reserve(channels.size());
-        std::transform(channels.begin(), channels.end(), std::back_inserter(res), [] (const auto& pair) {
-            const auto &[name, channel] = pair;
-            auto *session = channel.getSession();
-            return std::make_pair(name, session ? session->getId() : -1/*max unsigned int*/);
+void IRCChannelList::removeSession(IRCSession *session) {
+    std::lock_guard lg(mutex);
+    auto it = lists.find(session);
+    if (it == lists.end())
+        return;
+
+    std::vector<uint32_t> handoffs;
+    forEach(it->second.handoffs, &Slot::byHandoff, [&handoffs] (uint32_t id) {
+        handoffs.push_back(id);
+    });
+    std::vector<uint32_t> own;
+    forEach(it->second.channels, &Slot::bySession, [&own] (uint32_t id) {
+        own.push_back(id);
+    });
+    for (auto id: handoffs)
+        setHandoff(id, nullptr);
+    for (auto id: own) {
+        attach(id, nullptr);
+        channelAt(id).setJoined(false);
+    }
+    lists.erase(session);
+}
+
+std::unordered_map<IRCSession *, IRCChannelList::SessionLoad> IRCChannelList::getSessionsLoad() {
+    std::unordered_map<IRCSession *, SessionLoad> result;
+
+    std::lock_guard lg(mutex);
+    for (const auto &session: sessions) {
+        auto &load = result[session.get()];
+        auto &list = lists[session.get()].channels;
+        load.channels = list.size;
+        forEach(list, &Slot::bySession, [this, &load] (uint32_t id) {
+            load.activity += channelAt(id).getActivity();
         });
     }
+    return result;
+}
+
+IRCChannelList::SessionLoad IRCChannelList::getSessionLoad(IRCSession *session) {
+    SessionLoad load;
+
+    std::lock_guard lg(mutex);
+    auto it = lists.find(session);
+    if (it == lists.end())
+        return load;
+    load.channels = it->second.channels.size;
+    forEach(it->second.channels, &Slot::bySession, [this, &load] (uint32_t id) {
+        load.activity += channelAt(id).getActivity();
+    });
+    return load;
+}
+
+void IRCChannelList::detachAndPartFromSession(IRCSession *session) {
+    std::lock_guard lg(mutex);
+    auto &own = lists[session];
+    forEach(own.handoffs, &Slot::byHandoff, [this] (uint32_t id) {
+        setHandoff(id, nullptr);
+    });
+    forEach(own.channels, &Slot::bySession, [this] (uint32_t id) {
+        // previous session is still joined, so handoff is rolled back
+        auto &channel = channelAt(id);
+        auto *handoff = channel.getHandoff();
+        setHandoff(id, nullptr);
+        attach(id, handoff);
+        channel.setJoined(handoff != nullptr);
+    });
+}
+
+bool IRCChannelList::inList(const std::string &name) {
+    std::lock_guard lg(mutex);
+    return find(name) != NONE;
+}
+
+Irc::ChannelsDelta IRCChannelList::takeChannelsDelta() {
+    Irc::ChannelsDelta res;
+
+    std::lock_guard lg(mutex);
+    if (fullDelta) {
+        res.full = true;
+        res.channels.reserve(index.size());
+        for (auto &slot: slots) {
+            if (!slot.channel)
+                continue;
+            auto *session = slot.channel->getSession();
+            res.channels.emplace_back(slot.channel->getName(), session ? session->getId() : Irc::ChannelsDelta::DETACHED);
+        }
+        fullDelta = false;
+    } else {
+        res.channels.reserve(changed.size());
+        for (auto &[name, id]: changed)
+            res.channels.emplace_back(name, id);
+    }
+    changed.clear();
     return res;
 }
 
 std::vector<std::string> IRCChannelList::selectNotJoinedChannels(const std::vector<std::string> &checkList) {
     std::vector<std::string> result;
-    auto it = channels.end();
     {
         std::lock_guard lg(mutex);
         for (const auto& channel: checkList) {
-            it = channels.find(channel);
-            if (it != channels.end()) {
-                if (!it->second.getJoined()) {
-                    result.push_back(channel);
-                }
-            }
+            auto id = find(channel);
+            if (id != NONE && !channelAt(id).getJoined())
+                result.push_back(channel);
         }
     }
     return result;
 }
+
+void IRCChannelList::updateActivity(const std::unordered_map<std::string, unsigned int> &activity) {
+    std::lock_guard lg(mutex);
+    for (const auto &[name, bytes]: activity) {
+        auto id = find(name);
+        if (id != NONE)
+            channelAt(id).addActivity(bytes);
+    }
+}
+
+void IRCChannelList::decayActivity(double factor) {
+    std::lock_guard lg(mutex);
+    for (auto &slot: slots) {
+        if (slot.channel)
+            slot.channel->decayActivity(factor);
+    }
+}
+
+double IRCChannelList::getActivity(const std::string &name) {
+    std::lock_guard lg(mutex);
+    auto id = find(name);
+    return id != NONE ? channelAt(id).getActivity() : 0;
+}
+
+uint32_t IRCChannelList::find(const std::string &name) const {
+    return index.find(name);
+}
+
+uint32_t IRCChannelList::insert(Channel channel) {
+    uint32_t id = freeSlots;
+    if (id != NONE) {
+        freeSlots = slots[id].nextFree;
+        slots[id].nextFree = NONE;
+    } else {
+        id = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+
+    // lists are filled from channel own session and handoff
+    auto *session = channel.getSession();
+    auto *handoff = channel.getHandoff();
+    slots[id].channel.emplace(std::move(channel));
+    index.insert(id);
+    link(lists[session].channels, &Slot::bySession, id);
+    if (handoff)
+        link(lists[handoff].handoffs, &Slot::byHandoff, id);
+    return id;
+}
+
+Channel IRCChannelList::erase(uint32_t id) {
+    auto &channel = channelAt(id);
+    unlink(lists[channel.getSession()].channels, &Slot::bySession, id);
+    if (channel.getHandoff())
+        unlink(lists[channel.getHandoff()].handoffs, &Slot::byHandoff, id);
+    index.erase(channel.getName());
+
+    Channel res{std::move(channel)};
+    slots[id].channel.reset();
+    slots[id].nextFree = freeSlots;
+    freeSlots = id;
+    return res;
+}
+
+void IRCChannelList::clear() {
+    index.clear();
+    slots.clear();
+    freeSlots = NONE;
+    lists.clear();
+}
+
+void IRCChannelList::link(List &list, Link Slot::*link, uint32_t id) {
+    auto &node = slots[id].*link;
+    node.prev = NONE;
+    node.next = list.head;
+    if (list.head != NONE)
+        (slots[list.head].*link).prev = id;
+    list.head = id;
+    ++list.size;
+}
+
+void IRCChannelList::unlink(List &list, Link Slot::*link, uint32_t id) {
+    auto &node = slots[id].*link;
+    if (node.prev != NONE)
+        (slots[node.prev].*link).next = node.next;
+    else
+        list.head = node.next;
+    if (node.next != NONE)
+        (slots[node.next].*link).prev = node.prev;
+    node = Link{};
+    --list.size;
+}
+
+template <typename Func>
+void IRCChannelList::forEach(const List &list, Link Slot::*link, Func func) {
+    for (uint32_t id = list.head; id != NONE;) {
+        uint32_t next = (slots[id].*link).next;
+        func(id);
+        id = next;
+    }
+}
+
+void IRCChannelList::attach(uint32_t id, IRCSession *session) {
+    auto &channel = channelAt(id);
+    if (channel.getSession() == session)
+        return;
+    unlink(lists[channel.getSession()].channels, &Slot::bySession, id);
+    channel.attach(session);
+    link(lists[session].channels, &Slot::bySession, id);
+    trackChange(channel);
+}
+
+void IRCChannelList::setHandoff(uint32_t id, IRCSession *session) {
+    auto &channel = channelAt(id);
+    if (channel.getHandoff() == session)
+        return;
+    if (channel.getHandoff())
+        unlink(lists[channel.getHandoff()].handoffs, &Slot::byHandoff, id);
+    channel.setHandoff(session);
+    if (session)
+        link(lists[session].handoffs, &Slot::byHandoff, id);
+}
+
+void IRCChannelList::trackChange(const Channel &channel, bool removed) {
+    // full dump is pending anyway
+    if (fullDelta)
+        return;
+    auto *session = channel.getSession();
+    changed[channel.getName()] = removed ? Irc::ChannelsDelta::REMOVED
+                                         : session ? session->getId() : Irc::ChannelsDelta::DETACHED;
+}
@@ -10,9 +10,12 @@
 #include <string>
 #include <vector>
 #include <optional>
-#include <map>
+#include <unordered_map>
+
+#include "OpenHashIndex.h"
 
 #include "IRCClientConfig.h"
+#include "IRCStatistic.h"
 
 class Logger;
 class DBController;
@@ -25,28 +28,47 @@ class Channel {
     Channel(Channel && other) = default;
 
     void setJoined(bool join = true) { joined = join; };
+    void addActivity(unsigned int bytes) { activity += bytes; }
+    void decayActivity(double factor) { activity *= factor; }
 
     void attach(IRCSession *irc) { session = irc; }
     void detach() { session = nullptr; }
+    /// Session that stays joined until channel is joined by current one
+    void setHandoff(IRCSession *irc) { handoff = irc; }
 
     [[nodiscard]] bool attachedTo(IRCSession *irc) const { return session == irc; }
     [[nodiscard]] bool attached() const { return session != nullptr; }
 
     [[nodiscard]] const std::string& getName() const { return name; }
     [[nodiscard]] IRCSession * getSession() const { return session; }
+    [[nodiscard]] IRCSession * getHandoff() const { return handoff; }
     [[nodiscard]] bool getJoined() const { return joined; }
+    [[nodiscard]] double getActivity() const { return activity; }
   private:
     std::string name;
     IRCSession *session = nullptr;
+    IRCSession *handoff = nullptr;
     bool joined = false;
+    double activity = 0; // decayed received bytes, used as join priority and session load
 };
 
+// Channels of one account.
+// Channels live in slots addressed by id, open addressing index maps names to ids, and every channel is linked
+// into intrusive list of its session(unattached channels have own list) and of its handoff session,
+// so per-session operations touch only channels of that session.
 class IRCChannelList
 {
   public:
-    using Channels = std::map<std::string, Channel>;
     using Sessions = std::vector<std::shared_ptr<IRCSession>>;
-    using ChannelsToSessionId = std::vector<std::pair<std::string, unsigned int>>;
+    struct SessionLoad {
+        size_t channels = 0;
+        double activity = 0;
+    };
+    struct Migration {
+        std::string channel;
+        IRCSession *from = nullptr;
+        IRCSession *to = nullptr;
+    };
 
   public:
     IRCChannelList(const Sessions& sessions, const IRCClientConfig& cliConfig, std::shared_ptr<Logger> logger,  std::shared_ptr<DBController> db);
@@ -57,16 +79,82 @@ class IRCChannelList
     bool inList(const std::string& name);
     void addChannel(Channel channel);
     void removeChannel(const std::string& name);
-    void markChannelJoined(const std::string& name);
+    /// Returns session that handed channel off and must leave it now
+    IRCSession *markChannelJoined(const std::string& name);
     std::vector<std::string> selectNotJoinedChannels(const std::vector<std::string>& checkList);
     std::optional<Channel> extractChannel(const std::string& name);
 
+    /// Reserves share of unattached channels for session, balanced by activity with other free sessions
     std::vector<std::string> reserveChannelsForSession(IRCSession *session);
+    /// Reattaches channels from the most loaded logged in session to the least loaded one,
+    /// while the most loaded is above average load by more than band(fraction)
+    std::vector<Migration> rebalance(double band, size_t maxMoves);
+    /// Moves up to count coldest channels from sessions with most channels to session
+    std::vector<Migration> fill(IRCSession *session, size_t count);
+    /// Moves all channels of session to the least loaded logged in sessions from list
+    std::vector<Migration> evacuate(IRCSession *session);
+    [[nodiscard]] bool hasHandoffFrom(IRCSession *session);
+    /// Moves channels left on session to unattached list and forgets session, it is picked up on next login
+    void removeSession(IRCSession *session);
+    std::unordered_map<IRCSession *, SessionLoad> getSessionsLoad();
+    [[nodiscard]] SessionLoad getSessionLoad(IRCSession *session);
     void detachAndPartFromSession(IRCSession *session);
 
-    ChannelsToSessionId dumpChannelsToSessionId();
+    /// Channels attached to other session or removed since previous call, everything after load()
+    Irc::ChannelsDelta takeChannelsDelta();
+
+    void updateActivity(const std::unordered_map<std::string, unsigned int>& activity);
+    void decayActivity(double factor);
+    double getActivity(const std::string& name);
 
   private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Link {
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+    };
+
+    struct Slot {
+        std::optional<Channel> channel;
+        Link bySession; // list of channel session
+        Link byHandoff; // list of channel handoff session
+        uint32_t nextFree = NONE;
+    };
+
+    struct List {
+        uint32_t head = NONE;
+        size_t size = 0;
+    };
+
+    struct SessionLists {
+        List channels;
+        List handoffs;
+    };
+
+    struct NameOf {
+        const std::vector<Slot> *slots;
+        std::string_view operator()(uint32_t id) const { return (*slots)[id].channel->getName(); }
+    };
+
+    uint32_t find(const std::string &name) const;
+    uint32_t insert(Channel channel);
+    Channel erase(uint32_t id);
+    void clear();
+
+    void link(List &list, Link Slot::*link, uint32_t id);
+    void unlink(List &list, Link Slot::*link, uint32_t id);
+    /// Calls func(id) for every channel of list, current channel can be unlinked by func
+    template <typename Func>
+    void forEach(const List &list, Link Slot::*link, Func func);
+
+    /// Moves channel to session list, nullptr is the list of unattached channels
+    void attach(uint32_t id, IRCSession *session);
+    void setHandoff(uint32_t id, IRCSession *session);
+    void trackChange(const Channel &channel, bool removed = false);
+
+    Channel &channelAt(uint32_t id) { return *slots[id].channel; }
+
     const Sessions & sessions;
     const IRCClientConfig& cliConfig;
 
@@ -74,7 +162,14 @@ class IRCChannelList
     const std::shared_ptr<DBController> db;
 
     std::mutex mutex;
-    Channels channels;
+    std::vector<Slot> slots;
+    uint32_t freeSlots = NONE;
+    OpenHashIndex<NameOf> index{NameOf{&slots}};
+    std::unordered_map<IRCSession *, SessionLists> lists;
+
+    // stats export
+    bool fullDelta = true;
+    std::unordered_map<std::string, unsigned int> changed; // channel -> session id, DETACHED or REMOVED
 };
 
 #endif //CHATCONTROLLER__IRCCHANNELLIST_H_
@@ -2,43 +2,55 @@
 // Created by l2pic on 25.04.2021.
 //
 
+#include <algorithm>
 #include <cassert>
 #include <utility>
 
 #include <so_5/send_functions.hpp>
 
+#include "Clock.h"
 #include "Logger.h"
 #include "ThreadName.h"
 
-#include "../HttpNotifier.h"
+#include "../LatencyTracker.h"
 
+#include "IRCConnectAdmission.h"
 #include "IRCSelectorPool.h"
 #include "IRCClient.h"
 #include "IRCSession.h"
 
 #define MIN_SESS_COUNT 1
-#define LOGIN_TIMEOUT_MS 3000
 #define SESSION_JOIN_TIMEOUT_MS 3000
-#define PING_PERIOD_MS 2000
 #define STATS_PERIOD_MS 5000
+#define JOINS_PERIOD_MS 250
+#define ACTIVITY_DECAY 0.8 // per stats period
+#define RETIRE_CHECK_MS 1000
+#define RETIRE_ATTEMPTS 30
 #define PERIODIC_TIMER(time) std::chrono::milliseconds{time}, std::chrono::milliseconds{time}
 
 IRCClient::IRCClient(const context_t &ctx,
                      so_5::mbox_t statsCollector,
                      so_5::mbox_t processor,
+                     so_5::mbox_t admission,
                      IRCConnectionConfig conConfig,
                      IRCClientConfig cliConfig,
                      IRCSelectorPool *pool,
+                     IRCCapture *capture,
                      std::shared_ptr<Logger> logger,
-                     std::shared_ptr<DBController> db)
+                     std::shared_ptr<DBController> db,
+                     std::shared_ptr<LatencyTracker> latency)
     : so_5::agent_t(ctx),
       statsCollector(std::move(statsCollector)),
       processor(std::move(processor)),
+      admission(std::move(admission)),
       conConfig(std::move(conConfig)),
       cliConfig(std::move(cliConfig)),
       channels(sessions, this->cliConfig, logger, std::move(db)),
+      joins(IRCJoinSchedulerConfig{static_cast<unsigned int>(this->conConfig.join_limit), this->conConfig.join_period}),
       pool(pool),
-      logger(std::move(logger)) {
+      capture(capture),
+      logger(std::move(logger)),
+      latency(std::move(latency)) {
     assert(pool);
     loggerTag = fmt::format("IRCClient[{}/{}]", fmt::ptr(this) , this->cliConfig.nick);
     this->logger->logTrace("{} Client init", loggerTag);
@@ -50,6 +62,8 @@ IRCClient::~IRCClient() {
 
 void IRCClient::addNewSession() {
     auto session = std::make_shared<IRCSession>(conConfig, cliConfig, sessions.size(), this, this, logger.get());
+    session->setCapture(capture);
+    session->setTrace(&latency->trace());
 
     sessions.push_back(session);
     pool->addSession(session);
@@ -57,7 +71,7 @@ void IRCClient::addNewSession() {
     logger->logTrace("{} added new IRC session {}/{}",
                      loggerTag, sessions.size(), cliConfig.session_count);
 
-    so_5::send<Connect>(so_direct_mbox(), session.get(), 0);
+    requestConnect(session.get(), 0);
 }
 
 const std::string &IRCClient::nickname() const {
@@ -72,12 +86,17 @@ void IRCClient::so_define_agent() {
     so_subscribe_self().event(&IRCClient::evtLeaveChannel);
     so_subscribe_self().event(&IRCClient::evtSendMessage);
     so_subscribe_self().event(&IRCClient::evtSendIRC);
-    so_subscribe_self().event(&IRCClient::evtSendPING);
     so_subscribe_self().event(&IRCClient::evtGatherStats);
-    so_subscribe_self().event(&IRCClient::evtLoggedInCheck);
 
     so_subscribe_self().event(&IRCClient::evtChannelJoined);
     so_subscribe_self().event(&IRCClient::evtCheckJoinedChannels);
+    so_subscribe_self().event(&IRCClient::evtLoggedIn);
+    so_subscribe_self().event(&IRCClient::evtProcessJoins);
+    so_subscribe_self().event(&IRCClient::evtUpdateActivity);
+    so_subscribe_self().event(&IRCClient::evtRebalance);
+    so_subscribe_self().event(&IRCClient::evtScale);
+    so_subscribe_self().event(&IRCClient::evtRetireSession);
+    so_subscribe_self().event(&IRCClient::evtDisconnected);
 }
 
 void IRCClient::so_evt_start() {
@@ -91,6 +110,12 @@ void IRCClient::so_evt_start() {
     }
 
     statsTimer = so_5::send_periodic<GatherStats>(so_direct_mbox(), PERIODIC_TIMER(STATS_PERIOD_MS));
+    joinsTimer = so_5::send_periodic<ProcessJoins>(so_direct_mbox(), PERIODIC_TIMER(JOINS_PERIOD_MS));
+    if (conConfig.rebalance_period > 0)
+        rebalanceTimer = so_5::send_periodic<Rebalance>(so_direct_mbox(),
+                                                        PERIODIC_TIMER(conConfig.rebalance_period * 1000));
+    if (conConfig.scale_period > 0)
+        scaleTimer = so_5::send_periodic<Scale>(so_direct_mbox(), PERIODIC_TIMER(conConfig.scale_period * 1000));
 }
 
 void IRCClient::so_evt_finish() {
@@ -99,6 +124,10 @@ void IRCClient::so_evt_finish() {
 
         session->disconnect();
     }
+    for (auto &session: retiring) {
+        pool->removeSession(session);
+        session->disconnect();
+    }
 }
 
 void IRCClient::evtShutdown(so_5::mhood_t<Shutdown>) {
@@ -106,28 +135,36 @@ void IRCClient::evtShutdown(so_5::mhood_t<Shutdown>) {
 }
 
 void IRCClient::evtConnect(so_5::mhood_t<Connect> evt) {
-    if (evt->session->connected())
+    auto *session = findSession(evt->serial);
+    if (!session || session->connected()) {
+        so_5::send<IRCConnectAdmission::Release>(admission, evt->serial);
         return;
+    }
+
+    // channels are reserved again after login
+    joins.removeSession(session);
 
-    if (evt->session->connect()) {
+    if (session->connect()) {
         logger->logInfo("{} IRCSession({}) Successfully connected to {} with username: {}, password: {}",
-                        loggerTag, fmt::ptr(evt->session), conConfig.host, cliConfig.nick, cliConfig.password);
-        so_5::send_delayed<LoggedInCheck>(so_direct_mbox(), std::chrono::milliseconds(LOGIN_TIMEOUT_MS), evt->session);
+                        loggerTag, fmt::ptr(session), conConfig.host, cliConfig.nick, cliConfig.password);
         return;
     }
 
-    ++evt->attempt;
-
-    if (evt->attempt == conConfig.connect_attemps_limit) {
+    int attempt = evt->attempt + 1;
+    if (attempt == conConfig.connect_attemps_limit) {
         logger->logWarn("{} IRCSession({}) Reconnect limit reached, restart attempts",
-                        loggerTag, fmt::ptr(evt->session));
-        evt->attempt = 0;
+                        loggerTag, fmt::ptr(session));
+        attempt = 0;
     }
 
-    logger->logWarn("{} IRCSession({}) Failed to connect. Reconnection after {} seconds",
-                    loggerTag, fmt::ptr(evt->session), 2 * evt->attempt);
+    logger->logWarn("{} IRCSession({}) Failed to connect. Reconnection attempt {} is queued",
+                    loggerTag, fmt::ptr(session), attempt);
+    requestConnect(session, attempt);
+}
 
-    so_5::send_delayed(so_direct_mbox(), std::chrono::seconds(1 << evt->attempt), evt);
+void IRCClient::requestConnect(IRCSession *session, int attempt, double priority) {
+    so_5::send<IRCConnectAdmission::Request>(admission, so_direct_mbox(), session->getSerial(), priority, attempt,
+                                             cliConfig.auth_per_sec_limit);
 }
 
 void IRCClient::evtReload(so_5::mhood_t<Reload> evt) {
@@ -138,11 +175,16 @@ void IRCClient::evtReload(so_5::mhood_t<Reload> evt) {
 
     // clear current sessions
     for (auto &session: sessions) {
+        joins.removeSession(session.get());
         pool->removeSession(session);
-        session->setPingTimer({});
         session->disconnect();
     }
     sessions.clear();
+    for (auto &session: retiring) {
+        pool->removeSession(session);
+        session->disconnect();
+    }
+    retiring.clear();
 
     // reload channels list
     channels.load();
@@ -154,12 +196,6 @@ void IRCClient::evtReload(so_5::mhood_t<Reload> evt) {
     }
 }
 
-void IRCClient::evtLoggedInCheck(so_5::mhood_t<LoggedInCheck> evt) {
-    if (!evt->session->loggedIn()) {
-        evt->session->onDisconnected("LOGIN_TIMEOUT", fmt::format("Login timeout: {}ms", LOGIN_TIMEOUT_MS));
-    }
-}
-
 void IRCClient::evtJoinChannel(so_5::mhood_t<JoinChannel> evt) {
     joinToChannel(evt->channel, getNextConnectedSessionRoundRobin());
 }
@@ -169,7 +205,10 @@ void IRCClient::evtLeaveChannel(so_5::mhood_t<LeaveChannel> evt) {
 }
 
 void IRCClient::evtSendMessage(so_5::mhood_t<SendMessage> message) {
-    if (sendMessage(message->channel, message->text)) {
+    const long long begin = message->traceId ? LatencyTracker::now() : 0;
+    if (getNextConnectedSessionRoundRobin()->sendMessage(message->channel, message->text, message->traceId)) {
+        latency->record(LatencyTracker::Stage::Sent, message->readTime);
+        latency->trace().span(message->traceId, "irc.send", begin, LatencyTracker::now());
         logger->logInfo(R"({} Send to "{}" message: "{}")",
                         loggerTag, message->channel, message->text);
     } else {
@@ -186,36 +225,53 @@ void IRCClient::evtSendIRC(so_5::mhood_t<SendIRC> irc) {
     }
 }
 
-void IRCClient::evtSendPING(so_5::mhood_t<SendPING> evt) {
-    evt->session->sendPing(evt->host);
-}
-
 void IRCClient::evtGatherStats(so_5::mhood_t<GatherStats>) {
-    so_5::send<Irc::ClientChannelsMetrics>(statsCollector, cliConfig.nick, channels.dumpChannelsToSessionId());
+    // selector side statistic is shipped by sessions keepalive tick
+    for (auto &session: sessions)
+        session->shipStats();
+    for (auto &session: retiring)
+        session->shipStats();
+    channels.decayActivity(ACTIVITY_DECAY);
+    if (auto delta = channels.takeChannelsDelta(); delta.full || !delta.channels.empty())
+        so_5::send<Irc::ClientChannelsMetrics>(statsCollector, cliConfig.nick, std::move(delta));
+    so_5::send<Irc::ClientJoinMetrics>(statsCollector, cliConfig.nick, joins.collectStats());
 }
 
 void IRCClient::evtChannelJoined(so_5::mhood_t<ChannelJoined> evt) {
-    channels.markChannelJoined(evt->channel);
+    // channel is left by previous session only after it is joined by new one
+    if (auto *handoff = channels.markChannelJoined(evt->channel))
+        handoff->sendPart(evt->channel);
+    joins.joined(evt->channel, CurrentTime<std::chrono::steady_clock>::milliseconds());
 }
 
 void IRCClient::evtCheckJoinedChannels(so_5::mhood_t<CheckJoinedChannels> evt) {
+    // new check is started after next login
+    auto *session = findSession(evt->serial);
+    if (!session || !session->loggedIn())
+        return;
+
     auto rejoinList = channels.selectNotJoinedChannels(evt->channels);
     if (rejoinList.empty()) {
         logger->logInfo("{} IRCSession({}) All {} successfully channels joined",
-                        loggerTag, fmt::ptr(evt->session), evt->channels.size());
+                        loggerTag, fmt::ptr(session), evt->channels.size());
         return;
     }
 
+    // channels still waiting for rate limit are not failed, they are only checked again
+    size_t failed = 0;
     for (auto &channel: rejoinList) {
-        evt->session->sendPart(channel);
-        evt->session->sendJoin(channel);
+        if (!joins.isPending(channel)) {
+            scheduleJoin(channel, session);
+            ++failed;
+        }
     }
-    logger->logWarn("{} IRCSession({}) Some channels failed to join, try to rejoin({})",
-                    loggerTag, fmt::ptr(evt->session), rejoinList.size());
+    if (failed)
+        logger->logWarn("{} IRCSession({}) Some channels failed to join, try to rejoin({})",
+                        loggerTag, fmt::ptr(session), failed);
 
     // init joined channels check
     so_5::send_delayed<CheckJoinedChannels>(so_direct_mbox(), std::chrono::milliseconds(SESSION_JOIN_TIMEOUT_MS),
-                                            evt->session, std::move(rejoinList));
+                                            evt->serial, std::move(rejoinList));
 }
 
 bool IRCClient::sendQuit(const std::string &reason) {
@@ -313,13 +369,14 @@ void IRCClient::joinToChannel(const std::string &name, IRCSession *session) {
 
     Channel channel{name};
     channel.attach(session);
-    if (session->sendJoin(name)) {
-        logger->logInfo("{} IRCSession({}) Joining to channel({})",
-                        loggerTag, fmt::ptr(session), name);
-        channels.addChannel(std::move(channel));
-    } else
-        logger->logError("{} IRCSession({}) Failed to join to channel({})",
-                         loggerTag, fmt::ptr(session), name);
+    channels.addChannel(std::move(channel));
+    scheduleJoin(name, session);
+    logger->logInfo("{} IRCSession({}) Joining to channel({}), join backlog {}",
+                    loggerTag, fmt::ptr(session), name, joins.backlog());
+}
+
+void IRCClient::scheduleJoin(const std::string &name, IRCSession *session) {
+    joins.enqueue(session, name, channels.getActivity(name), CurrentTime<std::chrono::steady_clock>::milliseconds());
 }
 
 void IRCClient::leaveFromChannel(const std::string &name) {
@@ -329,6 +386,7 @@ void IRCClient::leaveFromChannel(const std::string &name) {
         return;
     }
 
+    joins.remove(name);
     logger->logInfo("{} Leaving from channel({})", loggerTag, name);
     channel->getSession()->sendPart(name);
 }
@@ -353,44 +411,221 @@ IRCSession *IRCClient::getNextConnectedSessionRoundRobin() {
     return session;
 }
 
+void IRCClient::evtProcessJoins(so_5::mhood_t<ProcessJoins>) {
+    for (auto &batch: joins.poll(CurrentTime<std::chrono::steady_clock>::milliseconds())) {
+        if (!batch.session->sendJoin(batch.channels))
+            logger->logError("{} IRCSession({}) Failed to join to {} channels",
+                             loggerTag, fmt::ptr(batch.session), batch.channels.size());
+    }
+}
+
+void IRCClient::evtUpdateActivity(so_5::mhood_t<UpdateActivity> evt) {
+    channels.updateActivity(evt->activity);
+}
+
+void IRCClient::evtRebalance(so_5::mhood_t<Rebalance>) {
+    // migrations are done in quiet window only, logins and rejoins go first
+    if (joins.backlog() > 0)
+        return;
+
+    migrate(channels.rebalance(conConfig.rebalance_band, conConfig.rebalance_moves));
+}
+
+void IRCClient::migrate(std::vector<IRCChannelList::Migration> &&migrations) {
+    // previous session leaves channel in evtChannelJoined
+    std::map<IRCSession *, std::vector<std::string>> moved;
+    for (auto &migration: migrations) {
+        logger->logInfo("{} Channel({}) migration from IRCSession({}) to IRCSession({})",
+                        loggerTag, migration.channel, fmt::ptr(migration.from), fmt::ptr(migration.to));
+        scheduleJoin(migration.channel, migration.to);
+        moved[migration.to].push_back(std::move(migration.channel));
+    }
+
+    for (auto &[session, list]: moved) {
+        so_5::send_delayed<CheckJoinedChannels>(so_direct_mbox(), std::chrono::milliseconds(SESSION_JOIN_TIMEOUT_MS),
+                                                session->getSerial(), std::move(list));
+    }
+}
+
+void IRCClient::evtScale(so_5::mhood_t<Scale>) {
+    // scale only in stable state, previous change has to be finished
+    if (!retiring.empty() || joins.backlog() > 0)
+        return;
+    for (auto &session: sessions) {
+        if (!session->loggedIn())
+            return;
+    }
+
+    size_t totalChannels = 0;
+    double totalActivity = 0;
+    for (auto &[session, load]: channels.getSessionsLoad()) {
+        totalChannels += load.channels;
+        totalActivity += load.activity;
+    }
+    unsigned long long totalRtt = 0;
+    for (auto &session: sessions) {
+        // tail is empty until the first PONG after login
+        auto tail = session->getRttTail();
+        totalRtt += tail ? tail : session->getRtt();
+    }
+
+    // decayed activity converges to rate * period / (1 - decay)
+    auto count = static_cast<double>(sessions.size());
+    double rate = totalActivity * (1.0 - ACTIVITY_DECAY) * 1000.0 / STATS_PERIOD_MS;
+    double channelsPerSession = static_cast<double>(totalChannels) / count;
+    double ratePerSession = rate / count;
+    double rtt = static_cast<double>(totalRtt) / count;
+
+    size_t minSessions = std::max(MIN_SESS_COUNT, cliConfig.session_count);
+    size_t maxSessions = std::max<size_t>(minSessions, conConfig.scale_max_sessions);
+    bool overloaded = channelsPerSession > conConfig.scale_channels ||
+                      ratePerSession > conConfig.scale_bytes_rate ||
+                      rtt > conConfig.scale_rtt;
+    // load of one session less stays under half of limits, to avoid flapping
+    bool underloaded = count > 1 &&
+                       static_cast<double>(totalChannels) / (count - 1) < conConfig.scale_channels / 2.0 &&
+                       rate / (count - 1) < conConfig.scale_bytes_rate / 2.0 &&
+                       rtt < conConfig.scale_rtt / 2.0;
+
+    if (overloaded && sessions.size() < maxSessions) {
+        logger->logInfo("{} Scale up to {} sessions: {:.1f} channels, {:.0f} bytes/s, {:.0f}ms p90 RTT per session",
+                        loggerTag, sessions.size() + 1, channelsPerSession, ratePerSession, rtt);
+        addNewSession();
+    } else if (underloaded && sessions.size() > minSessions) {
+        logger->logInfo("{} Scale down to {} sessions: {:.1f} channels, {:.0f} bytes/s, {:.0f}ms p90 RTT per session",
+                        loggerTag, sessions.size() - 1, channelsPerSession, ratePerSession, rtt);
+        retireSession();
+    }
+}
+
+void IRCClient::retireSession() {
+    // the last one keeps session ids dense
+    auto session = sessions.back();
+    sessions.pop_back();
+    retiring.push_back(session);
+
+    joins.removeSession(session.get());
+    migrate(channels.evacuate(session.get()));
+    so_5::send_delayed<RetireSession>(so_direct_mbox(), std::chrono::milliseconds(RETIRE_CHECK_MS),
+                                      session->getSerial(), 0);
+}
+
+void IRCClient::evtRetireSession(so_5::mhood_t<RetireSession> evt) {
+    // session is dropped from retiring list by reload
+    auto it = std::find_if(retiring.begin(), retiring.end(), [&evt] (const auto &session) {
+        return session->getSerial() == evt->serial;
+    });
+    if (it == retiring.end())
+        return;
+    auto *session = it->get();
+
+    if (channels.hasHandoffFrom(session) && evt->attempt < RETIRE_ATTEMPTS) {
+        so_5::send_delayed<RetireSession>(so_direct_mbox(), std::chrono::milliseconds(RETIRE_CHECK_MS),
+                                          evt->serial, evt->attempt + 1);
+        return;
+    }
+
+    // channels returned to session by failed handoff are moved again without waiting,
+    // the ones without logged in session to take them wait in unattached list for next login
+    migrate(channels.evacuate(session));
+    channels.removeSession(session);
+
+    logger->logInfo("{} IRCSession({}) retired", loggerTag, fmt::ptr(session));
+    pool->removeSession(*it);
+    (*it)->disconnect();
+    retiring.erase(it);
+}
+
+IRCSession *IRCClient::findSession(unsigned long long serial) const {
+    auto it = std::find_if(sessions.begin(), sessions.end(), [serial] (const auto &session) {
+        return session->getSerial() == serial;
+    });
+    return it != sessions.end() ? it->get() : nullptr;
+}
+
 void IRCClient::onLoggedIn(IRCSession *session) {
+    // join scheduler is owned by agent thread
+    so_5::send<LoggedIn>(so_direct_mbox(), session->getSerial());
+}
+
+void IRCClient::evtLoggedIn(so_5::mhood_t<LoggedIn> evt) {
+    so_5::send<IRCConnectAdmission::Release>(admission, evt->serial);
+    auto *session = findSession(evt->serial);
+    if (!session)
+        return;
+
     auto reservedChannels = channels.reserveChannelsForSession(session);
     for (auto &channel: reservedChannels) {
-        session->sendJoin(channel);
+        scheduleJoin(channel, session);
+    }
+    logger->logInfo("{} IRCSession({}) logged in. Joining to {} channels, join backlog {}",
+                    loggerTag, fmt::ptr(session), reservedChannels.size(), joins.backlog());
+
+    // session added by scale up takes its share from running sessions
+    if (reservedChannels.empty() && sessions.size() > 1) {
+        size_t share = 0;
+        for (auto &[other, load]: channels.getSessionsLoad())
+            share += load.channels;
+        share /= sessions.size();
+        migrate(channels.rebalance(0.0, share));
+        migrate(channels.fill(session, share));
     }
-    logger->logInfo("{} IRCSession({}) logged in. Joining to {} channels",
-                    loggerTag, fmt::ptr(session), reservedChannels.size());
-
-    // session is owner of it's send ping timer
-    session->setPingTimer(
-        so_5::send_periodic<SendPING>(so_direct_mbox(), PERIODIC_TIMER(PING_PERIOD_MS), session, "tmi.twitch.tv")
-    );
 
     // init joined channels check
     so_5::send_delayed<CheckJoinedChannels>(so_direct_mbox(), std::chrono::milliseconds(SESSION_JOIN_TIMEOUT_MS),
-                                            session, std::move(reservedChannels));
+                                            evt->serial, std::move(reservedChannels));
 }
 
 void IRCClient::onDisconnected(IRCSession *session, std::string_view reason) {
+    // channels and sessions list are owned by agent thread
+    so_5::send<Disconnected>(so_direct_mbox(), session->getSerial(), std::string(reason));
+}
+
+void IRCClient::evtDisconnected(so_5::mhood_t<Disconnected> evt) {
+    auto *session = findSession(evt->serial);
+    auto retired = std::find_if(retiring.begin(), retiring.end(), [&evt] (const auto &session) {
+        return session->getSerial() == evt->serial;
+    });
+    if (retired != retiring.end())
+        session = retired->get();
+    if (!session)
+        return; // dropped by reload
+
+    // sessions with busy channels are reconnected first
+    double priority = channels.getSessionLoad(session).activity;
     channels.detachAndPartFromSession(session);
 
+    // notification is sent by admission, reconnect storm is reported once
+    so_5::send<IRCConnectAdmission::Disconnected>(admission, cliConfig.nick, session->getId(), evt->reason);
+
+    // retiring session only stops to be handoff of its channels
+    if (retired != retiring.end()) {
+        logger->logInfo("{} IRCSession({}) Disconnected while retiring", loggerTag, fmt::ptr(session));
+        return;
+    }
+
     logger->logInfo("{} IRCSession({}) Disconnected. Trying to reconnect",
                     loggerTag, fmt::ptr(session));
-
-    so_5::send<SlackNotifier::Notify>(GET_NOTIFIER_MBOX(), SlackNotifier::Type::Warning,
-                                      fmt::format("IRCClient[{}/{}] Disconnected: {}",
-                                                  cliConfig.nick, session->getId(), reason));
-    so_5::send<Connect>(so_direct_mbox(), session, 0);
+    requestConnect(session, 0, priority);
 }
 
 void IRCClient::onMessage(IRCMessage &&message) {
+    // IRCSelector thread, read span lasts from socket read to hand over to MessageProcessor
+    auto &trace = latency->trace();
+    const uint64_t traceId = message.traceId = trace.sample();
+    const long long readTime = message.readTime;
     so_5::send<IRCMessage>(processor, std::move(message));
+    trace.span(traceId, "irc.read", readTime, LatencyTracker::now());
 }
 
 void IRCClient::onJoined(IRCSession *session, std::string_view channel) {
-    so_5::send<ChannelJoined>(so_direct_mbox(), session, std::string(channel));
+    so_5::send<ChannelJoined>(so_direct_mbox(), session->getSerial(), std::string(channel));
 }
 
 void IRCClient::onStatistics(IRCSession *session, IRCStatistic &&stats) {
     so_5::send<Irc::SessionMetrics>(statsCollector, session->getId(), cliConfig.nick, std::move(stats));
 }
+
+void IRCClient::onChannelsActivity(IRCSession *, ChannelsActivity &&activity) {
+    so_5::send<UpdateActivity>(so_direct_mbox(), std::move(activity));
+}
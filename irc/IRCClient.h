@@ -18,39 +18,51 @@
 #include "IRCConnectionConfig.h"
 #include "IRCClientConfig.h"
 #include "IRCChannelList.h"
+#include "IRCJoinScheduler.h"
 #include "IRCStatistic.h"
 #include "IRCSessionInterface.h"
 
 class Logger;
 class DBController;
+class LatencyTracker;
 class IRCSession;
 class IRCSelectorPool;
+class IRCCapture;
 class IRCClient final : public so_5::agent_t,
                         public IRCSessionInterface,
                         public IRCSessionListener
 {
   public:
-    struct Connect { IRCSession *session = nullptr; mutable int attempt = 0; };
-    struct LoggedInCheck { IRCSession *session = nullptr; };
+    // sessions are referred by serial, address of destroyed session can be reused by new one
+    struct Connect { unsigned long long serial = 0; mutable int attempt = 0; };
     struct Reload { IRCClientConfig config; };
     struct Shutdown final : so_5::signal_t {};
     struct JoinChannel { std::string channel; };
     struct LeaveChannel { std::string channel; };
-    struct SendPING { IRCSession *session = nullptr; std::string host; };
-    struct SendMessage { std::string channel; std::string text; };
+    struct SendMessage { std::string channel; std::string text; long long readTime = 0; uint64_t traceId = 0; };
     struct SendIRC { std::string message; };
     struct GatherStats final : so_5::signal_t {};
-    struct ChannelJoined {IRCSession *session = nullptr; std::string channel;};
-    struct CheckJoinedChannels { IRCSession *session = nullptr; std::vector<std::string> channels; };
+    struct ChannelJoined { unsigned long long serial = 0; std::string channel; };
+    struct CheckJoinedChannels { unsigned long long serial = 0; std::vector<std::string> channels; };
+    struct LoggedIn { unsigned long long serial = 0; };
+    struct ProcessJoins final : so_5::signal_t {};
+    struct Rebalance final : so_5::signal_t {};
+    struct Scale final : so_5::signal_t {};
+    struct RetireSession { unsigned long long serial = 0; int attempt = 0; };
+    struct UpdateActivity { ChannelsActivity activity; };
+    struct Disconnected { unsigned long long serial = 0; std::string reason; };
   public:
     IRCClient(const context_t &ctx,
               so_5::mbox_t statsCollector,
               so_5::mbox_t processor,
+              so_5::mbox_t admission,
               IRCConnectionConfig conConfig,
               IRCClientConfig cliConfig,
               IRCSelectorPool *pool,
+              IRCCapture *capture,
               std::shared_ptr<Logger> logger,
-              std::shared_ptr<DBController> db);
+              std::shared_ptr<DBController> db,
+              std::shared_ptr<LatencyTracker> latency);
     ~IRCClient() override;
 
     IRCClient(IRCClient&) = delete;
@@ -67,16 +79,21 @@ class IRCClient final : public so_5::agent_t,
     void evtConnect(so_5::mhood_t<Connect> evt);
     void evtShutdown(so_5::mhood_t<Shutdown> evt);
     void evtReload(so_5::mhood_t<Reload> evt);
-    void evtLoggedInCheck(so_5::mhood_t<LoggedInCheck> evt);
     void evtJoinChannel(so_5::mhood_t<JoinChannel> evt);
     void evtLeaveChannel(so_5::mhood_t<LeaveChannel> evt);
     void evtSendMessage(so_5::mhood_t<SendMessage> evt);
     void evtSendIRC(so_5::mhood_t<SendIRC> evt);
-    void evtSendPING(so_5::mhood_t<SendPING> evt);
 
     void evtGatherStats(so_5::mhood_t<GatherStats> evt);
     void evtChannelJoined(so_5::mhood_t<ChannelJoined> evt);
     void evtCheckJoinedChannels(so_5::mhood_t<CheckJoinedChannels> evt);
+    void evtLoggedIn(so_5::mhood_t<LoggedIn> evt);
+    void evtProcessJoins(so_5::mhood_t<ProcessJoins> evt);
+    void evtUpdateActivity(so_5::mhood_t<UpdateActivity> evt);
+    void evtRebalance(so_5::mhood_t<Rebalance> evt);
+    void evtScale(so_5::mhood_t<Scale> evt);
+    void evtRetireSession(so_5::mhood_t<RetireSession> evt);
+    void evtDisconnected(so_5::mhood_t<Disconnected> evt);
 
     // IRCSessionInterface implementation
     bool sendQuit(const std::string &reason) override;
@@ -106,27 +123,42 @@ class IRCClient final : public so_5::agent_t,
     void onMessage(IRCMessage &&message) override;
     void onJoined(IRCSession *session, std::string_view channel) override;
     void onStatistics(IRCSession* session, IRCStatistic&& stats) override;
+    void onChannelsActivity(IRCSession* session, ChannelsActivity&& activity) override;
   private:
     void addNewSession();
     void joinToChannel(const std::string &name, IRCSession *session);
     void leaveFromChannel(const std::string &name);
+    void scheduleJoin(const std::string &name, IRCSession *session);
+    void migrate(std::vector<IRCChannelList::Migration> &&migrations);
+    void retireSession();
+    /// Returns active(not retiring) session, nullptr if it is gone
+    [[nodiscard]] IRCSession * findSession(unsigned long long serial) const;
+    void requestConnect(IRCSession *session, int attempt, double priority = 0);
     IRCSession * getNextSessionRoundRobin();
     IRCSession * getNextConnectedSessionRoundRobin();
 
     so_5::mbox_t statsCollector;
     so_5::mbox_t processor;
+    so_5::mbox_t admission;
     so_5::timer_id_t statsTimer;
+    so_5::timer_id_t joinsTimer;
+    so_5::timer_id_t rebalanceTimer;
+    so_5::timer_id_t scaleTimer;
 
     const IRCConnectionConfig conConfig;
     IRCClientConfig cliConfig;
     IRCChannelList channels;
+    IRCJoinScheduler joins;
 
     IRCSelectorPool *pool;
+    IRCCapture *capture; // nullptr if capture is disabled
     const std::shared_ptr<Logger> logger;
+    const std::shared_ptr<LatencyTracker> latency;
     std::string loggerTag;
 
     unsigned int curSessionRoundRobin = 0;
     std::vector<std::shared_ptr<IRCSession>> sessions;
+    std::vector<std::shared_ptr<IRCSession>> retiring; // leaving channels to other sessions
 };
 
 #endif //CHATCONTROLLER_IRC_IRCCLIENT_H_
@@ -0,0 +1,179 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+
+#include <so_5/send_functions.hpp>
+
+#include "Clock.h"
+#include "Logger.h"
+
+#include "../HttpNotifier.h"
+
+#include "IRCClient.h"
+#include "IRCConnectAdmission.h"
+
+#define TICK_PERIOD_MS 100
+#define STATS_PERIOD_MS 5000
+#define INFLIGHT_TIMEOUT_MS 10000 // slot of connect without login or release
+#define PERIODIC_TIMER(time) std::chrono::milliseconds{time}, std::chrono::milliseconds{time}
+
+IRCConnectAdmission::IRCConnectAdmission(const context_t &ctx, so_5::mbox_t statsCollector,
+                                         IRCConnectionConfig config, std::shared_ptr<Logger> logger)
+  : so_5::agent_t(ctx), config(std::move(config)), logger(std::move(logger)),
+    statsCollector(std::move(statsCollector)) {
+}
+
+void IRCConnectAdmission::so_define_agent() {
+    so_subscribe_self().event(&IRCConnectAdmission::evtRequest);
+    so_subscribe_self().event(&IRCConnectAdmission::evtRelease);
+    so_subscribe_self().event(&IRCConnectAdmission::evtDisconnected);
+    so_subscribe_self().event(&IRCConnectAdmission::evtTick);
+    so_subscribe_self().event(&IRCConnectAdmission::evtGatherStats);
+}
+
+void IRCConnectAdmission::so_evt_start() {
+    tickTimer = so_5::send_periodic<Tick>(so_direct_mbox(), PERIODIC_TIMER(TICK_PERIOD_MS));
+    statsTimer = so_5::send_periodic<GatherStats>(so_direct_mbox(), PERIODIC_TIMER(STATS_PERIOD_MS));
+}
+
+void IRCConnectAdmission::evtRequest(so_5::mhood_t<Request> evt) {
+    inflight.erase(evt->serial);
+
+    auto time = now();
+    long long delay = backoff(evt->serial, evt->attempt);
+    auto it = std::find_if(queue.begin(), queue.end(), [&evt] (const Pending &pending) {
+        return pending.request.serial == evt->serial;
+    });
+    if (it != queue.end())
+        *it = Pending{*evt, time + delay};
+    else
+        queue.push_back(Pending{*evt, time + delay});
+
+    logger->logTrace("IRCConnectAdmission IRCSession(#{}) connect queued, attempt {}, delay {}ms, queue {}",
+                     evt->serial, evt->attempt, delay, queue.size());
+}
+
+void IRCConnectAdmission::evtRelease(so_5::mhood_t<Release> evt) {
+    // released after login, so backoff starts from the beginning
+    inflight.erase(evt->serial);
+    delays.erase(evt->serial);
+}
+
+void IRCConnectAdmission::evtDisconnected(so_5::mhood_t<Disconnected> evt) {
+    auto time = now();
+    disconnects.push_back(time);
+    ++metrics.disconnects;
+    updateStorm(time);
+
+    if (storm) {
+        ++stormDisconnects;
+        return;
+    }
+
+    so_5::send<SlackNotifier::Notify>(GET_NOTIFIER_MBOX(), SlackNotifier::Type::Warning,
+                                      fmt::format("IRCClient[{}/{}] Disconnected: {}",
+                                                  evt->nick, evt->sessionId, evt->reason));
+}
+
+void IRCConnectAdmission::evtTick(so_5::mhood_t<Tick>) {
+    auto time = now();
+    updateStorm(time);
+
+    for (auto it = inflight.begin(); it != inflight.end();) {
+        if (it->second + INFLIGHT_TIMEOUT_MS <= time)
+            it = inflight.erase(it);
+        else
+            ++it;
+    }
+    while (!granted.empty() && granted.front() + 1000 <= time)
+        granted.pop_front();
+    for (auto &[id, times]: accountGranted) {
+        while (!times.empty() && times.front() + 1000 <= time)
+            times.pop_front();
+    }
+
+    auto ready = std::partition(queue.begin(), queue.end(), [time] (const Pending &pending) {
+        return pending.ready <= time;
+    });
+    // sessions with the most active channels reconnect first
+    std::sort(queue.begin(), ready, [] (const Pending &lhs, const Pending &rhs) {
+        if (lhs.request.priority != rhs.request.priority)
+            return lhs.request.priority > rhs.request.priority;
+        return lhs.ready < rhs.ready;
+    });
+
+    std::vector<Pending> left;
+    for (auto it = queue.begin(); it != ready; ++it) {
+        auto &request = it->request;
+        auto &account = accountGranted[request.client->id()];
+        bool allowed = inflight.size() < static_cast<size_t>(config.connect_concurrency) &&
+                       granted.size() < static_cast<size_t>(config.connect_per_sec) &&
+                       (request.authLimit <= 0 || account.size() < static_cast<size_t>(request.authLimit));
+        if (!allowed) {
+            left.push_back(std::move(*it));
+            continue;
+        }
+
+        inflight[request.serial] = time;
+        granted.push_back(time);
+        account.push_back(time);
+        ++metrics.granted;
+        so_5::send<IRCClient::Connect>(request.client, request.serial, request.attempt);
+    }
+    std::move(ready, queue.end(), std::back_inserter(left));
+    queue.swap(left);
+}
+
+void IRCConnectAdmission::evtGatherStats(so_5::mhood_t<GatherStats>) {
+    metrics.storm = storm;
+    metrics.queued = queue.size();
+    metrics.inflight = inflight.size();
+    so_5::send<Metrics>(statsCollector, metrics);
+    metrics = {};
+}
+
+long long IRCConnectAdmission::now() {
+    return CurrentTime<std::chrono::steady_clock>::milliseconds();
+}
+
+long long IRCConnectAdmission::backoff(unsigned long long serial, int attempt) {
+    // first reconnect is only spread to break lockstep of sessions dropped together
+    if (attempt == 0) {
+        delays.erase(serial);
+        return std::uniform_int_distribution<long long>(0, config.connect_backoff_base)(random);
+    }
+
+    // decorrelated jitter: random between base and three times previous delay
+    auto &delay = delays[serial];
+    long long prev = std::max<long long>(delay, config.connect_backoff_base);
+    delay = std::min<long long>(config.connect_backoff_cap,
+                                std::uniform_int_distribution<long long>(config.connect_backoff_base, prev * 3)(random));
+    return delay;
+}
+
+void IRCConnectAdmission::updateStorm(long long time) {
+    while (!disconnects.empty() && disconnects.front() + config.storm_window <= time)
+        disconnects.pop_front();
+
+    if (!storm && disconnects.size() >= static_cast<size_t>(config.storm_threshold)) {
+        storm = true;
+        stormStart = time;
+        stormDisconnects = 0;
+        ++metrics.storms;
+        logger->logWarn("IRCConnectAdmission Reconnect storm started, {} disconnects in {}ms",
+                        disconnects.size(), config.storm_window);
+        so_5::send<SlackNotifier::Notify>(GET_NOTIFIER_MBOX(), SlackNotifier::Type::Error,
+                                          fmt::format("IRC reconnect storm: {} sessions disconnected in {}s, "
+                                                      "{} connects queued",
+                                                      disconnects.size(), config.storm_window / 1000, queue.size()));
+    } else if (storm && disconnects.empty() && queue.empty() && inflight.empty()) {
+        storm = false;
+        logger->logInfo("IRCConnectAdmission Reconnect storm finished after {}ms", time - stormStart);
+        so_5::send<SlackNotifier::Notify>(GET_NOTIFIER_MBOX(), SlackNotifier::Type::Info,
+                                          fmt::format("IRC reconnect storm finished: {} more disconnects, "
+                                                      "all sessions reconnected in {}s",
+                                                      stormDisconnects, (time - stormStart) / 1000));
+    }
+}
@@ -0,0 +1,99 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_IRC_IRCCONNECTADMISSION_H_
+#define CHATCONTROLLER_IRC_IRCCONNECTADMISSION_H_
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <so_5/agent.hpp>
+#include <so_5/timers.hpp>
+
+#include "IRCConnectionConfig.h"
+
+class Logger;
+// Process wide admission of IRC connects for all accounts.
+// Requests are queued with decorrelated jitter backoff and granted by channels priority,
+// while concurrent connects(not logged in yet), connects per second and per account auth limits allow.
+// Disconnects are counted to detect reconnect storms, storm is reported as one notification.
+class IRCConnectAdmission final : public so_5::agent_t
+{
+  public:
+    struct Request {
+        so_5::mbox_t client;
+        unsigned long long serial = 0; // IRCSession::getSerial()
+        double priority = 0;  // activity of session channels
+        int attempt = 0;      // failed attempts in a row, 0 resets backoff
+        int authLimit = 0;    // account logins per second, 0 is unlimited
+    };
+    struct Release { unsigned long long serial = 0; };
+    struct Disconnected { std::string nick; unsigned int sessionId = 0; std::string reason; };
+    struct Metrics {
+        bool storm = false;
+        size_t queued = 0;
+        size_t inflight = 0;
+        unsigned int granted = 0;
+        unsigned int disconnects = 0;
+        unsigned int storms = 0;
+    };
+    struct Tick final : so_5::signal_t {};
+    struct GatherStats final : so_5::signal_t {};
+
+  public:
+    IRCConnectAdmission(const context_t &ctx,
+                        so_5::mbox_t statsCollector,
+                        IRCConnectionConfig config,
+                        std::shared_ptr<Logger> logger);
+    ~IRCConnectAdmission() override = default;
+
+    // implementation so_5::agent_t
+    void so_define_agent() override;
+    void so_evt_start() override;
+
+    // so_5 events
+    void evtRequest(so_5::mhood_t<Request> evt);
+    void evtRelease(so_5::mhood_t<Release> evt);
+    void evtDisconnected(so_5::mhood_t<Disconnected> evt);
+    void evtTick(so_5::mhood_t<Tick> evt);
+    void evtGatherStats(so_5::mhood_t<GatherStats> evt);
+
+  private:
+    struct Pending {
+        Request request;
+        long long ready = 0; // steady clock milliseconds
+    };
+
+    static long long now();
+    long long backoff(unsigned long long serial, int attempt);
+    void updateStorm(long long time);
+
+    const IRCConnectionConfig config;
+    const std::shared_ptr<Logger> logger;
+    so_5::mbox_t statsCollector;
+
+    std::vector<Pending> queue;
+    std::unordered_map<unsigned long long, long long> inflight; // session serial -> grant time
+    std::unordered_map<unsigned long long, long long> delays;   // last backoff of session
+    std::deque<long long> granted;                        // grant times during last second
+    std::map<so_5::mbox_id_t, std::deque<long long>> accountGranted;
+
+    std::deque<long long> disconnects; // disconnect times inside storm window
+    bool storm = false;
+    long long stormStart = 0;
+    unsigned int stormDisconnects = 0;
+
+    std::mt19937 random{std::random_device{}()};
+    Metrics metrics;
+
+    so_5::timer_id_t tickTimer;
+    so_5::timer_id_t statsTimer;
+};
+
+#endif //CHATCONTROLLER_IRC_IRCCONNECTADMISSION_H_
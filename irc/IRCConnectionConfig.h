@@ -6,12 +6,40 @@
 #define CHATCONTROLLER_IRC_IRCCONNECTIONCONFIG_H_
 
 #include <string>
+#include <vector>
 
 struct IRCConnectionConfig {
     std::string host;
     int port = 6667;
     int threads = 1;
+    std::vector<int> selector_cpus;       // irc_selector_N pinned to selector_cpus[N % size], empty disables
+    int selector_rebalance_period = 60;   // seconds, 0 disables sessions migration between selectors
+    double selector_rebalance_band = 0.25; // allowed selector load above average
+    std::string capture_path;         // directory for inbound lines capture, empty disables
+    int capture_segment_size = 64;    // megabytes of compressed segment before rotation
+    int capture_segments = 16;        // kept segments, 0 keeps all
+    int capture_queue = 100000;       // lines waiting for capture writer, extra lines are dropped
+    int keepalive_idle = 5000;        // milliseconds without inbound data before PING
+    int keepalive_timeout = 10000;    // milliseconds to wait for PONG before reconnect
+    int keepalive_probe = 30000;      // milliseconds, PING busy session anyway to measure RTT, 0 disables
+    int reconnect_rtt = 3000;         // milliseconds, reconnect session if its recent p90 RTT is above, 0 disables
     int connect_attemps_limit = 30;
+    int connect_concurrency = 10;     // connects waiting for login, process wide
+    int connect_per_sec = 5;          // process wide
+    int connect_backoff_base = 1000;  // milliseconds
+    int connect_backoff_cap = 60000;  // milliseconds
+    int storm_threshold = 10;         // disconnects inside storm_window to report storm
+    int storm_window = 10000;         // milliseconds
+    int join_limit = 20;      // channels per join_period for one account
+    int join_period = 10000;  // milliseconds
+    int rebalance_period = 60;    // seconds, 0 disables channels rebalancing
+    double rebalance_band = 0.25; // allowed session load above average
+    int rebalance_moves = 2;      // channels migrated per period
+    int scale_period = 30;          // seconds, 0 disables sessions autoscaling
+    int scale_max_sessions = 8;     // upper bound, configured session_count is lower bound
+    int scale_channels = 100;       // channels per session
+    int scale_bytes_rate = 262144;  // inbound bytes per second per session
+    int scale_rtt = 1000;           // average of sessions p90 PING/PONG RTT in milliseconds
 };
 
 #endif //CHATCONTROLLER_IRC_IRCCONNECTIONCONFIG_H_
@@ -10,20 +10,27 @@
 #include "ThreadName.h"
 
 #include "../DBController.h"
+#include "IRCCapture.h"
+#include "IRCConnectAdmission.h"
 #include "IRCController.h"
 #include "IRCStatistic.h"
 
 using json = nlohmann::json;
 
+#define STATS_PERIOD_MS 5000
+#define PERIODIC_TIMER(time) std::chrono::milliseconds{time}, std::chrono::milliseconds{time}
+
 IRCController::IRCController(const context_t &ctx,
                              so_5::mbox_t processor,
                              so_5::mbox_t statsCollector,
                              so_5::mbox_t http,
                              const IRCConnectionConfig &conConfig,
                              std::shared_ptr<DBController> db,
+                             std::shared_ptr<LatencyTracker> latency,
                              std::shared_ptr<Logger> logger)
   : so_5::agent_t(ctx), processor(std::move(processor)), statsCollector(std::move(statsCollector)),
-    http(std::move(http)), logger(logger), db(std::move(db)), config(conConfig), pool(logger) {
+    http(std::move(http)), logger(logger), db(std::move(db)), latency(std::move(latency)),
+    config(conConfig), pool(logger) {
 
 }
 
@@ -32,6 +39,8 @@ IRCController::~IRCController() = default;
 void IRCController::so_define_agent() {
     // from BotEngine
     so_subscribe_self().event(&IRCController::evtSendMessage, so_5::thread_safe);
+    so_subscribe_self().event(&IRCController::evtGatherStats);
+    so_subscribe_self().event(&IRCController::evtRebalanceSelectors);
 
     // from http controller
     so_subscribe(http).event(&IRCController::evtHttpReload);
@@ -47,11 +56,31 @@ void IRCController::so_define_agent() {
 void IRCController::so_evt_start() {
     set_thread_name("irc_controller");
 
-    pool.init(config.threads);
+    if (!config.capture_path.empty()) {
+        capture = std::make_unique<IRCCapture>(IRCCaptureConfig{config.capture_path,
+                                                                static_cast<size_t>(config.capture_segment_size) << 20,
+                                                                static_cast<unsigned int>(config.capture_segments),
+                                                                static_cast<size_t>(config.capture_queue)},
+                                               logger);
+        if (!capture->start())
+            capture.reset();
+    }
+
+    pool.init(config.threads, config.selector_cpus);
+    statsTimer = so_5::send_periodic<GatherStats>(so_direct_mbox(), PERIODIC_TIMER(STATS_PERIOD_MS));
+    if (config.selector_rebalance_period > 0) {
+        rebalanceTimer = so_5::send_periodic<RebalanceSelectors>(so_direct_mbox(),
+                                                                 PERIODIC_TIMER(config.selector_rebalance_period * 1000));
+    }
 
     ircSendPool = so_5::disp::thread_pool::make_dispatcher(so_environment(), "irc_client", config.threads);
     ircSendPoolParams = {};
 
+    auto *admissionAgent = so_5::introduce_child_coop(*this, [this] (so_5::coop_t &coop) {
+        return coop.make_agent<IRCConnectAdmission>(statsCollector, config, logger);
+    });
+    admission = admissionAgent->so_direct_mbox();
+
     auto accounts = this->db->loadAccounts();
     for (auto &account : accounts)
         addNewIrcClient(account);
@@ -65,8 +94,8 @@ void IRCController::so_evt_finish() {
 void IRCController::addNewIrcClient(const IRCClientConfig& cliConfig) {
     auto *ircClient = so_5::introduce_child_coop(*this, [&cliConfig, this] (so_5::coop_t &coop) {
         return coop.make_agent_with_binder<IRCClient>(ircSendPool.binder(ircSendPoolParams),
-                                                      statsCollector, processor, config, cliConfig,
-                                                      &pool, logger, db);
+                                                      statsCollector, processor, admission, config, cliConfig,
+                                                      &pool, capture.get(), logger, db, latency);
     });
 
     ircClientsByName.emplace(cliConfig.nick, ircClient);
@@ -93,10 +122,26 @@ void IRCController::evtSendMessage(mhood_t<Chat::SendMessage> message) {
         logger->logWarn("Failed to find IRC worker for account: {}", message->user);
         return;
     }
-    so_5::send<IRCClient::SendMessage>(client->so_direct_mbox(), message->channel, message->text);
+    so_5::send<IRCClient::SendMessage>(client->so_direct_mbox(), message->channel, message->text,
+                                       message->readTime, message->traceId);
     so_5::send(statsCollector, message);
 }
 
+void IRCController::evtGatherStats(mhood_t<GatherStats> /*evt*/) {
+    so_5::send<Irc::SelectorsMetrics>(statsCollector, pool.collectStats());
+
+    if (capture) {
+        auto stats = capture->getStats();
+        if (stats.dropped > captureDropped)
+            logger->logWarn("IRCController Capture dropped {} lines, writer can't keep up", stats.dropped - captureDropped);
+        captureDropped = stats.dropped;
+    }
+}
+
+void IRCController::evtRebalanceSelectors(mhood_t<RebalanceSelectors> /*evt*/) {
+    pool.rebalance(config.selector_rebalance_band);
+}
+
 void IRCController::evtHttpReload(mhood_t<hreq::irc::reload> evt) {
     json body = json::object();
 
@@ -23,7 +23,9 @@
 #include "IRCSelectorPool.h"
 
 class Logger;
+class IRCCapture;
 class DBController;
+class LatencyTracker;
 class ChannelController;
 class IRCController final : public so_5::agent_t
 {
@@ -31,6 +33,9 @@ class IRCController final : public so_5::agent_t
     using IRCClientsByName = std::map<std::string, IRCClient *, std::less<>>;
     using IRCClientsByIds = std::map<int, IRCClient *>;
 
+    struct GatherStats final : so_5::signal_t {};
+    struct RebalanceSelectors final : so_5::signal_t {};
+
   public:
     IRCController(const context_t &ctx,
                   so_5::mbox_t processor,
@@ -38,6 +43,7 @@ class IRCController final : public so_5::agent_t
                   so_5::mbox_t http,
                   const IRCConnectionConfig &conConfig,
                   std::shared_ptr<DBController> db,
+                  std::shared_ptr<LatencyTracker> latency,
                   std::shared_ptr<Logger> logger);
     ~IRCController() override;
 
@@ -49,6 +55,9 @@ class IRCController final : public so_5::agent_t
     // SendMessage from BotEngine
     void evtSendMessage(so_5::mhood_t<Chat::SendMessage> message);
 
+    void evtGatherStats(so_5::mhood_t<GatherStats> evt);
+    void evtRebalanceSelectors(so_5::mhood_t<RebalanceSelectors> evt);
+
     // http events
     void evtHttpReload(so_5::mhood_t<hreq::irc::reload> evt);
     void evtHttpCustom(so_5::mhood_t<hreq::irc::custom> evt);
@@ -68,16 +77,23 @@ class IRCController final : public so_5::agent_t
     so_5::mbox_t processor;
     so_5::mbox_t statsCollector;
     so_5::mbox_t http;
+    so_5::mbox_t admission;
 
     so_5::disp::thread_pool::dispatcher_handle_t ircSendPool;
     so_5::disp::thread_pool::bind_params_t ircSendPoolParams;
 
     const std::shared_ptr<Logger> logger;
     const std::shared_ptr<DBController> db;
+    const std::shared_ptr<LatencyTracker> latency;
 
     const IRCConnectionConfig config;
 
+    // sessions write to capture from selectors, so it outlives pool
+    std::unique_ptr<IRCCapture> capture;
+    size_t captureDropped = 0;
     IRCSelectorPool pool;
+    so_5::timer_id_t statsTimer;
+    so_5::timer_id_t rebalanceTimer;
 
     IRCClientsByName ircClientsByName;
     IRCClientsByIds ircClientsById;
@@ -0,0 +1,105 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+
+#include "IRCSession.h"
+#include "IRCJoinScheduler.h"
+
+IRCJoinScheduler::IRCJoinScheduler(IRCJoinSchedulerConfig config) : config(config) {
+}
+
+void IRCJoinScheduler::enqueue(IRCSession *session, const std::string &channel, double priority, long long now) {
+    auto [it, inserted] = pending.try_emplace(channel, Pending{session, priority, now});
+    if (!inserted) {
+        it->second.session = session;
+        it->second.priority = priority;
+    }
+    inflight.erase(channel);
+}
+
+void IRCJoinScheduler::removeSession(IRCSession *session) {
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (it->second.session == session)
+            it = pending.erase(it);
+        else
+            ++it;
+    }
+}
+
+void IRCJoinScheduler::remove(const std::string &channel) {
+    pending.erase(channel);
+    inflight.erase(channel);
+}
+
+std::vector<IRCJoinScheduler::Batch> IRCJoinScheduler::poll(long long now) {
+    while (!sent.empty() && sent.front() + config.period <= now)
+        sent.pop_front();
+
+    if (pending.empty() || sent.size() >= config.limit)
+        return {};
+    size_t budget = config.limit - sent.size();
+
+    using Ready = std::pair<const std::string *, const Pending *>;
+    std::vector<Ready> ready;
+    ready.reserve(pending.size());
+    for (const auto &[channel, join]: pending) {
+        if (join.session->loggedIn())
+            ready.emplace_back(&channel, &join);
+    }
+
+    // most active first, then the oldest
+    size_t count = std::min(budget, ready.size());
+    std::partial_sort(ready.begin(), ready.begin() + count, ready.end(), [] (const Ready &lhs, const Ready &rhs) {
+        if (lhs.second->priority != rhs.second->priority)
+            return lhs.second->priority > rhs.second->priority;
+        return lhs.second->enqueued < rhs.second->enqueued;
+    });
+
+    // pack channels of the same session to lines limited by IRC line length
+    std::vector<Batch> batches;
+    std::unordered_map<IRCSession *, size_t> lineLength; // length of last batch line of session
+    std::unordered_map<IRCSession *, size_t> lastBatch;
+    for (size_t i = 0; i < count; ++i) {
+        const auto &channel = *ready[i].first;
+        const auto &join = *ready[i].second;
+        size_t length = channel.size() + 2; // '#' and ','
+
+        if (!lastBatch.count(join.session) || lineLength[join.session] + length > config.maxLineLength) {
+            lastBatch[join.session] = batches.size();
+            lineLength[join.session] = sizeof("JOIN ") - 1;
+            batches.push_back(Batch{join.session, {}});
+        }
+        batches[lastBatch[join.session]].channels.push_back(channel);
+        lineLength[join.session] += length;
+
+        sent.push_back(now);
+        inflight[channel] = join.enqueued;
+        stats.wait.record(now - join.enqueued);
+        ++stats.channels;
+    }
+
+    for (const auto &batch: batches) {
+        for (const auto &channel: batch.channels)
+            pending.erase(channel);
+    }
+    stats.lines += batches.size();
+    return batches;
+}
+
+void IRCJoinScheduler::joined(const std::string &channel, long long now) {
+    auto it = inflight.find(channel);
+    if (it == inflight.end())
+        return;
+    stats.latency.record(std::max(0LL, now - it->second));
+    inflight.erase(it);
+}
+
+IRCJoinStatistic IRCJoinScheduler::collectStats() {
+    IRCJoinStatistic res;
+    std::swap(res, stats);
+    res.backlog = pending.size();
+    res.inflight = inflight.size();
+    return res;
+}
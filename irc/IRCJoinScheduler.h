@@ -0,0 +1,70 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_IRC_IRCJOINSCHEDULER_H_
+#define CHATCONTROLLER_IRC_IRCJOINSCHEDULER_H_
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "IRCStatistic.h"
+
+struct IRCJoinSchedulerConfig {
+    unsigned int limit = 20;  // channels joined per period by one account
+    long long period = 10000; // milliseconds
+    size_t maxLineLength = 510; // IRC line without CRLF
+};
+
+class IRCSession;
+// Paces JOINs of one account to keep it under Twitch join rate limit.
+// Pending channels are ordered by activity and packed to "JOIN #a,#b,#c" lines per session,
+// every channel in the line counts against the limit. Not thread safe, used from IRCClient agent.
+class IRCJoinScheduler
+{
+  public:
+    struct Batch {
+        IRCSession *session = nullptr;
+        std::vector<std::string> channels;
+    };
+
+  public:
+    explicit IRCJoinScheduler(IRCJoinSchedulerConfig config);
+    ~IRCJoinScheduler() = default;
+
+    /// Queues channel join, channel already in queue gets new session and priority
+    void enqueue(IRCSession *session, const std::string &channel, double priority, long long now);
+    /// Drops pending channels of session, they are reserved again after login
+    void removeSession(IRCSession *session);
+    void remove(const std::string &channel);
+
+    /// Returns batches allowed by rate limit, channels of not logged in sessions are kept in queue
+    std::vector<Batch> poll(long long now);
+
+    /// Records join latency from enqueue to server confirmation
+    void joined(const std::string &channel, long long now);
+
+    [[nodiscard]] bool isPending(const std::string &channel) const { return pending.count(channel) != 0; }
+    [[nodiscard]] size_t backlog() const { return pending.size(); }
+    /// Returns stats with current backlog and resets counters
+    IRCJoinStatistic collectStats();
+
+  private:
+    struct Pending {
+        IRCSession *session = nullptr;
+        double priority = 0;
+        long long enqueued = 0;
+    };
+
+    IRCJoinSchedulerConfig config;
+
+    std::unordered_map<std::string, Pending> pending;
+    std::unordered_map<std::string, long long> inflight; // channel -> enqueue time
+    std::deque<long long> sent; // send time of every channel inside current period
+
+    IRCJoinStatistic stats;
+};
+
+#endif //CHATCONTROLLER_IRC_IRCJOINSCHEDULER_H_
@@ -5,6 +5,8 @@
 #ifndef CHATCONTROLLER_IRC_IRCMESSAGE_H_
 #define CHATCONTROLLER_IRC_IRCMESSAGE_H_
 
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <string_view>
 
@@ -17,6 +19,7 @@ struct IRCMessage
     IRCMessage(std::string_view channel, std::string_view nickname, std::string_view text)
       : channel(channel), nickname(nickname), text(text) {
         timestamp = CurrentTime<std::chrono::system_clock>::milliseconds();
+        readTime = CurrentTime<std::chrono::steady_clock>::microseconds();
     }
 
     IRCMessage(IRCMessage&& other) = default;
@@ -25,6 +28,9 @@ struct IRCMessage
     std::string nickname;
     std::string text;
     long long timestamp = 0;
+    long long readTime = 0; // monotonic microseconds
+    uint64_t traceId = 0;   // non zero for sampled messages
+    std::optional<std::string> emotesTag; // IRCv3 "emotes" tag value, if tags are received
 };
 
 inline std::ostream& operator<<(std::ostream& os, const IRCMessage& m) {
@@ -6,8 +6,13 @@
 #include <string>
 #include <chrono>
 
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
 #include <libircclient.h>
 
+#include "Clock.h"
 #include "Logger.h"
 #include "ThreadName.h"
 
@@ -17,6 +22,17 @@
 #define SELECT_DELAY_MS 100
 
 IRCSelector::IRCSelector(size_t id, Logger *logger) : id(id), logger(logger) {
+    if (pipe(wakeupFds) == 0) {
+        for (int fd: wakeupFds)
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    } else {
+        logger->logError("IRCSelector[{}] Failed to create wakeup pipe: {}", id, strerror(errno));
+        wakeupFds[0] = wakeupFds[1] = -1;
+    }
+
+    stats.id = id;
+    statsStart = CurrentTime<std::chrono::steady_clock>::microseconds();
+
     thread = std::thread(&IRCSelector::run, this);
     set_thread_name(thread, "irc_selector_" + std::to_string(id));
     loggerTag = fmt::format("IRCSelector[{}/{}]", fmt::ptr(this), id);
@@ -26,12 +42,18 @@ IRCSelector::IRCSelector(size_t id, Logger *logger) : id(id), logger(logger) {
 IRCSelector::~IRCSelector() {
     if (thread.joinable())
         thread.join();
+    for (int fd: wakeupFds) {
+        if (fd >= 0)
+            close(fd);
+    }
     logger->logTrace("{} IRC selector destruction", loggerTag);
 }
 
 void IRCSelector::addSession(const std::shared_ptr<IRCSession> &session) {
     logger->logTrace("{} IRC selector add new session({})", loggerTag, fmt::ptr(session.get()));
 
+    session->setSelector(this);
+
     std::lock_guard lg(mutex);
     sessions.push_back(session);
     needSync = true;
@@ -42,10 +64,106 @@ void IRCSelector::removeSession(const std::shared_ptr<IRCSession> &session) {
 
     std::lock_guard lg(mutex);
     auto it = std::find(sessions.begin(), sessions.end(), session);
+    if (it == sessions.end())
+        return;
+    session->resetSelector(this);
     sessions.erase(it);
     needSync = true;
 }
 
+size_t IRCSelector::sessionsCount() {
+    std::lock_guard lg(mutex);
+    return sessions.size();
+}
+
+bool IRCSelector::setAffinity(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return false;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (int res = pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set); res != 0) {
+        logger->logError("{} Failed to pin thread to cpu {}: {}", loggerTag, cpu, strerror(res));
+        return false;
+    }
+    logger->logInfo("{} Thread pinned to cpu {}", loggerTag, cpu);
+    return true;
+#else
+    logger->logWarn("{} Thread affinity is not supported, cpu {} ignored", loggerTag, cpu);
+    return false;
+#endif
+}
+
+IRCSelectorStatistic IRCSelector::collectStats() {
+    auto now = CurrentTime<std::chrono::steady_clock>::microseconds();
+    IRCSelectorStatistic res;
+    {
+        std::lock_guard lg(statsMutex);
+        std::swap(res, stats);
+        stats.id = id;
+        res.utilisation = now > statsStart ? static_cast<double>(res.busy) / static_cast<double>(now - statsStart) : 0;
+        statsStart = now;
+    }
+    res.sessions = sessionsCount();
+    return res;
+}
+
+void IRCSelector::wakeup() {
+    if (wakeupPending.exchange(true, std::memory_order_acq_rel) || wakeupFds[1] < 0)
+        return;
+    char byte = 0;
+    [[maybe_unused]] auto res = write(wakeupFds[1], &byte, 1);
+}
+
+void IRCSelector::reschedule() {
+    {
+        std::lock_guard lg(mutex);
+        needSync = true;
+    }
+    wakeup();
+}
+
+void IRCSelector::drainWakeup() {
+    // clear flag first, lines queued after it will signal again
+    wakeupPending.store(false, std::memory_order_release);
+    char buf[64];
+    while (read(wakeupFds[0], buf, sizeof(buf)) > 0);
+}
+
+void IRCSelector::scheduleTicks(long long now) {
+    for (auto &session : threadSafeCopy) {
+        std::lock_guard lg(session->processMutex);
+        if (session->selector.load(std::memory_order_acquire) != this || session->ticker == this)
+            continue;
+        session->ticker = this;
+        session->nextTick = now;
+        deadlines.push(Deadline{now, session});
+    }
+}
+
+long long IRCSelector::processTicks(long long now) {
+    while (!deadlines.empty() && deadlines.top().time <= now) {
+        auto time = deadlines.top().time;
+        auto session = deadlines.top().session.lock();
+        deadlines.pop();
+        if (!session)
+            continue;
+
+        // session moved to another selector or was rescheduled after it came back
+        std::lock_guard lg(session->processMutex);
+        if (session->selector.load(std::memory_order_acquire) != this || session->ticker != this ||
+            session->nextTick != time)
+            continue;
+
+        roundLag.record(now - time);
+        session->nextTick = std::max(session->tick(now), now + 1);
+        deadlines.push(Deadline{session->nextTick, session});
+    }
+    return deadlines.empty() ? SELECT_DELAY_MS : deadlines.top().time - now;
+}
+
 void IRCSelector::run() {
     // Setup the timeout
     int maxfd = 0;
@@ -55,19 +173,40 @@ void IRCSelector::run() {
     while (!SysSignal::serviceTerminated()) {
         maxfd = 0;
 
-        tv.tv_sec = SELECT_DELAY_MS / 1000;
-        tv.tv_usec = (SELECT_DELAY_MS % 1000) * 1000;
-
         // Init sets
         FD_ZERO(&in_set);
         FD_ZERO(&out_set);
 
+        bool synced = false;
         if (std::lock_guard lg(mutex); needSync) {
             threadSafeCopy = sessions;
             needSync = false;
+            synced = true;
+        }
+
+        // time outside select() is the selector load
+        auto roundStart = CurrentTime<std::chrono::steady_clock>::microseconds();
+
+        auto now = roundStart / 1000;
+        if (synced)
+            scheduleTicks(now);
+        auto delay = std::clamp(processTicks(now), 0LL, static_cast<long long>(SELECT_DELAY_MS));
+        tv.tv_sec = delay / 1000;
+        tv.tv_usec = (delay % 1000) * 1000;
+
+        if (wakeupFds[0] >= 0) {
+            FD_SET(wakeupFds[0], &in_set);
+            maxfd = wakeupFds[0];
         }
 
         for (auto &session : threadSafeCopy) {
+            // session could be moved to another selector after copy was taken
+            std::lock_guard lg(session->processMutex);
+            if (session->selector.load(std::memory_order_acquire) != this)
+                continue;
+
+            // send queued lines in the same round, libircclient marks socket for write if buffer is not empty
+            session->flush();
             if (!session->connected())
                 continue;
 
@@ -82,16 +221,35 @@ void IRCSelector::run() {
             continue;
         }
 
+        auto selectStart = CurrentTime<std::chrono::steady_clock>::microseconds();
         int count = select(maxfd + 1, &in_set, &out_set, nullptr, &tv);
+        auto selectEnd = CurrentTime<std::chrono::steady_clock>::microseconds();
         if (count < 0 && errno != EINTR) {
             logger->logError("{} Failed to select: {} {}", loggerTag, errno, strerror(errno));
         }
 
+        if (count > 0 && wakeupFds[0] >= 0 && FD_ISSET(wakeupFds[0], &in_set))
+            drainWakeup();
+
         for (auto &session : threadSafeCopy) {
+            std::lock_guard lg(session->processMutex);
+            if (session->selector.load(std::memory_order_acquire) != this)
+                continue;
+
             if (irc_process_select_descriptors(session->session, &in_set, &out_set)) {
                 logger->logError("{} Failed to process select list: {}",
                                  loggerTag, irc_strerror(irc_errno(session->session)));
             }
         }
+
+        auto busy = (selectStart - roundStart) + (CurrentTime<std::chrono::steady_clock>::microseconds() - selectEnd);
+        std::lock_guard lg(statsMutex);
+        ++stats.rounds;
+        stats.busy += busy;
+        stats.loop.record(busy);
+        if (roundLag.count()) {
+            stats.lag.merge(roundLag);
+            roundLag.clear();
+        }
     }
 }
@@ -5,13 +5,17 @@
 #ifndef CHATCONTROLLER_IRC_IRCSELECTOR_H_
 #define CHATCONTROLLER_IRC_IRCSELECTOR_H_
 
+#include <atomic>
 #include <thread>
 #include <mutex>
+#include <queue>
 #include <vector>
 #include <algorithm>
 
 #include "SysSignal.h"
 
+#include "IRCStatistic.h"
+
 class Logger;
 class IRCSession;
 class IRCSelector
@@ -23,8 +27,33 @@ class IRCSelector
     void addSession(const std::shared_ptr<IRCSession> &session);
     void removeSession(const std::shared_ptr<IRCSession> &session);
 
+    /// Interrupts select() to flush sessions outbound queues, any thread
+    void wakeup();
+    /// Puts sessions with reset ticker back to deadlines on the next round, any thread
+    void reschedule();
+
+    /// Pins selector thread to cpu, returns false if platform or cpu is not supported
+    bool setAffinity(int cpu);
+
+    [[nodiscard]] size_t getId() const { return id; }
+    [[nodiscard]] size_t sessionsCount();
+    /// Loop statistic since previous call, bytes rate is filled by IRCSelectorPool
+    IRCSelectorStatistic collectStats();
+
   private:
+    struct Deadline {
+        long long time = 0; // steady clock milliseconds
+        std::weak_ptr<IRCSession> session;
+
+        bool operator>(const Deadline &other) const { return time > other.time; }
+    };
+
     void run();
+    void drainWakeup();
+    /// Puts sessions that came to this selector to deadlines heap
+    void scheduleTicks(long long now);
+    /// Ticks sessions with passed deadlines, returns milliseconds till the next one
+    long long processTicks(long long now);
 
     size_t id = 0;
 
@@ -36,6 +65,17 @@ class IRCSelector
 
     bool needSync = false;
     std::vector<std::shared_ptr<IRCSession>> threadSafeCopy;
+    // keepalive deadlines of owned sessions, stale entries are skipped when popped
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<>> deadlines;
+    Histogram roundLag; // ticks lateness of current round, merged to stats with loop time
+
+    // self-pipe, one write per select round no matter how many lines were queued
+    int wakeupFds[2] = {-1, -1};
+    std::atomic_bool wakeupPending = false;
+
+    std::mutex statsMutex;
+    IRCSelectorStatistic stats;
+    long long statsStart = 0;
 
     std::thread thread;
 };
@@ -2,7 +2,11 @@
 // Created by l2pic on 25.04.2021.
 //
 
+#include <algorithm>
+
+#include "Clock.h"
 #include "Logger.h"
+#include "IRCSession.h"
 #include "IRCSelector.h"
 #include "IRCSelectorPool.h"
 
@@ -13,35 +17,155 @@ IRCSelectorPool::IRCSelectorPool(std::shared_ptr<Logger> logger)
 
 IRCSelectorPool::~IRCSelectorPool() = default;
 
-void IRCSelectorPool::init(size_t threads) {
+void IRCSelectorPool::init(size_t threads, const std::vector<int> &cpus) {
     std::lock_guard lg(mutex);
     selectors.reserve(threads);
     for (size_t i = 0; i < threads; ++i) {
         selectors.emplace_back(new IRCSelector(i, logger.get()));
+        if (!cpus.empty())
+            selectors.back()->setAffinity(cpus[i % cpus.size()]);
     }
+    loads.resize(selectors.size());
+    lastCollect = CurrentTime<std::chrono::steady_clock>::milliseconds();
 }
 
 void IRCSelectorPool::addSession(const std::shared_ptr<IRCSession> &session) {
-    std::shared_ptr<IRCSession> tempHolder = session;
-
     std::lock_guard lg(mutex);
-    getNextSelectorRoundRobin()->addSession(tempHolder);
+    size_t index = getLeastLoadedSelector();
+    auto &place = placement[session.get()];
+    place.session = session;
+    place.selector = index;
+    place.lastBytes = session->getRecvBytes();
+    ++loads[index].sessions;
+
+    selectors[index]->addSession(session);
 }
 
 void IRCSelectorPool::removeSession(const std::shared_ptr<IRCSession> &session) {
-    std::shared_ptr<IRCSession> tempHolder = session;
+    std::lock_guard lg(mutex);
+    auto it = placement.find(session.get());
+    if (it == placement.end())
+        return;
+
+    auto &load = loads[it->second.selector];
+    --load.sessions;
+    load.bytesRate = std::max(load.bytesRate - it->second.bytesRate, 0.);
+    selectors[it->second.selector]->removeSession(session);
+    placement.erase(it);
+}
+
+std::vector<IRCSelectorStatistic> IRCSelectorPool::collectStats() {
+    std::lock_guard lg(mutex);
+    auto now = CurrentTime<std::chrono::steady_clock>::milliseconds();
+    double seconds = static_cast<double>(std::max(now - lastCollect, 1LL)) / 1000.;
+    lastCollect = now;
+
+    for (auto &load: loads)
+        load.bytesRate = 0;
+    for (auto &[ptr, place]: placement) {
+        auto bytes = ptr->getRecvBytes();
+        // smooth short bursts, placement should follow steady load
+        place.bytesRate = (place.bytesRate + static_cast<double>(bytes - place.lastBytes) / seconds) / 2;
+        place.lastBytes = bytes;
+        loads[place.selector].bytesRate += place.bytesRate;
+    }
+
+    std::vector<IRCSelectorStatistic> res;
+    res.reserve(selectors.size());
+    for (size_t i = 0; i < selectors.size(); ++i) {
+        auto stats = selectors[i]->collectStats();
+        stats.bytesRate = loads[i].bytesRate;
+        loads[i].utilisation = stats.utilisation;
+        res.push_back(std::move(stats));
+    }
+    return res;
+}
 
+bool IRCSelectorPool::rebalance(double band) {
     std::lock_guard lg(mutex);
-    for(auto &selector: selectors) {
-        selector->removeSession(tempHolder);
+    if (selectors.size() < 2)
+        return false;
+
+    auto score = scores();
+    auto [minIt, maxIt] = std::minmax_element(score.begin(), score.end());
+    double average = 1. / static_cast<double>(selectors.size());
+    if (*maxIt <= average * (1. + band))
+        return false;
+
+    size_t from = maxIt - score.begin();
+    size_t to = minIt - score.begin();
+    auto &src = loads[from];
+    auto &dst = loads[to];
+
+    // biggest session which doesn't make target busier than source
+    double limit = (src.bytesRate - dst.bytesRate) / 2;
+    Placement *candidate = nullptr;
+    for (auto &[ptr, place]: placement) {
+        if (place.selector != from)
+            continue;
+        if (place.bytesRate <= limit && (!candidate || place.bytesRate > candidate->bytesRate))
+            candidate = &place;
     }
+
+    // load is not driven by traffic, level sessions count
+    if (!candidate && src.sessions > dst.sessions + 1) {
+        for (auto &[ptr, place]: placement) {
+            if (place.selector == from && (!candidate || place.bytesRate < candidate->bytesRate))
+                candidate = &place;
+        }
+    }
+
+    if (!candidate)
+        return false;
+
+    double share = src.bytesRate > 0 ? candidate->bytesRate / src.bytesRate : 1. / static_cast<double>(src.sessions);
+    double utilisation = src.utilisation * share;
+    src.utilisation -= utilisation;
+    dst.utilisation += utilisation;
+    src.bytesRate -= candidate->bytesRate;
+    dst.bytesRate += candidate->bytesRate;
+    --src.sessions;
+    ++dst.sessions;
+
+    logger->logInfo("IRCSelectorPool Move session({}) from selector {} to {}, {:.0f} bytes/s",
+                    fmt::ptr(candidate->session.get()), from, to, candidate->bytesRate);
+    candidate->selector = to;
+    // old selector skips session as soon as it is owned by new one
+    selectors[from]->removeSession(candidate->session);
+    selectors[to]->addSession(candidate->session);
+    return true;
 }
 
-IRCSelector *IRCSelectorPool::getNextSelectorRoundRobin() {
-    if (selectors.size() == 1)
-        return selectors.front().get();
+std::vector<double> IRCSelectorPool::scores() const {
+    Load total;
+    for (auto &load: loads) {
+        total.sessions += load.sessions;
+        total.bytesRate += load.bytesRate;
+        total.utilisation += load.utilisation;
+    }
+
+    // every factor is a share of the pool total, so score average is 1/selectors per used factor
+    size_t factors = 0;
+    factors += total.sessions > 0;
+    factors += total.bytesRate > 0;
+    factors += total.utilisation > 0;
+
+    std::vector<double> res(loads.size(), 0.);
+    if (factors == 0)
+        return res;
+    for (size_t i = 0; i < loads.size(); ++i) {
+        if (total.sessions > 0)
+            res[i] += static_cast<double>(loads[i].sessions) / static_cast<double>(total.sessions);
+        if (total.bytesRate > 0)
+            res[i] += loads[i].bytesRate / total.bytesRate;
+        if (total.utilisation > 0)
+            res[i] += loads[i].utilisation / total.utilisation;
+        res[i] /= static_cast<double>(factors);
+    }
+    return res;
+}
 
-    unsigned int i = curSelectorRoundRobin++;
-    curSelectorRoundRobin %= selectors.size();
-    return selectors[i].get();
+size_t IRCSelectorPool::getLeastLoadedSelector() const {
+    auto score = scores();
+    return std::min_element(score.begin(), score.end()) - score.begin();
 }
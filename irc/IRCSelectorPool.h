@@ -8,6 +8,9 @@
 #include <vector>
 #include <mutex>
 #include <memory>
+#include <unordered_map>
+
+#include "IRCStatistic.h"
 
 class Logger;
 class IRCSession;
@@ -18,19 +21,42 @@ class IRCSelectorPool
     explicit IRCSelectorPool(std::shared_ptr<Logger> logger);
     ~IRCSelectorPool();
 
-    void init(size_t threads);
+    /// cpus are assigned to selectors in order, empty list keeps threads unpinned
+    void init(size_t threads, const std::vector<int> &cpus = {});
 
+    /// Places session on the least loaded selector
     void addSession(const std::shared_ptr<IRCSession> &session);
     void removeSession(const std::shared_ptr<IRCSession> &session);
 
+    /// Gathers selectors statistic and refreshes load used for sessions placement
+    std::vector<IRCSelectorStatistic> collectStats();
+    /// Moves one session from the most loaded selector if it is above average by band
+    bool rebalance(double band);
+
   private:
-    IRCSelector *getNextSelectorRoundRobin();
+    struct Placement {
+        std::shared_ptr<IRCSession> session;
+        size_t selector = 0;
+        unsigned long long lastBytes = 0;
+        double bytesRate = 0; // inbound bytes per second
+    };
+
+    struct Load {
+        size_t sessions = 0;
+        double bytesRate = 0;
+        double utilisation = 0;
+    };
+
+    [[nodiscard]] std::vector<double> scores() const;
+    size_t getLeastLoadedSelector() const;
 
     std::shared_ptr<Logger> logger;
 
     std::mutex mutex;
-    size_t curSelectorRoundRobin = 0;
     std::vector<std::unique_ptr<IRCSelector>> selectors;
+    std::vector<Load> loads;
+    std::unordered_map<IRCSession *, Placement> placement;
+    long long lastCollect = 0;
 };
 
 #endif //CHATCONTROLLER_IRC_IRCSELECTORPOOL_H_
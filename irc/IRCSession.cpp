@@ -2,14 +2,24 @@
 // Created by l2pic on 25.04.2021.
 //
 
+#include <algorithm>
+
 #include <absl/strings/str_join.h>
 
 #include "Clock.h"
+#include "IRCCapture.h"
 #include "IRCMessage.h"
+#include "IRCSelector.h"
 #include "IRCSessionListener.h"
 #include "IRCSession.h"
+#include "TraceBuffer.h"
+
+#define STATS_PERIOD_MS 5000
+#define RTT_WINDOW_MS 120000 // recent RTT covers one to two windows
+#define RTT_MIN_SAMPLES 5
+#define LOGIN_TIMEOUT_MS 3000
 
-#define PING_PONG_TIMEOUT_MS 10500
+static std::atomic<unsigned long long> lastSerial = 0;
 
 IRCSession::IRCSession(const IRCConnectionConfig &conConfig,
                        const IRCClientConfig &cliConfig,
@@ -17,7 +27,7 @@ IRCSession::IRCSession(const IRCConnectionConfig &conConfig,
                        IRCSessionListener *listener,
                        IRCClient *parent,
                        Logger *logger)
-    : conConfig(conConfig), cliConfig(cliConfig), id(id), listener(listener), logger(logger) {
+    : conConfig(conConfig), cliConfig(cliConfig), id(id), serial(++lastSerial), listener(listener), logger(logger) {
     ctx.callback = this;
     ctx.parent = parent;
 
@@ -25,10 +35,6 @@ IRCSession::IRCSession(const IRCConnectionConfig &conConfig,
 
     loggerTag = fmt::format("IRCSession[{}/{}/{}]", fmt::ptr(this),cliConfig.nick, id);
     logger->logInfo("{} Session init on IRCClient({}) for {}", loggerTag, fmt::ptr(parent), cliConfig.nick);
-
-    auto now = CurrentTime<std::chrono::system_clock>::milliseconds();
-    lastPingTime = now;
-    lastPongTime = now;
 }
 
 IRCSession::~IRCSession() {
@@ -54,19 +60,24 @@ void IRCSession::destroy() {
 }
 
 bool IRCSession::connect() {
-    // IRCClient thread
-    if (irc_connect(session,
-                    conConfig.host.c_str(), conConfig.port,
-                    cliConfig.password.c_str(), cliConfig.nick.c_str(), cliConfig.user.c_str(), "IRC Client")) {
-        ++statsFromSo5Thread.connects.failed;
-        logger->logError("{} Could not connect: {}", loggerTag, irc_strerror(irc_errno(session)));
-        return false;
+    // IRCClient thread, selector must not be inside libircclient with this session
+    {
+        std::lock_guard lg(processMutex);
+        if (irc_connect(session,
+                        conConfig.host.c_str(), conConfig.port,
+                        cliConfig.password.c_str(), cliConfig.nick.c_str(), cliConfig.user.c_str(), "IRC Client")) {
+            ++statsFromSo5Thread.connects.failed;
+            logger->logError("{} Could not connect: {}", loggerTag, irc_strerror(irc_errno(session)));
+            return false;
+        }
+
+        logged.store(false, std::memory_order_relaxed);
+        // login is awaited by tick, its next deadline may be far away, so it is scheduled again
+        loginDeadline = CurrentTime<std::chrono::steady_clock>::milliseconds() + LOGIN_TIMEOUT_MS;
+        ticker = nullptr;
     }
-
-    auto now = CurrentTime<std::chrono::system_clock>::milliseconds();
-    lastPingTime = now;
-    lastPongTime = now;
-    logged.store(false, std::memory_order_relaxed);
+    if (auto *owner = selector.load(std::memory_order_acquire))
+        owner->reschedule();
 
     ++statsFromSo5Thread.connects.success;
     return true;
@@ -82,7 +93,8 @@ bool IRCSession::loggedIn() {
 }
 
 void IRCSession::disconnect() {
-    // IRCClient && IRCSelector thread
+    // IRCClient thread, selector side uses irc_disconnect under processMutex it already holds
+    std::lock_guard lg(processMutex);
     irc_disconnect(session);
 }
 
@@ -90,125 +102,273 @@ unsigned int IRCSession::getId() const {
     return id;
 }
 
-void IRCSession::setPingTimer(so_5::timer_id_t timer) {
-    pingTimer = std::move(timer);
+void IRCSession::shipStats() {
+    sendStats(statsFromSo5Thread);
+}
+
+void IRCSession::setCapture(IRCCapture *owner) {
+    capture = owner;
+    if (capture)
+        captureKey = capture->addSession(fmt::format("{}/{}", cliConfig.nick, id));
+}
+
+void IRCSession::setTrace(TraceBuffer *buffer) {
+    trace = buffer;
 }
 
 bool IRCSession::sendQuit(const std::string &reason) {
     logger->logTrace("{} Send QUIT: {}", loggerTag, reason);
-    return internalIrcSend(irc_cmd_quit, reason.empty() ? nullptr : reason.c_str());
+    return enqueue(reason.empty() ? "QUIT" : "QUIT :" + reason);
 }
 
 bool IRCSession::sendJoin(const std::string &channel) {
     logger->logTrace("{} Send JOIN: {}", loggerTag, channel);
     ++statsFromSo5Thread.commands.out.join;
-    return internalIrcSend(irc_cmd_join, channel.c_str(), nullptr);
+    return enqueue("JOIN " + channel);
 }
 
 bool IRCSession::sendJoin(const std::string &channel, const std::string &key) {
     logger->logTrace("{} Send JOIN: {}:{}", loggerTag, channel, key);
     ++statsFromSo5Thread.commands.out.join;
-    return internalIrcSend(irc_cmd_join, channel.c_str(), key.c_str());
+    return enqueue(fmt::format("JOIN {} {}", channel, key));
+}
+
+bool IRCSession::sendJoin(const std::vector<std::string> &channels) {
+    std::string line = "JOIN ";
+    for (const auto &channel: channels) {
+        if (channel.front() != '#')
+            line.push_back('#');
+        line.append(channel).push_back(',');
+    }
+    line.pop_back();
+
+    logger->logTrace("{} Send {}", loggerTag, line);
+    statsFromSo5Thread.commands.out.join += channels.size();
+    return enqueue(std::move(line));
 }
 
 bool IRCSession::sendPart(const std::string &channel) {
     logger->logTrace("{} Send PART: {}", loggerTag, channel);
     ++statsFromSo5Thread.commands.out.part;
-    return internalIrcSend(irc_cmd_part, channel.c_str());
+    return enqueue("PART " + channel);
 }
 
 bool IRCSession::sendTopic(const std::string &channel, const std::string &topic) {
     logger->logTrace("{} Send TOPIC to {} as {}", loggerTag, channel, topic);
-    return internalIrcSend(irc_cmd_topic, channel.c_str(), topic.c_str());
+    return enqueue(fmt::format("TOPIC {} :{}", channel, topic));
 }
 
 bool IRCSession::sendNames(const std::string &channel) {
     logger->logTrace("{} Send NAMES to {}", loggerTag, channel);
-    return internalIrcSend(irc_cmd_names, channel.c_str());
+    return enqueue("NAMES " + channel);
 }
 
 bool IRCSession::sendList(const std::string &channel) {
     logger->logTrace("{} Send LIST to {}", loggerTag, channel);
-    return internalIrcSend(irc_cmd_list, channel.empty() ? nullptr : channel.c_str());
+    return enqueue(channel.empty() ? "LIST" : "LIST " + channel);
 }
 
 bool IRCSession::sendInvite(const std::string &channel, const std::string &nick) {
     logger->logTrace("{} Send INVITE to {} on ", loggerTag, nick, channel);
-    return internalIrcSend(irc_cmd_invite, nick.c_str(), channel.c_str());
+    return enqueue(fmt::format("INVITE {} {}", nick, channel));
 }
 
 bool IRCSession::sendKick(const std::string &channel, const std::string &nick, const std::string &comment) {
     logger->logTrace("{} Send KICK: {} from {} for \"{}\"", loggerTag, nick, channel, comment);
-    return internalIrcSend(irc_cmd_kick, nick.c_str(), channel.c_str(), comment.empty() ? nullptr : comment.c_str());
+    if (comment.empty())
+        return enqueue(fmt::format("KICK {} {}", channel, nick));
+    return enqueue(fmt::format("KICK {} {} :{}", channel, nick, comment));
 }
 
 bool IRCSession::sendMessage(const std::string &channel, const std::string &text) {
+    return sendMessage(channel, text, 0);
+}
+
+bool IRCSession::sendMessage(const std::string &channel, const std::string &text, uint64_t traceId) {
     logger->logTrace("{} Send PRIMSG from {} to {} : \"{}\"",
                      loggerTag, cliConfig.nick, channel, text);
     ++statsFromSo5Thread.commands.out.privmsg;
-    return internalIrcSend(irc_cmd_msg, channel.c_str(), text.c_str());
+    return enqueue(fmt::format("PRIVMSG {} :{}", channel, text), traceId);
 }
 
 bool IRCSession::sendNotice(const std::string &channel, const std::string &text) {
     logger->logTrace("{} Send NOTICE from {} to {} : \"{}\"",
                      loggerTag, cliConfig.nick, channel, text);
-    return internalIrcSend(irc_cmd_notice, channel.c_str(), text.c_str());
+    return enqueue(fmt::format("NOTICE {} :{}", channel, text));
 }
 
 bool IRCSession::sendCtcpRequest(const std::string &nick, const std::string &reply) {
-    return internalIrcSend(irc_cmd_ctcp_request, nick.c_str(), reply.c_str());
+    return enqueue(fmt::format("PRIVMSG {} :\x01{}\x01", nick, reply));
 }
 
 bool IRCSession::sendCtcpReply(const std::string &nick, const std::string &reply) {
-    return internalIrcSend(irc_cmd_ctcp_reply, nick.c_str(), reply.c_str());
+    return enqueue(fmt::format("NOTICE {} :\x01{}\x01", nick, reply));
 }
 
 bool IRCSession::sendMe(const std::string &channel, const std::string &text) {
     logger->logTrace("{} Send ME to {} : \"{}\"", loggerTag, channel, text);
-    return internalIrcSend(irc_cmd_me, channel.c_str(), text.c_str());
+    return enqueue(fmt::format("PRIVMSG {} :\x01" "ACTION {}\x01", channel, text));
 }
 
 bool IRCSession::sendChannelMode(const std::string &channel, const std::string &mode) {
     logger->logTrace("{} Send CHANNEL_MODE to {} as {}", loggerTag, channel, mode);
-    return internalIrcSend(irc_cmd_channel_mode, channel.c_str(), mode.c_str());
+    return enqueue(mode.empty() ? "MODE " + channel : fmt::format("MODE {} {}", channel, mode));
 }
 
 bool IRCSession::sendUserMode(const std::string &mode) {
     logger->logTrace("{} Send USER_MODE as {}", loggerTag, mode);
-    return internalIrcSend(irc_cmd_user_mode, mode.c_str());
+    if (mode.empty())
+        return enqueue("MODE " + cliConfig.nick);
+    return enqueue(fmt::format("MODE {} {}", cliConfig.nick, mode));
 }
 
 bool IRCSession::sendNick(const std::string &newnick) {
     logger->logTrace("{} Send NICK as {}", loggerTag, newnick);
-    return internalIrcSend(irc_cmd_nick, newnick.c_str());
+    return enqueue("NICK " + newnick);
 }
 
 bool IRCSession::sendWhois(const std::string &nick) {
     logger->logTrace("{} Send WHOIS for {}", loggerTag, nick);
-    return internalIrcSend(irc_cmd_nick, nick.c_str());
+    return enqueue(fmt::format("WHOIS {} {}", nick, nick));
 }
 
 bool IRCSession::sendPing(const std::string &host) {
-    sendStats(statsFromSo5Thread);
+    // keepalive PINGs are sent by tick(), this one is not tracked for RTT
+    logger->logTrace("{} Send PING with host: {}", loggerTag, host);
+    return enqueue("PING " + host);
+}
 
-    if (lastPingTime - lastPongTime >= PING_PONG_TIMEOUT_MS) {
-        //logger->logError("{} PING/PONG timeout: {}", loggerTag, lastPingTime - lastPongTime);
-        onDisconnected("TIMEOUT", fmt::format("PING/PONG timeout: {}", lastPingTime - lastPongTime));
+bool IRCSession::sendRaw(const std::string &raw) {
+    logger->logTrace("{} Send RAW : \"{}\"", loggerTag, raw);
+    return enqueue(raw);
+}
+
+bool IRCSession::enqueue(std::string line, uint64_t traceId) {
+    // IRCClient thread
+    if (!connected()) {
+        logger->logError("{} Failed to send \"{}\": not connected", loggerTag, line);
         return false;
     }
 
-    if (internalIrcSend(irc_cmd_ping, host.c_str())) {
-        lastPingTime = CurrentTime<std::chrono::system_clock>::milliseconds();
-        logger->logTrace("{} Send PING with host: {}", loggerTag, host);
-        return true;
+    long long queued = traceId ? CurrentTime<std::chrono::steady_clock>::microseconds() : 0;
+    outbound.push(OutboundLine{std::move(line), traceId, queued});
+    ++statsFromSo5Thread.commands.out.count;
+
+    if (auto *owner = selector.load(std::memory_order_acquire))
+        owner->wakeup();
+    return true;
+}
+
+void IRCSession::flush() {
+    // IRCSelector thread
+    if (!connected()) {
+        // lines left from previous connection are meaningless for the new one
+        while (outbound.pop(stalled));
+        stalled = OutboundLine{};
+        return;
     }
 
-    return false;
+    // all lines go to libircclient output buffer and leave the socket with one send() per select round
+    while (!stalled.text.empty() || outbound.pop(stalled)) {
+        if (irc_send_raw(session, "%s", stalled.text.c_str())) {
+            if (irc_errno(session) == LIBIRC_ERR_NOMEM)
+                return; // buffer is full, retry after it is written out
+
+            logger->logError("{} Failed to send \"{}\": {}", loggerTag, stalled.text, irc_strerror(irc_errno(session)));
+        } else if (stalled.traceId && trace) {
+            // span covers wait in outbound queue and libircclient buffer space
+            trace->span(stalled.traceId, "irc.write", stalled.queued,
+                        CurrentTime<std::chrono::steady_clock>::microseconds());
+        }
+        stalled = OutboundLine{};
+    }
 }
 
-bool IRCSession::sendRaw(const std::string &raw) {
-    logger->logTrace("{} Send RAW : \"{}\"", loggerTag, raw);
-    return internalIrcSend(irc_send_raw, raw.c_str());
+void IRCSession::setSelector(IRCSelector *owner) {
+    selector.store(owner, std::memory_order_release);
+}
+
+void IRCSession::resetSelector(IRCSelector *owner) {
+    selector.compare_exchange_strong(owner, nullptr, std::memory_order_acq_rel);
+}
+
+long long IRCSession::tick(long long now) {
+    // IRCSelector thread
+    if (now >= nextStatsTime) {
+        sendStats(statsFromSelectorThread);
+
+        ChannelsActivity activity;
+        std::swap(activity, activityFromSelectorThread);
+        if (!activity.empty())
+            listener->onChannelsActivity(this, std::move(activity));
+        nextStatsTime = now + STATS_PERIOD_MS;
+    }
+
+    long long next = nextStatsTime;
+    if (!loggedIn()) {
+        if (!loginDeadline)
+            return next;
+        if (now >= loginDeadline) {
+            onDisconnected("LOGIN_TIMEOUT", fmt::format("Login timeout: {}ms", LOGIN_TIMEOUT_MS));
+            return next;
+        }
+        return std::min(next, loginDeadline);
+    }
+    if (!connected())
+        return next;
+
+    // reconnect is not done from libircclient callback, PONG handler only marks session
+    if (rttDegraded) {
+        rttDegraded = false;
+        onDisconnected("RTT", fmt::format("RTT degraded, p90: {}", getRttTail()));
+        return next;
+    }
+
+    if (pendingPing) {
+        if (now - pendingPing >= conConfig.keepalive_timeout) {
+            onDisconnected("TIMEOUT", fmt::format("PING/PONG timeout: {}", now - pendingPing));
+            return next;
+        }
+        return std::min(next, pendingPing + conConfig.keepalive_timeout);
+    }
+
+    // busy session is alive by definition, it is pinged only for RTT samples
+    long long pingTime = lastRecvTime + conConfig.keepalive_idle;
+    if (conConfig.keepalive_probe > 0)
+        pingTime = std::min(pingTime, lastPingTime + conConfig.keepalive_probe);
+    if (now < pingTime)
+        return std::min(next, pingTime);
+
+    // selector owns the session right now, so line goes directly to libircclient buffer
+    if (irc_send_raw(session, "PING %s", conConfig.host.c_str())) {
+        logger->logWarn("{} Failed to send PING: {}", loggerTag, irc_strerror(irc_errno(session)));
+        return std::min(next, now + conConfig.keepalive_idle);
+    }
+    ++statsFromSelectorThread.commands.out.count;
+    lastPingTime = now;
+    pendingPing = now;
+    return std::min(next, now + conConfig.keepalive_timeout);
+}
+
+void IRCSession::recordRtt(long long now, long long sample) {
+    // IRCSelector thread
+    if (now - rttRotateTime >= RTT_WINDOW_MS) {
+        std::swap(rttPrevious, rttRecent);
+        rttRecent.clear();
+        rttRotateTime = now;
+    }
+    rttRecent.record(sample);
+
+    Histogram window = rttPrevious;
+    window.merge(rttRecent);
+    auto tail = static_cast<unsigned int>(window.percentile(90));
+    rttTail.store(tail, std::memory_order_relaxed);
+
+    if (conConfig.reconnect_rtt > 0 && window.count() >= RTT_MIN_SAMPLES &&
+        tail > static_cast<unsigned int>(conConfig.reconnect_rtt)) {
+        logger->logWarn("{} RTT p90 {} is above {}, reconnecting", loggerTag, tail, conConfig.reconnect_rtt);
+        rttDegraded = true;
+    }
 }
 
 void IRCSession::onLog(const char *msg, int len) {
@@ -225,10 +385,10 @@ void IRCSession::onDisconnected(std::string_view, std::string_view reason) {
     // IRCSelector thread
     logger->logError("{} Disconnected from server: {}", loggerTag, reason);
 
-    // remove current ping timer
-    pingTimer = {};
-    // clear internal session data
-    disconnect();
+    pendingPing = 0;
+    loginDeadline = 0;
+    // clear internal session data, processMutex is held by selector
+    irc_disconnect(session);
 
     listener->onDisconnected(this, reason);
 }
@@ -241,6 +401,16 @@ void IRCSession::onSendDataLen(int len) {
 void IRCSession::onRecvDataLen(int len) {
     // IRCSelector thread
     statsFromSelectorThread.commands.in.bytes += len;
+    recvBytes.fetch_add(len, std::memory_order_relaxed);
+    lastRecvTime = CurrentTime<std::chrono::steady_clock>::milliseconds();
+}
+
+void IRCSession::onLine(std::string_view event,
+                        std::string_view origin,
+                        const std::vector<std::string_view> &params) {
+    // IRCSelector thread
+    if (capture)
+        capture->write(captureKey, IRCCapture::makeLine(event, origin, params));
 }
 
 void IRCSession::onLoggedIn(std::string_view /*event*/,
@@ -250,6 +420,17 @@ void IRCSession::onLoggedIn(std::string_view /*event*/,
     logger->logTrace("{} Successfully logged in: {}", loggerTag, origin);
     ++statsFromSelectorThread.connects.loggedin;
 
+    auto now = CurrentTime<std::chrono::steady_clock>::milliseconds();
+    lastRecvTime = now;
+    lastPingTime = now;
+    pendingPing = 0;
+    loginDeadline = 0;
+    // new connection may land on another edge, old samples tell nothing about it
+    rttRecent.clear();
+    rttPrevious.clear();
+    rttRotateTime = now;
+    rttDegraded = false;
+    rttTail.store(0, std::memory_order_relaxed);
     logged.store(true, std::memory_order_relaxed);
     listener->onLoggedIn(this);
 }
@@ -317,9 +498,12 @@ void IRCSession::onChannel(std::string_view event,
     if (params.empty()) // invalid channel message
         return;
 
-    listener->onMessage(IRCMessage{params.front()[0] == '#' ? params.front().substr(1) : params.front(),
-                                   origin,
-                                   params.back()});
+    IRCMessage message{params.front()[0] == '#' ? params.front().substr(1) : params.front(),
+                       origin,
+                       params.back()};
+    // approximate line size, protocol overhead is the same for all channels
+    activityFromSelectorThread[message.channel] += message.text.size() + message.nickname.size();
+    listener->onMessage(std::move(message));
 }
 
 void IRCSession::onPrivmsg(std::string_view event,
@@ -387,13 +571,20 @@ void IRCSession::onCtcpAction(std::string_view event,
 
 void IRCSession::onPong(std::string_view event, std::string_view host) {
     // IRCSelector thread
-    lastPongTime = CurrentTime<std::chrono::system_clock>::milliseconds();
-    auto rtt = lastPongTime - lastPingTime;
-    logger->logTrace("{} Event {} received on {}. RTT: {}", loggerTag, event, host, rtt);
-    statsFromSelectorThread.commands.ping_pong.rtt = rtt;
     ++statsFromSelectorThread.commands.in.count;
+    if (!pendingPing) {
+        logger->logTrace("{} Event {} received on {}", loggerTag, event, host);
+        return;
+    }
 
-    sendStats(statsFromSelectorThread);
+    auto now = CurrentTime<std::chrono::steady_clock>::milliseconds();
+    auto rtt = now - pendingPing;
+    pendingPing = 0;
+    logger->logTrace("{} Event {} received on {}. RTT: {}", loggerTag, event, host, rtt);
+    statsFromSelectorThread.commands.ping_pong.rtt = rtt;
+    statsFromSelectorThread.commands.ping_pong.histogram.record(rtt);
+    this->rtt.store(static_cast<unsigned int>(rtt), std::memory_order_relaxed);
+    recordRtt(now, rtt);
 }
 
 void IRCSession::onUnknown(std::string_view event,
@@ -7,22 +7,25 @@
 
 #include <libircclient.h>
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 
-#include <so_5/timers.hpp>
-
 #include "Logger.h"
+#include "MPSCQueue.h"
 
 #include "IRCConnectionConfig.h"
 #include "IRCClientConfig.h"
 #include "IRCSessionContext.h"
 #include "IRCSessionCallback.h"
 #include "IRCSessionInterface.h"
+#include "IRCSessionListener.h"
 #include "IRCStatistic.h"
 
 class IRCClient;
-struct IRCSessionListener;
+class IRCCapture;
+class IRCSelector;
+class TraceBuffer;
 class IRCSession : public IRCSessionInterface, private IRCSessionCallback
 {
   public:
@@ -38,19 +41,36 @@ class IRCSession : public IRCSessionInterface, private IRCSessionCallback
 
     void create();
     void destroy();
+    /// Starts connection, IRCClient thread
     bool connect();
     bool connected();
     bool loggedIn();
+    /// Drops connection, IRCClient thread
     void disconnect();
 
     [[nodiscard]] unsigned int getId() const;
-
-    void setPingTimer(so_5::timer_id_t timer);
+    /// Process wide unique number of session, unlike address it is never reused by new session
+    [[nodiscard]] unsigned long long getSerial() const { return serial; }
+    /// Last PING/PONG round trip in milliseconds
+    [[nodiscard]] unsigned int getRtt() const { return rtt.load(std::memory_order_relaxed); }
+    /// p90 of PING/PONG round trips over the last few minutes, milliseconds
+    [[nodiscard]] unsigned int getRttTail() const { return rttTail.load(std::memory_order_relaxed); }
+    /// Inbound bytes since session creation
+    [[nodiscard]] unsigned long long getRecvBytes() const { return recvBytes.load(std::memory_order_relaxed); }
+
+    /// Ships statistic counted by so_5 threads, IRCClient thread
+    void shipStats();
+    /// Records inbound lines to capture, must be set before connect
+    void setCapture(IRCCapture *capture);
+    /// Records write spans of sampled bot answers, must be set before connect
+    void setTrace(TraceBuffer *buffer);
 
     // IRCSessionCommands
     bool sendQuit(const std::string& reason) override;
     bool sendJoin(const std::string& channel) override;
     bool sendJoin(const std::string& channel, const std::string& key) override;
+    /// Sends one "JOIN #a,#b,#c" line, caller keeps line length under IRC limit
+    bool sendJoin(const std::vector<std::string>& channels);
     bool sendPart(const std::string& channel) override;
     bool sendTopic(const std::string& channel, const std::string& topic) override;
     bool sendNames(const std::string& channel) override;
@@ -58,6 +78,8 @@ class IRCSession : public IRCSessionInterface, private IRCSessionCallback
     bool sendInvite(const std::string &channel, const std::string &nick) override;
     bool sendKick(const std::string &channel, const std::string &nick, const std::string &comment) override;
     bool sendMessage(const std::string& channel, const std::string& text) override;
+    /// PRIVMSG of sampled message, traceId is recorded when line is handed to libircclient
+    bool sendMessage(const std::string& channel, const std::string& text, uint64_t traceId);
     bool sendNotice(const std::string& channel, const std::string& text) override;
     bool sendMe(const std::string& channel, const std::string& text) override;
     bool sendChannelMode(const std::string& channel, const std::string& mode) override;
@@ -75,6 +97,7 @@ class IRCSession : public IRCSessionInterface, private IRCSessionCallback
     void onDisconnected(std::string_view event, std::string_view reason) override;
     void onSendDataLen(int len) override;
     void onRecvDataLen(int len) override;
+    void onLine(std::string_view event, std::string_view origin, const std::vector<std::string_view>& params) override;
 
     void onLoggedIn(std::string_view event, std::string_view origin, const std::vector<std::string_view>& params) override;
 
@@ -102,38 +125,73 @@ class IRCSession : public IRCSessionInterface, private IRCSessionCallback
     void onDccSendReq(std::string_view nick, std::string_view addr, std::string_view filename, unsigned long size, unsigned int dccid) override;
 
   private:
+    struct OutboundLine {
+        std::string text;
+        uint64_t traceId = 0;
+        long long queued = 0; // steady clock microseconds, set for traced lines only
+    };
+
     void sendStats(IRCStatistic & stats);
-    template<typename Foo, typename ...Args>
-    bool internalIrcSend(Foo irc_cmd, Args... args) {
-        // IRCClient thread
-        if (irc_cmd(session, args...)) {
-            logger->logError("IRCSession[{}] Failed to send {}: {}",
-                             fmt::ptr(this), __PRETTY_FUNCTION__, irc_strerror(irc_errno(session)));
-            return false;
-        }
-        ++statsFromSo5Thread.commands.out.count;
-        return true;
-    }
+    /// Puts formatted line(without CRLF) to outbound queue and wakes up selector, any thread
+    bool enqueue(std::string line, uint64_t traceId = 0);
+    /// Moves queued lines to libircclient output buffer, IRCSelector thread
+    void flush();
+    void setSelector(IRCSelector *owner);
+    /// Clears selector if session was not moved to another one yet
+    void resetSelector(IRCSelector *owner);
+    /// Login timeout, keepalive, PONG timeout and selector statistic shipping.
+    /// Returns steady clock milliseconds of the next call, IRCSelector thread
+    long long tick(long long now);
+    /// Adds RTT sample to recent window and checks it against reconnect_rtt, IRCSelector thread
+    void recordRtt(long long now, long long sample);
 
     const IRCConnectionConfig& conConfig;
     const IRCClientConfig& cliConfig;
 
     unsigned int id = 0;
+    const unsigned long long serial;
     IRCSessionContext ctx;
 
     IRCStatistic statsFromSo5Thread;
     IRCStatistic statsFromSelectorThread;
+    ChannelsActivity activityFromSelectorThread;
 
     IRCSessionListener* listener;
     Logger *logger;
     std::string loggerTag;
 
     std::atomic_bool logged = false;
-    so_5::timer_id_t pingTimer;
-    long long lastPingTime = 0;
-    long long lastPongTime = 0;
+    std::atomic<unsigned int> rtt = 0;
+    std::atomic<unsigned int> rttTail = 0;
+
+    // recent RTT samples, two halves of window rotated by time, IRCSelector thread
+    Histogram rttRecent;
+    Histogram rttPrevious;
+    long long rttRotateTime = 0;
+    bool rttDegraded = false;
+
+    // keepalive, IRCSelector thread, steady clock milliseconds
+    long long lastRecvTime = 0;
+    long long lastPingTime = 0;   // last PING sent by keepalive
+    long long pendingPing = 0;    // PING waiting for PONG, 0 if none
+    long long nextStatsTime = 0;
+    long long loginDeadline = 0;  // set by connect() under processMutex, 0 if login is not awaited
+    IRCSelector *ticker = nullptr; // selector that has tick of session in its deadlines
+    long long nextTick = 0;
 
     irc_session_t *session = nullptr;
+
+    // written by so_5 threads, drained by selector right before select()
+    MPSCQueue<OutboundLine> outbound;
+    OutboundLine stalled; // line that didn't fit libircclient buffer, IRCSelector thread
+    std::atomic<IRCSelector *> selector = nullptr;
+    // held by selector while session is processed, uncontended unless session moves between selectors
+    std::mutex processMutex;
+    std::atomic<unsigned long long> recvBytes = 0;
+
+    IRCCapture *capture = nullptr;
+    uint32_t captureKey = 0;
+    TraceBuffer *trace = nullptr;
 };
 
 #endif //CHATCONTROLLER_IRC_IRCSESSION_H_
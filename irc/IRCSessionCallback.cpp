@@ -9,6 +9,12 @@
 
 #define irc_event_callback_to_cxx(function) \
 static_cast<IRCSessionContext *>(irc_get_ctx(session))->callback->function(event, origin, std::vector<std::string_view>{params, params + count})
+// login is reported by libircclient together with numeric 001, so it is not passed to onLine
+#define irc_line_callback_to_cxx(function) \
+auto *callback = static_cast<IRCSessionContext *>(irc_get_ctx(session))->callback; \
+std::vector<std::string_view> args{params, params + count}; \
+callback->onLine(event, origin, args); \
+callback->function(event, origin, args)
 #define irc_event_connected_to_cxx(function) \
 static_cast<IRCSessionContext *>(irc_get_ctx(session))->callback->function(event, host)
 #define irc_event_disconnected_to_cxx(function) \
@@ -45,61 +51,66 @@ static void on_login(irc_session_t *session, const char *event, const char *orig
     irc_event_callback_to_cxx(onLoggedIn);
 }
 static void on_nick(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onNick);
+    irc_line_callback_to_cxx(onNick);
 }
 static void on_quit(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onQuit);
+    irc_line_callback_to_cxx(onQuit);
 }
 static void on_join(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onJoin);
+    irc_line_callback_to_cxx(onJoin);
 }
 static void on_part(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onPart);
+    irc_line_callback_to_cxx(onPart);
 }
 static void on_mode(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onMode);
+    irc_line_callback_to_cxx(onMode);
 }
 static void on_umode(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onUmode);
+    irc_line_callback_to_cxx(onUmode);
 }
 static void on_topic(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onTopic);
+    irc_line_callback_to_cxx(onTopic);
 }
 static void on_kick(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onKick);
+    irc_line_callback_to_cxx(onKick);
 }
 static void on_channel(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onChannel);
+    irc_line_callback_to_cxx(onChannel);
 }
 static void on_privmsg(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onPrivmsg);
+    irc_line_callback_to_cxx(onPrivmsg);
 }
 static void on_notice(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onNotice);
+    irc_line_callback_to_cxx(onNotice);
 }
 static void on_channel_notice(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onChannelNotice);
+    irc_line_callback_to_cxx(onChannelNotice);
 }
 static void on_invite(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onInvite);
+    irc_line_callback_to_cxx(onInvite);
 }
 static void on_ctcp_req(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onCtcpReq);
+    irc_line_callback_to_cxx(onCtcpReq);
 }
 static void on_ctcp_rep(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onCtcpRep);
+    irc_line_callback_to_cxx(onCtcpRep);
 }
 static void on_ctcp_action(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onCtcpAction);
+    irc_line_callback_to_cxx(onCtcpAction);
 }
 static void on_pong(irc_session_t *session, const char *event, const char *host) {
     irc_event_connected_to_cxx(onPong);
 }
 static void on_unknown(irc_session_t *session, const char *event, const char *origin, const char **params, unsigned int count) {
-    irc_event_callback_to_cxx(onUnknown);
+    irc_line_callback_to_cxx(onUnknown);
 }
 static void on_numeric(irc_session_t *session, unsigned int event, const char *origin, const char ** params, unsigned int count) {
-    irc_event_callback_to_cxx(onNumeric);
+    auto *callback = static_cast<IRCSessionContext *>(irc_get_ctx(session))->callback;
+    std::vector<std::string_view> args{params, params + count};
+    char code[16];
+    std::snprintf(code, sizeof(code), "%03u", event);
+    callback->onLine(code, origin, args);
+    callback->onNumeric(event, origin, args);
 }
 static void on_dcc_chat_req(irc_session_t *session, const char *nick, const char *addr, irc_dcc_t dccid) {
     irc_event_dcc_chat_to_cxx(onDccChatReq);
@@ -23,6 +23,9 @@ class IRCSessionCallback : public irc_callbacks_t {
                                 std::string_view reason [[maybe_unused]]) {};
     virtual void onSendDataLen(int len [[maybe_unused]]) {};
     virtual void onRecvDataLen(int len [[maybe_unused]]) {};
+    // Every parsed server line, called before specific event(numeric event is zero padded)
+    virtual void onLine(std::string_view event [[maybe_unused]], std::string_view origin  [[maybe_unused]],
+                        const std::vector<std::string_view>& params [[maybe_unused]]) {};
     // IRC common events
     virtual void onLoggedIn(std::string_view event [[maybe_unused]], std::string_view origin  [[maybe_unused]],
                             const std::vector<std::string_view>& params [[maybe_unused]]) {};
@@ -5,6 +5,11 @@
 #ifndef CHATCONTROLLER_IRC_IRCSESSIONLISTENER_H_
 #define CHATCONTROLLER_IRC_IRCSESSIONLISTENER_H_
 
+#include <string>
+#include <unordered_map>
+
+using ChannelsActivity = std::unordered_map<std::string, unsigned int>; // channel -> received bytes
+
 struct IRCMessage;
 struct IRCStatistic;
 class IRCSession;
@@ -14,6 +19,7 @@ struct IRCSessionListener {
     virtual void onMessage(IRCMessage &&message) = 0;
     virtual void onJoined(IRCSession *session, std::string_view channel) = 0;
     virtual void onStatistics(IRCSession* session, IRCStatistic&& stats) = 0;
+    virtual void onChannelsActivity(IRCSession* session, ChannelsActivity&& activity) = 0;
 };
 
 #endif //CHATCONTROLLER_IRC_IRCSESSIONLISTENER_H_
@@ -9,6 +9,8 @@
 
 #include "nlohmann/json.hpp"
 
+#include "Histogram.h"
+
 using json = nlohmann::json;
 
 
@@ -30,6 +32,7 @@ struct IRCStatistic
         if (rhs.commands.ping_pong.rtt > 0) {
             commands.ping_pong.rtt = rhs.commands.ping_pong.rtt;
         }
+        commands.ping_pong.histogram.merge(rhs.commands.ping_pong.histogram);
         return *this;
     }
     inline IRCStatistic& operator+=(const IRCStatistic & rhs) {
@@ -54,11 +57,34 @@ struct IRCStatistic
             unsigned int count = 0;
         } out;
         struct {
-            unsigned int rtt = 0;
+            unsigned int rtt = 0; // the last one, milliseconds
+            Histogram histogram;  // all RTT samples, milliseconds
         } ping_pong;
     } commands;
 };
 
+struct IRCJoinStatistic
+{
+    unsigned long long channels = 0; // channels sent in JOIN lines
+    unsigned long long lines = 0;
+    size_t backlog = 0;  // gauge, channels waiting for rate limit
+    size_t inflight = 0; // gauge, channels sent without confirmation
+    Histogram wait;      // milliseconds in queue
+    Histogram latency;   // milliseconds from queue to server confirmation
+};
+
+struct IRCSelectorStatistic
+{
+    size_t id = 0;
+    size_t sessions = 0;
+    unsigned long long rounds = 0;
+    unsigned long long busy = 0; // microseconds spent outside select()
+    double utilisation = 0;      // busy share of wall time
+    double bytesRate = 0;        // inbound bytes per second of selector sessions
+    Histogram loop;              // microseconds of one round outside select()
+    Histogram lag;               // milliseconds sessions ticks ran after their deadline
+};
+
 namespace Irc {
 using ChannelsToSessionId = std::vector<std::pair<std::string, unsigned int>>;
 struct SessionMetrics {
@@ -66,13 +92,40 @@ struct SessionMetrics {
     std::string nick;
     IRCStatistic stats;
 };
+struct ClientJoinMetrics {
+    std::string nick;
+    IRCJoinStatistic stats;
+};
+struct SelectorsMetrics {
+    std::vector<IRCSelectorStatistic> selectors;
+};
+struct ChannelsDelta {
+    static constexpr unsigned int DETACHED = -1u;
+    static constexpr unsigned int REMOVED = -2u;
+
+    bool full = false;            // channels is the whole list, previous state must be dropped
+    ChannelsToSessionId channels; // channel -> session id, DETACHED or REMOVED
+};
 struct ClientChannelsMetrics {
     const std::string nick;
-    mutable ChannelsToSessionId channelsToSession;
+    mutable ChannelsDelta delta;
 };
 }
 
 
+inline json histogramToJson(const Histogram& hist) {
+    return {
+        {"count", hist.count()},
+        {"min", hist.min()},
+        {"max", hist.max()},
+        {"mean", hist.mean()},
+        {"p50", hist.percentile(50)},
+        {"p90", hist.percentile(90)},
+        {"p99", hist.percentile(99)},
+        {"p999", hist.percentile(99.9)}
+    };
+}
+
 inline json ircStatisticToJson(const IRCStatistic& stats) {
     json res = json::object();
     res["connects"] = {
@@ -95,7 +148,8 @@ inline json ircStatisticToJson(const IRCStatistic& stats) {
         }
         },
         { "ping_pong", {
-            {"rtt", stats.commands.ping_pong.rtt}
+            {"rtt", stats.commands.ping_pong.rtt},
+            {"rtt_histogram", histogramToJson(stats.commands.ping_pong.histogram)}
         }
         }
     };
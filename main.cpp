@@ -19,6 +19,7 @@
 #include "db/pg/PGConnectionPool.h"
 
 #include "So5Helpers.h"
+#include "So5HandlerTracker.h"
 #include "HttpController.h"
 #include "HttpNotifier.h"
 #include "DBController.h"
@@ -102,17 +103,27 @@ int main(int argc, char *argv[]) {
         return UNIT_RESTART;
     }
 
+    // per handler timing of all agents, hook and stats must outlive environment
+    std::shared_ptr<So5HandlerTracker> handlerTracker;
+    if (config[APP]["so5_handler_tracking"].value_or(false))
+        handlerTracker = std::make_shared<So5HandlerTracker>();
+
     try {
         set_thread_name("main_launch");
         so_5::launch([&](so_5::environment_t &env) {
                 auto httpBox = env.create_mbox();
-                env.register_agent_as_coop(env.make_agent<Controller>(httpBox, config, db, appLogger));
+                env.register_agent_as_coop(env.make_agent<Controller>(httpBox, config, db, handlerTracker, appLogger));
                 env.register_agent_as_coop(env.make_agent<HttpController>(httpBox, config, httpLogger));
                 env.register_agent_as_coop(env.make_agent<HttpNotifier>(config, httpLogger));
             },
             [&]( so_5::environment_params_t & params ) {
                 params.error_logger(std::make_shared<So5Logger>(appLogger));
                 params.message_delivery_tracer(std::make_unique<So5MessageTrace>(appLogger));
+                if (handlerTracker) {
+                    params.event_queue_hook(so_5::event_queue_hook_unique_ptr_t{
+                        handlerTracker.get(), &so_5::event_queue_hook_t::noop_deleter});
+                    params.turn_work_thread_activity_tracking_on();
+                }
 
                 // Setup filter which enables only messages with null event_handler_data_ptr.
                 params.message_delivery_tracer_filter(so_5::msg_tracing::make_filter(
@@ -138,11 +149,9 @@ int main(int argc, char *argv[]) {
     // TODO add statistics for StatsCollector
 
     // TODO Make bot answers faster
-    // 0. TODO add timers for round trip time in chatcontroller
     // 0. TODO fast multithread mbox find for bot
     // 1. TODO remove BotEnvrionment from (MessageProcessor->BotEnvrionment->BotEngine) chain
     // 2. TODO remake ignored for answer nicknames
-    // 3. TODO split IRCSelector for read and write threads (?)
 
     // TODO fix options, remove useless and add controls
 
@@ -153,8 +162,6 @@ int main(int argc, char *argv[]) {
     // TODO add tags support
     // TODO add HTTPClient
     // TODO add TwitchAPI
-    // TODO add smileys detection for messages
-    // TODO add key value storage
 
     // TODO make web admin
 
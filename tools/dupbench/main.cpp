@@ -0,0 +1,150 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <array>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "Clock.h"
+#include "Options.h"
+
+#include "../../DuplicateDetector.h"
+
+// Synthetic raid: chat of popular channels flooded with a few copypastas, part of them slightly edited.
+// Messages are generated before measurement, so only DuplicateDetector::check is timed.
+
+static constexpr std::array<const char *, 32> WORDS = {
+    "lul", "pog", "kappa", "gg", "wp", "nice", "what", "is", "this", "stream", "chat", "hello",
+    "streamer", "play", "again", "no", "way", "insane", "clip", "it", "omegalul", "first", "time",
+    "here", "love", "the", "music", "when", "next", "game", "monkas", "ez"
+};
+
+static constexpr std::array<const char *, 8> COPYPASTAS = {
+    "this is a copypasta that chat repeats again and again",
+    "HAHAHA look at this streamer playing with mouse upside down LUL LUL LUL",
+    "I am a long copypasta about the streamer who never reads the chat",
+    "RAID RAID RAID welcome everyone from the best community on twitch PogChamp",
+    "if you are reading this you are a legend, do not scroll up to check",
+    "this chat is so fast nobody will notice that I love pineapple pizza",
+    "GIVE US THE SONG NAME GIVE US THE SONG NAME GIVE US THE SONG NAME",
+    "imagine watching this stream in 2026 and still not being subscribed Kappa",
+};
+
+struct RaidMessage {
+    size_t channel = 0;
+    std::string text;
+    long long timestamp = 0; // milliseconds
+};
+
+struct RaidConfig {
+    size_t messages = 1000000;
+    size_t channels = 200;
+    double rate = 20000;       // messages per second of all channels
+    double copypasta = 0.7;    // share of copypasta messages
+    unsigned int maxEdits = 2; // random character edits of copypasta, 0 edits keeps it exact
+    unsigned int seed = 42;
+};
+
+static std::vector<RaidMessage> generate(const RaidConfig &config) {
+    std::mt19937_64 random(config.seed);
+    std::uniform_real_distribution<double> uniform(0., 1.);
+
+    // channels popularity follows Zipf law like real chats
+    std::vector<double> cdf;
+    double sum = 0;
+    for (size_t i = 0; i < config.channels; ++i)
+        cdf.push_back(sum += 1. / static_cast<double>(i + 1));
+
+    std::vector<RaidMessage> res;
+    res.reserve(config.messages);
+    for (size_t i = 0; i < config.messages; ++i) {
+        RaidMessage message;
+        double pick = uniform(random) * sum;
+        message.channel = std::lower_bound(cdf.begin(), cdf.end(), pick) - cdf.begin();
+        message.timestamp = static_cast<long long>(static_cast<double>(i) * 1000. / config.rate);
+
+        if (uniform(random) < config.copypasta) {
+            message.text = COPYPASTAS[random() % COPYPASTAS.size()];
+            unsigned int edits = random() % (config.maxEdits + 1);
+            for (unsigned int e = 0; e < edits; ++e) {
+                size_t pos = random() % message.text.size();
+                auto c = static_cast<char>('a' + random() % 26);
+                switch (random() % 3) {
+                    case 0: message.text.insert(pos, 1, c); break;
+                    case 1: message.text.erase(pos, 1); break;
+                    default: message.text[pos] = c; break;
+                }
+            }
+        } else {
+            size_t words = 3 + random() % 10;
+            for (size_t w = 0; w < words; ++w) {
+                if (w > 0)
+                    message.text.push_back(' ');
+                message.text.append(WORDS[random() % WORDS.size()]);
+            }
+        }
+        res.push_back(std::move(message));
+    }
+    return res;
+}
+
+int main(int argc, char *argv[]) {
+    Options options{"dupbench", "DuplicateDetector throughput on synthetic raid"};
+    options.addOption<size_t>("messages", "n", "Messages count", "1000000");
+    options.addOption<size_t>("channels", "c", "Channels count", "200");
+    options.addOption<double>("rate", "R", "Messages per second of all channels, sets timestamps", "20000");
+    options.addOption<double>("copypasta", "p", "Share of copypasta messages", "0.7");
+    options.addOption<unsigned int>("edits", "e", "Max random character edits of copypasta", "2");
+    options.addOption<unsigned int>("seed", "s", "Random seed", "42");
+    options.addOption<size_t>("min-length", "", "duplicates_min_length", "8");
+    options.addOption<size_t>("window-size", "", "duplicates_window_size", "64");
+    options.addOption<long long>("window-time", "", "duplicates_window_time, milliseconds", "30000");
+    options.addOption<int>("max-distance", "", "duplicates_max_distance", "10");
+    options.parse(argc, argv);
+
+    RaidConfig raid;
+    raid.messages = options.getValue<size_t>("messages");
+    raid.channels = std::max<size_t>(options.getValue<size_t>("channels"), 1);
+    raid.rate = std::max(options.getValue<double>("rate"), 1.);
+    raid.copypasta = options.getValue<double>("copypasta");
+    raid.maxEdits = options.getValue<unsigned int>("edits");
+    raid.seed = options.getValue<unsigned int>("seed");
+
+    DuplicateDetectorConfig config;
+    config.minTextLength = options.getValue<size_t>("min-length");
+    config.windowSize = options.getValue<size_t>("window-size");
+    config.windowTime = options.getValue<long long>("window-time");
+    config.maxDistance = options.getValue<int>("max-distance");
+
+    auto messages = generate(raid);
+    std::vector<std::string> channels;
+    for (size_t i = 0; i < raid.channels; ++i)
+        channels.push_back(fmt::format("channel{}", i));
+
+    DuplicateDetector detector(config);
+    auto start = CurrentTime<std::chrono::steady_clock>::microseconds();
+    for (size_t i = 0; i < messages.size(); ++i) {
+        const auto &message = messages[i];
+        detector.check(channels[message.channel], uint128_t{i + 1, 0}, message.text, message.timestamp);
+    }
+    auto elapsed = CurrentTime<std::chrono::steady_clock>::microseconds() - start;
+    auto stats = detector.collectStats();
+
+    auto percent = [&messages] (unsigned long long value) {
+        return messages.empty() ? 0. : 100. * static_cast<double>(value) / static_cast<double>(messages.size());
+    };
+    fmt::print("{} messages, {} channels, {:.0f}% copypasta with up to {} edits, seed {}\n",
+               messages.size(), raid.channels, raid.copypasta * 100, raid.maxEdits, raid.seed);
+    fmt::print("window {} entries/{} ms, max distance {}\n", config.windowSize, config.windowTime, config.maxDistance);
+    fmt::print("{:.0f} msg/s single thread, {:.3f} us per message\n",
+               elapsed > 0 ? static_cast<double>(messages.size()) * 1e6 / static_cast<double>(elapsed) : 0.,
+               messages.empty() ? 0. : static_cast<double>(elapsed) / static_cast<double>(messages.size()));
+    fmt::print("duplicates {:.1f}% (exact {:.1f}%), checked {}\n",
+               percent(stats.duplicates), percent(stats.exact), stats.checked);
+    return 0;
+}
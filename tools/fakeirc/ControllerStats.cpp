@@ -0,0 +1,121 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <nlohmann/json.hpp>
+
+#include "Logger.h"
+#include "ThreadName.h"
+#include "network/TCPSocket.h"
+
+#include "ControllerStats.h"
+
+using json = nlohmann::json;
+
+static std::string encodeBase64(const std::string &data) {
+    static constexpr const char *ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string res;
+    res.reserve((data.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < data.size(); i += 3) {
+        unsigned int chunk = static_cast<unsigned char>(data[i]) << 16;
+        if (i + 1 < data.size())
+            chunk |= static_cast<unsigned char>(data[i + 1]) << 8;
+        if (i + 2 < data.size())
+            chunk |= static_cast<unsigned char>(data[i + 2]);
+
+        res.push_back(ALPHABET[(chunk >> 18) & 0x3F]);
+        res.push_back(ALPHABET[(chunk >> 12) & 0x3F]);
+        res.push_back(i + 1 < data.size() ? ALPHABET[(chunk >> 6) & 0x3F] : '=');
+        res.push_back(i + 2 < data.size() ? ALPHABET[chunk & 0x3F] : '=');
+    }
+    return res;
+}
+
+ControllerStats::ControllerStats(ControllerStatsConfig config) : config(std::move(config)) {
+    if (!this->config.user.empty())
+        auth = encodeBase64(this->config.user + ":" + this->config.password);
+}
+
+ControllerStats::~ControllerStats() {
+    stop();
+}
+
+void ControllerStats::start() {
+    if (!enabled() || thread.joinable())
+        return;
+    thread = std::thread(&ControllerStats::run, this);
+    set_thread_name(thread, "ctrl_stats");
+}
+
+void ControllerStats::stop() {
+    {
+        std::lock_guard lg(mutex);
+        stopped = true;
+    }
+    cv.notify_all();
+    if (thread.joinable())
+        thread.join();
+}
+
+void ControllerStats::run() {
+    // first read drops counters gathered before the test
+    poll();
+    total.store(0, std::memory_order_relaxed);
+
+    std::unique_lock lock(mutex);
+    while (!cv.wait_for(lock, std::chrono::seconds(config.period), [this] { return stopped; })) {
+        lock.unlock();
+        if (!poll())
+            errors.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+    }
+
+    // messages which were in flight at stop
+    lock.unlock();
+    poll();
+}
+
+bool ControllerStats::poll() {
+    TCPSocket socket;
+    socket.setBlocking(true);
+    if (socket.connect(config.host, config.port, std::chrono::seconds(1)) != Socket::Done) {
+        DefaultLogger::logWarn("ControllerStats Failed to connect to {}:{}", config.host, config.port);
+        socket.disconnect();
+        return false;
+    }
+
+    timeval timeout{5, 0};
+    setsockopt(socket.getHandle(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string request = fmt::format("GET /stats/channel HTTP/1.1\r\nHost: {}:{}\r\nConnection: close\r\n",
+                                      config.host, config.port);
+    if (!auth.empty())
+        request.append("Authorization: Basic ").append(auth).append("\r\n");
+    request.append("\r\n");
+
+    std::string response;
+    if (socket.send(request.data(), static_cast<int>(request.size())) == Socket::Done) {
+        char buffer[16 * 1024];
+        int received = 0;
+        while (socket.receive(buffer, sizeof(buffer), received) == Socket::Done)
+            response.append(buffer, received);
+    }
+    socket.disconnect();
+
+    auto bodyPos = response.find("\r\n\r\n");
+    if (response.compare(0, 5, "HTTP/") != 0 || response.compare(8, 4, " 200") != 0 || bodyPos == std::string::npos) {
+        DefaultLogger::logWarn("ControllerStats Bad response from {}:{}: {}",
+                               config.host, config.port, response.substr(0, response.find("\r\n")));
+        return false;
+    }
+
+    json body = json::parse(response.begin() + bodyPos + 4, response.end(), nullptr, false);
+    if (body.is_discarded() || !body["channels"].is_array())
+        return false;
+
+    unsigned long long count = 0;
+    for (const auto &channel: body["channels"])
+        count += channel["in"]["count"].get<unsigned long long>();
+    total.fetch_add(count, std::memory_order_relaxed);
+    return true;
+}
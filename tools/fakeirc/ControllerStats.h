@@ -0,0 +1,56 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_TOOLS_FAKEIRC_CONTROLLERSTATS_H_
+#define CHATCONTROLLER_TOOLS_FAKEIRC_CONTROLLERSTATS_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct ControllerStatsConfig {
+    std::string host;            // empty disables polling
+    unsigned short port = 8081;
+    std::string user;
+    std::string password;
+    unsigned int period = 5;     // seconds
+};
+
+// Polls chatcontroller /stats/channel over plain HTTP([control] secure = false)
+// and sums received messages. Controller resets channel counters on read,
+// so the poller must be the only reader during the test.
+class ControllerStats
+{
+  public:
+    explicit ControllerStats(ControllerStatsConfig config);
+    ~ControllerStats();
+
+    void start();
+    void stop();
+
+    [[nodiscard]] bool enabled() const { return !config.host.empty(); }
+    /// Messages received by controller since start
+    [[nodiscard]] unsigned long long received() const { return total.load(std::memory_order_relaxed); }
+    /// Failed polls since start
+    [[nodiscard]] unsigned long long failed() const { return errors.load(std::memory_order_relaxed); }
+
+  private:
+    void run();
+    bool poll();
+
+    const ControllerStatsConfig config;
+    std::string auth;
+
+    std::atomic<unsigned long long> total = 0;
+    std::atomic<unsigned long long> errors = 0;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopped = false;
+    std::thread thread;
+};
+
+#endif //CHATCONTROLLER_TOOLS_FAKEIRC_CONTROLLERSTATS_H_
@@ -0,0 +1,331 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+#include <poll.h>
+
+#include <fmt/format.h>
+
+#include "Clock.h"
+#include "Logger.h"
+#include "SysSignal.h"
+
+#include "ControllerStats.h"
+#include "FakeIRCServer.h"
+
+#define TICK_MS 5
+#define SERVER_NAME "tmi.twitch.tv"
+
+// splits "CMD params" after optional tags and prefix
+static std::pair<std::string_view, std::string_view> splitCommand(std::string_view line) {
+    if (!line.empty() && line.front() == '@')
+        line.remove_prefix(std::min(line.find(' ') + 1, line.size()));
+    if (!line.empty() && line.front() == ':')
+        line.remove_prefix(std::min(line.find(' ') + 1, line.size()));
+
+    auto space = line.find(' ');
+    if (space == std::string_view::npos)
+        return {line, {}};
+    return {line.substr(0, space), line.substr(space + 1)};
+}
+
+static std::string_view trailing(std::string_view params) {
+    if (!params.empty() && params.front() == ':')
+        params.remove_prefix(1);
+    return params;
+}
+
+FakeIRCServer::FakeIRCServer(FakeIRCServerConfig config, std::unique_ptr<FakeTraffic> traffic,
+                             const ControllerStats &controller)
+  : config(std::move(config)), traffic(std::move(traffic)), controller(controller) {
+}
+
+FakeIRCServer::~FakeIRCServer() {
+    for (auto &client: clients)
+        client->socket.disconnect();
+    listener.close();
+}
+
+bool FakeIRCServer::run() {
+    if (listener.listen(config.host, config.port) != Socket::Done) {
+        DefaultLogger::logError("FakeIRCServer Failed to listen on {}:{}", config.host, config.port);
+        return false;
+    }
+    DefaultLogger::logInfo("FakeIRCServer Listening on {}:{}, speed x{}", config.host, config.port, config.speed);
+
+    auto start = CurrentTime<std::chrono::steady_clock>::milliseconds();
+    lastReportTime = start;
+
+    bool exhausted = false;
+    std::vector<pollfd> fds;
+    std::vector<FakeLine> lines;
+    while (!SysSignal::serviceTerminated()) {
+        fds.clear();
+        fds.push_back({listener.getHandle(), POLLIN, 0});
+        bool pendingOutput = false;
+        for (auto &client: clients) {
+            short events = POLLIN;
+            if (client->output.size() > client->outputOffset) {
+                events |= POLLOUT;
+                pendingOutput = true;
+            }
+            fds.push_back({client->socket.getHandle(), events, 0});
+        }
+
+        // replay is over, stop when everything is written out
+        if (exhausted && !pendingOutput)
+            break;
+
+        if (poll(fds.data(), fds.size(), TICK_MS) < 0 && errno != EINTR) {
+            DefaultLogger::logError("FakeIRCServer Failed to poll: {}", strerror(errno));
+            return false;
+        }
+
+        if (fds[0].revents & POLLIN)
+            accept();
+        for (size_t i = 1; i < fds.size(); ++i) {
+            auto &client = *clients[i - 1];
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR))
+                read(client);
+        }
+
+        auto now = CurrentTime<std::chrono::steady_clock>::milliseconds();
+        if (!exhausted) {
+            lines.clear();
+            auto virtualTime = static_cast<long long>(static_cast<double>(now - start) * config.speed);
+            exhausted = !traffic->generate(virtualTime, lines);
+            dispatch(lines);
+            if (exhausted)
+                DefaultLogger::logInfo("FakeIRCServer Traffic is over, flushing clients");
+        }
+
+        for (auto &client: clients) {
+            if (!client->closing && client->output.size() > client->outputOffset)
+                write(*client);
+        }
+
+        // drop closed clients
+        for (auto &client: clients) {
+            if (client->closing) {
+                leaveAll(*client);
+                client->socket.disconnect();
+                DefaultLogger::logInfo("FakeIRCServer Client {}({}) disconnected", client->nick, client->address);
+            }
+        }
+        clients.erase(std::remove_if(clients.begin(), clients.end(), [] (const auto &client) {
+            return client->closing;
+        }), clients.end());
+
+        if (now - lastReportTime >= config.report * 1000)
+            report(now, false);
+    }
+
+    report(CurrentTime<std::chrono::steady_clock>::milliseconds(), true);
+    return true;
+}
+
+void FakeIRCServer::accept() {
+    while (true) {
+        auto client = std::make_unique<Client>();
+        if (listener.accept(client->socket) != Socket::Done)
+            break;
+        client->socket.setBlocking(false);
+        client->address = fmt::format("{}:{}", client->socket.getRemoteAddress(), client->socket.getRemotePort());
+        DefaultLogger::logInfo("FakeIRCServer Client connected from {}", client->address);
+        clients.push_back(std::move(client));
+    }
+}
+
+void FakeIRCServer::read(Client &client) {
+    char buffer[16 * 1024];
+    int received = 0;
+    Socket::Status status;
+    while ((status = client.socket.receive(buffer, sizeof(buffer), received)) == Socket::Done)
+        client.input.append(buffer, received);
+    if (status == Socket::Disconnected || status == Socket::Error)
+        client.closing = true;
+
+    size_t begin = 0;
+    for (size_t end; (end = client.input.find('\n', begin)) != std::string::npos; begin = end + 1) {
+        std::string_view line(client.input.data() + begin, end - begin);
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if (!line.empty())
+            handle(client, line);
+    }
+    client.input.erase(0, begin);
+}
+
+void FakeIRCServer::write(Client &client) {
+    int sent = 0;
+    auto status = client.socket.send(client.output.data() + client.outputOffset,
+                                     static_cast<int>(client.output.size() - client.outputOffset), sent);
+    if (status == Socket::Disconnected || status == Socket::Error) {
+        client.closing = true;
+        return;
+    }
+
+    stats.bytes += sent;
+    client.outputOffset += sent;
+    if (client.outputOffset == client.output.size()) {
+        client.output.clear();
+        client.outputOffset = 0;
+    } else if (client.outputOffset > client.output.size() / 2) {
+        client.output.erase(0, client.outputOffset);
+        client.outputOffset = 0;
+    }
+}
+
+void FakeIRCServer::handle(Client &client, std::string_view line) {
+    auto [command, params] = splitCommand(line);
+
+    if (command == "PASS" || command == "USER") {
+        return;
+    } else if (command == "CAP") {
+        if (params.rfind("LS", 0) == 0) {
+            send(client, ":" SERVER_NAME " CAP * LS :twitch.tv/tags twitch.tv/commands twitch.tv/membership");
+        } else if (params.rfind("REQ", 0) == 0) {
+            auto caps = trailing(params.substr(std::min<size_t>(4, params.size())));
+            client.tags = client.tags || caps.find("twitch.tv/tags") != std::string_view::npos;
+            send(client, fmt::format(":" SERVER_NAME " CAP * ACK :{}", caps));
+        }
+        return;
+    } else if (command == "NICK") {
+        client.nick = trailing(params);
+        if (!client.registered) {
+            client.registered = true;
+            const auto &nick = client.nick;
+            send(client, fmt::format(":" SERVER_NAME " 001 {} :Welcome, GLHF!", nick));
+            send(client, fmt::format(":" SERVER_NAME " 002 {} :Your host is " SERVER_NAME, nick));
+            send(client, fmt::format(":" SERVER_NAME " 003 {} :This server is rather new", nick));
+            send(client, fmt::format(":" SERVER_NAME " 004 {} :-", nick));
+            send(client, fmt::format(":" SERVER_NAME " 375 {} :-", nick));
+            send(client, fmt::format(":" SERVER_NAME " 372 {} :You are in a maze of twisty passages, all alike.", nick));
+            send(client, fmt::format(":" SERVER_NAME " 376 {} :>", nick));
+        }
+        return;
+    } else if (command == "PING") {
+        send(client, fmt::format(":" SERVER_NAME " PONG " SERVER_NAME " :{}", trailing(params)));
+        return;
+    } else if (command == "QUIT") {
+        client.closing = true;
+        return;
+    }
+
+    if (!client.registered)
+        return;
+
+    if (command == "JOIN") {
+        join(client, params.substr(0, params.find(' ')));
+    } else if (command == "PART") {
+        part(client, params.substr(0, params.find(' ')));
+    } else if (command == "PRIVMSG") {
+        ++stats.replies;
+    } else {
+        send(client, fmt::format(":" SERVER_NAME " 421 {} {} :Unknown command", client.nick, command));
+    }
+}
+
+void FakeIRCServer::join(Client &client, std::string_view list) {
+    while (!list.empty()) {
+        auto name = list.substr(0, list.find(','));
+        list.remove_prefix(std::min(name.size() + 1, list.size()));
+        if (!name.empty() && name.front() == '#')
+            name.remove_prefix(1);
+        if (name.empty())
+            continue;
+
+        auto &subscribers = channels[std::string(name)];
+        if (std::find(subscribers.begin(), subscribers.end(), &client) == subscribers.end()) {
+            subscribers.push_back(&client);
+            client.channels.emplace_back(name);
+        }
+
+        const auto &nick = client.nick;
+        send(client, fmt::format(":{0}!{0}@{0}.tmi.twitch.tv JOIN #{1}", nick, name));
+        send(client, fmt::format(":{0}.tmi.twitch.tv 353 {0} = #{1} :{0}", nick, name));
+        send(client, fmt::format(":{0}.tmi.twitch.tv 366 {0} #{1} :End of /NAMES list", nick, name));
+    }
+}
+
+void FakeIRCServer::part(Client &client, std::string_view list) {
+    while (!list.empty()) {
+        auto name = list.substr(0, list.find(','));
+        list.remove_prefix(std::min(name.size() + 1, list.size()));
+        if (!name.empty() && name.front() == '#')
+            name.remove_prefix(1);
+
+        if (auto it = channels.find(std::string(name)); it != channels.end()) {
+            auto &subscribers = it->second;
+            subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), &client), subscribers.end());
+        }
+        client.channels.erase(std::remove(client.channels.begin(), client.channels.end(), name), client.channels.end());
+        send(client, fmt::format(":{0}!{0}@{0}.tmi.twitch.tv PART #{1}", client.nick, name));
+    }
+}
+
+void FakeIRCServer::leaveAll(Client &client) {
+    for (auto &name: client.channels) {
+        auto &subscribers = channels[name];
+        subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), &client), subscribers.end());
+    }
+    client.channels.clear();
+}
+
+void FakeIRCServer::send(Client &client, std::string_view line) {
+    client.output.append(line).append("\r\n");
+}
+
+void FakeIRCServer::dispatch(const std::vector<FakeLine> &lines) {
+    for (const auto &line: lines) {
+        ++stats.generated;
+        auto it = channels.find(line.channel);
+        if (it == channels.end())
+            continue;
+
+        std::string_view full = line.line;
+        std::string_view plain = full;
+        if (!plain.empty() && plain.front() == '@')
+            plain.remove_prefix(std::min(plain.find(' ') + 1, plain.size()));
+
+        for (auto *client: it->second) {
+            // slow consumer, keep server memory bounded and count the loss on our side
+            if (client->output.size() - client->outputOffset > config.maxOutput) {
+                ++stats.dropped;
+                continue;
+            }
+            send(*client, client->tags ? full : plain);
+            ++stats.delivered;
+        }
+    }
+}
+
+void FakeIRCServer::report(long long now, bool final) {
+    double seconds = static_cast<double>(std::max(now - lastReportTime, 1LL)) / 1000.;
+    auto rate = [seconds] (unsigned long long value, unsigned long long last) {
+        return static_cast<unsigned long long>(static_cast<double>(value - last) / seconds);
+    };
+
+    size_t joined = 0;
+    for (auto &[name, subscribers]: channels)
+        joined += !subscribers.empty();
+
+    DefaultLogger::logInfo("FakeIRCServer clients: {}, channels: {}, generated: {}/s, delivered: {}/s, "
+                           "dropped: {}/s, out: {} bytes/s, replies: {}/s",
+                           clients.size(), joined,
+                           rate(stats.generated, lastReport.generated), rate(stats.delivered, lastReport.delivered),
+                           rate(stats.dropped, lastReport.dropped), rate(stats.bytes, lastReport.bytes),
+                           rate(stats.replies, lastReport.replies));
+
+    if (controller.enabled() && !final) {
+        auto received = controller.received();
+        // controller counters lag by poll period, loss is meaningful for totals at the end of the test
+        DefaultLogger::logInfo("FakeIRCServer controller received: {}/s, total: {}/{} delivered, failed polls: {}",
+                               rate(received, lastReceived), received, stats.delivered, controller.failed());
+        lastReceived = received;
+    }
+
+    lastReport = stats;
+    lastReportTime = now;
+}
@@ -0,0 +1,91 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_TOOLS_FAKEIRC_FAKEIRCSERVER_H_
+#define CHATCONTROLLER_TOOLS_FAKEIRC_FAKEIRCSERVER_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "network/TCPListener.h"
+#include "network/TCPSocket.h"
+
+#include "FakeTraffic.h"
+
+struct FakeIRCServerConfig {
+    std::string host = "127.0.0.1";
+    unsigned short port = 6667;
+    double speed = 1.;                         // traffic time multiplier
+    size_t maxOutput = 8 * 1024 * 1024;        // bytes queued per client before messages are dropped
+    unsigned int report = 5;                   // seconds
+};
+
+class ControllerStats;
+
+// Single threaded IRC server speaking enough of Twitch dialect for chatcontroller:
+// PASS/NICK/USER/CAP registration, JOIN/PART with multiple channels, PING and PRIVMSG.
+// Traffic lines are fanned out to every client joined to the channel.
+class FakeIRCServer
+{
+  public:
+    struct Stats {
+        unsigned long long generated = 0; // lines produced by traffic source
+        unsigned long long delivered = 0; // lines queued to clients
+        unsigned long long dropped = 0;   // lines dropped for slow clients
+        unsigned long long bytes = 0;     // bytes written to sockets
+        unsigned long long replies = 0;   // PRIVMSG received from clients
+    };
+
+  public:
+    FakeIRCServer(FakeIRCServerConfig config, std::unique_ptr<FakeTraffic> traffic, const ControllerStats &controller);
+    ~FakeIRCServer();
+
+    /// Serves clients until termination signal or until replay traffic is over and sent
+    bool run();
+
+    [[nodiscard]] const Stats &getStats() const { return stats; }
+
+  private:
+    struct Client {
+        TCPSocket socket;
+        std::string address;
+        std::string nick;
+        std::string input;
+        std::string output;
+        size_t outputOffset = 0;
+        std::vector<std::string> channels;
+        bool registered = false;
+        bool tags = false;
+        bool closing = false;
+    };
+
+    void accept();
+    void read(Client &client);
+    void write(Client &client);
+    void handle(Client &client, std::string_view line);
+    void join(Client &client, std::string_view channels);
+    void part(Client &client, std::string_view channels);
+    void leaveAll(Client &client);
+    void send(Client &client, std::string_view line);
+    void dispatch(const std::vector<FakeLine> &lines);
+    void report(long long now, bool final);
+
+    const FakeIRCServerConfig config;
+    const std::unique_ptr<FakeTraffic> traffic;
+    const ControllerStats &controller;
+
+    TCPListener listener;
+    std::vector<std::unique_ptr<Client>> clients;
+    std::unordered_map<std::string, std::vector<Client *>> channels;
+
+    Stats stats;
+    Stats lastReport;
+    unsigned long long lastReceived = 0;
+    long long lastReportTime = 0;
+};
+
+#endif //CHATCONTROLLER_TOOLS_FAKEIRC_FAKEIRCSERVER_H_
@@ -0,0 +1,150 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+#include <fmt/format.h>
+
+#include "Clock.h"
+#include "Logger.h"
+
+#include "../../irc/IRCCaptureReader.h"
+#include "FakeTraffic.h"
+
+static constexpr std::array<const char *, 32> WORDS = {
+    "lul", "pog", "kappa", "gg", "wp", "nice", "what", "is", "this", "stream", "chat", "hello",
+    "streamer", "play", "again", "no", "way", "insane", "clip", "it", "omegalul", "first", "time",
+    "here", "love", "the", "music", "when", "next", "game", "monkas", "ez"
+};
+static constexpr const char *COPYPASTA = "this is a copypasta that chat repeats again and again";
+
+SyntheticTraffic::SyntheticTraffic(std::string prefix, size_t channels, double rate, unsigned int seed)
+  : prefix(std::move(prefix)), rate(rate), random(seed) {
+    cdf.reserve(channels);
+    double sum = 0;
+    for (size_t i = 0; i < channels; ++i) {
+        sum += 1. / static_cast<double>(i + 1);
+        cdf.push_back(sum);
+    }
+    for (auto &value: cdf)
+        value /= sum;
+}
+
+bool SyntheticTraffic::generate(long long time, std::vector<FakeLine> &out) {
+    if (cdf.empty())
+        return false;
+
+    // fractional remainder keeps average rate exact for small ticks
+    pending += rate * static_cast<double>(time - lastTime) / 1000.;
+    lastTime = time;
+
+    std::uniform_real_distribution<double> dist(0., 1.);
+    for (; pending >= 1.; pending -= 1.) {
+        auto it = std::lower_bound(cdf.begin(), cdf.end(), dist(random));
+        size_t channel = std::min<size_t>(it - cdf.begin(), cdf.size() - 1);
+        out.push_back({prefix + std::to_string(channel), makeLine(channel)});
+    }
+    return true;
+}
+
+std::string SyntheticTraffic::makeLine(size_t channel) {
+    auto user = random() % 100000;
+    auto nick = fmt::format("viewer{}", user);
+
+    std::string text;
+    if (random() % 20 == 0) {
+        text = COPYPASTA;
+    } else {
+        size_t words = 3 + random() % 10;
+        for (size_t i = 0; i < words; ++i) {
+            if (i > 0)
+                text.push_back(' ');
+            text.append(WORDS[random() % WORDS.size()]);
+        }
+    }
+
+    return fmt::format("@badge-info=;badges=;color=#{:06X};display-name={};emotes=;first-msg=0;flags=;"
+                       "id={:016x}-{:08x};mod=0;room-id={};subscriber=0;tmi-sent-ts={};turbo=0;user-id={};user-type= "
+                       ":{}!{}@{}.tmi.twitch.tv PRIVMSG #{}{} :{}",
+                       user & 0xFFFFFF, nick, random(), ++sequence, 100000 + channel,
+                       CurrentTime<std::chrono::system_clock>::milliseconds(), 500000 + user,
+                       nick, nick, nick, prefix, channel, text);
+}
+
+ReplayTraffic::ReplayTraffic(const std::string &path, bool loop) : loop(loop) {
+    std::error_code ec;
+    bool capture = std::filesystem::is_directory(path, ec) ||
+                   (path.size() > 4 && path.compare(path.size() - 4, 4, ".lz4") == 0);
+    if (capture)
+        readCapture(path);
+    else
+        readText(path);
+
+    // recordings from several sessions can be slightly out of order
+    std::stable_sort(lines.begin(), lines.end(), [] (const Record &lhs, const Record &rhs) {
+        return lhs.offset < rhs.offset;
+    });
+}
+
+void ReplayTraffic::readText(const std::string &path) {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        long long time = 0;
+        auto [ptr, ec] = std::from_chars(line.data(), line.data() + line.size(), time);
+        if (ec != std::errc() || ptr == line.data() + line.size() || *ptr != ' ')
+            continue;
+        add(time, line.substr(ptr + 1 - line.data()));
+    }
+}
+
+void ReplayTraffic::readCapture(const std::string &path) {
+    IRCCaptureReader reader(path);
+    IRCCaptureRecord record;
+    while (reader.next(record))
+        add(record.time / 1000, std::string(record.line));
+    if (!reader.error().empty())
+        DefaultLogger::logWarn("Capture {} is partially read: {}", path, reader.error());
+}
+
+void ReplayTraffic::add(long long time, std::string raw) {
+    auto pos = raw.find(" PRIVMSG #");
+    if (pos == std::string::npos)
+        return;
+    pos += sizeof(" PRIVMSG #") - 1;
+    auto end = raw.find(' ', pos);
+    if (end == std::string::npos)
+        return;
+
+    if (first < 0)
+        first = time;
+    lines.push_back({std::max(time - first, 0LL), {raw.substr(pos, end - pos), std::move(raw)}});
+}
+
+bool ReplayTraffic::generate(long long time, std::vector<FakeLine> &out) {
+    while (!lines.empty()) {
+        if (position == lines.size()) {
+            if (!loop)
+                return false;
+            // next pass starts right after the last line
+            base += lines.back().offset + 1;
+            position = 0;
+        }
+
+        const auto &record = lines[position];
+        if (base + record.offset > time)
+            break;
+        out.push_back(record.line);
+        ++position;
+    }
+    return !lines.empty();
+}
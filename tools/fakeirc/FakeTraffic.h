@@ -0,0 +1,78 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#ifndef CHATCONTROLLER_TOOLS_FAKEIRC_FAKETRAFFIC_H_
+#define CHATCONTROLLER_TOOLS_FAKEIRC_FAKETRAFFIC_H_
+
+#include <random>
+#include <string>
+#include <vector>
+
+// One server line for channel subscribers, raw IRC without CRLF.
+// Tags(if any) are kept in the line and stripped for clients without twitch.tv/tags capability.
+struct FakeLine {
+    std::string channel; // without #
+    std::string line;
+};
+
+// Source of channel traffic, time is virtual milliseconds since start(already multiplied by speed)
+class FakeTraffic
+{
+  public:
+    virtual ~FakeTraffic() = default;
+
+    /// Appends lines due up to time, returns false when source is exhausted
+    virtual bool generate(long long time, std::vector<FakeLine> &out) = 0;
+};
+
+// Messages with Twitch tags spread over channels by Zipf distribution, like real chat popularity.
+class SyntheticTraffic : public FakeTraffic
+{
+  public:
+    SyntheticTraffic(std::string prefix, size_t channels, double rate, unsigned int seed = 42);
+
+    bool generate(long long time, std::vector<FakeLine> &out) override;
+
+  private:
+    [[nodiscard]] std::string makeLine(size_t channel);
+
+    std::string prefix;
+    double rate;             // messages per virtual second for all channels
+    std::vector<double> cdf; // channels popularity
+    long long lastTime = 0;
+    double pending = 0;
+    unsigned long long sequence = 0;
+
+    std::mt19937_64 random;
+};
+
+// Recorded traffic, text file with "<milliseconds> <raw IRC line>" lines
+// or IRCCapture segment file(*.lz4)/directory written by chatcontroller with [irc] capture_path.
+// Only PRIVMSG lines are replayed, timestamps are relative to the first line.
+class ReplayTraffic : public FakeTraffic
+{
+  public:
+    ReplayTraffic(const std::string &path, bool loop);
+
+    [[nodiscard]] bool empty() const { return lines.empty(); }
+    bool generate(long long time, std::vector<FakeLine> &out) override;
+
+  private:
+    struct Record {
+        long long offset;
+        FakeLine line;
+    };
+
+    void readText(const std::string &path);
+    void readCapture(const std::string &path);
+    void add(long long time, std::string raw);
+
+    std::vector<Record> lines;
+    bool loop;
+    long long first = -1; // time of the first recorded line
+    size_t position = 0;
+    long long base = 0; // virtual time of current pass start
+};
+
+#endif //CHATCONTROLLER_TOOLS_FAKEIRC_FAKETRAFFIC_H_
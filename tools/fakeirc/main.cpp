@@ -0,0 +1,81 @@
+//
+// Created by l2pic on 19.10.2026.
+//
+
+#include <csignal>
+
+#include "Logger.h"
+#include "Options.h"
+#include "SysSignal.h"
+
+#include "ControllerStats.h"
+#include "FakeIRCServer.h"
+#include "FakeTraffic.h"
+
+int main(int argc, char *argv[]) {
+    SysSignal::setupSignalHandling();
+    std::signal(SIGPIPE, SIG_IGN);
+
+    Options options{"fakeirc", "Fake Twitch IRC server for chatcontroller load tests"};
+    options.addOption<std::string>("host", "H", "Listen address", "127.0.0.1");
+    options.addOption<unsigned short>("port", "p", "Listen port", "6667");
+    options.addOption<std::string>("replay", "r", "Replay file with \"<milliseconds> <raw line>\" records or capture segment/directory", "");
+    options.addOption<bool>("loop", "l", "Repeat replay file", "false");
+    options.addOption<size_t>("channels", "n", "Synthetic channels count", "1000");
+    options.addOption<std::string>("prefix", "P", "Synthetic channels name prefix", "fake_");
+    options.addOption<double>("rate", "R", "Synthetic messages per second for all channels at speed 1", "1000");
+    options.addOption<double>("speed", "s", "Traffic time multiplier", "1");
+    options.addOption<size_t>("max-output", "m", "Bytes queued per client before messages are dropped", "8388608");
+    options.addOption<unsigned int>("report", "t", "Report period in seconds", "5");
+    options.addOption<std::string>("control-host", "", "chatcontroller [control] host to poll /stats/channel", "");
+    options.addOption<unsigned short>("control-port", "", "chatcontroller [control] port", "8081");
+    options.addOption<std::string>("control-user", "", "chatcontroller [control] user", "");
+    options.addOption<std::string>("control-password", "", "chatcontroller [control] password", "");
+    options.parse(argc, argv);
+
+    std::unique_ptr<FakeTraffic> traffic;
+    if (auto replay = options.getValue<std::string>("replay"); !replay.empty()) {
+        auto records = std::make_unique<ReplayTraffic>(replay, options.getValue<bool>("loop"));
+        if (records->empty()) {
+            DefaultLogger::logCritical("No PRIVMSG records in replay file {}", replay);
+            return 1;
+        }
+        traffic = std::move(records);
+    } else {
+        traffic = std::make_unique<SyntheticTraffic>(options.getValue<std::string>("prefix"),
+                                                     options.getValue<size_t>("channels"),
+                                                     options.getValue<double>("rate"));
+    }
+
+    FakeIRCServerConfig config;
+    config.host = options.getValue<std::string>("host");
+    config.port = options.getValue<unsigned short>("port");
+    config.speed = options.getValue<double>("speed");
+    config.maxOutput = options.getValue<size_t>("max-output");
+    config.report = std::max(options.getValue<unsigned int>("report"), 1u);
+
+    ControllerStatsConfig controllerConfig;
+    controllerConfig.host = options.getValue<std::string>("control-host");
+    controllerConfig.port = options.getValue<unsigned short>("control-port");
+    controllerConfig.user = options.getValue<std::string>("control-user");
+    controllerConfig.password = options.getValue<std::string>("control-password");
+    controllerConfig.period = config.report;
+
+    ControllerStats controller(std::move(controllerConfig));
+    controller.start();
+
+    FakeIRCServer server(std::move(config), std::move(traffic), controller);
+    bool res = server.run();
+    controller.stop();
+
+    const auto &stats = server.getStats();
+    DefaultLogger::logInfo("Generated: {}, delivered: {}, dropped: {}, bytes: {}, replies: {}",
+                           stats.generated, stats.delivered, stats.dropped, stats.bytes, stats.replies);
+    if (controller.enabled()) {
+        auto received = controller.received();
+        DefaultLogger::logInfo("Controller received: {}, lost: {}, failed polls: {}",
+                               received, stats.delivered > received ? stats.delivered - received : 0,
+                               controller.failed());
+    }
+    return res ? 0 : 1;
+}